@@ -0,0 +1,102 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include "mode.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace px4_ros2
+{
+/** \ingroup components
+ *  @{
+ */
+
+/**
+ * @brief Persistent checkpoint of a mode executor's state in a memory-mapped file.
+ *
+ * The file contains two slots. A commit writes into the slot that does not hold the latest checkpoint,
+ * so a crash in the middle of a commit leaves the previous checkpoint intact. Each slot is protected by a
+ * checksum, and loading picks the valid slot with the highest sequence number.
+ *
+ * Writes go to the page cache, so a checkpoint survives a crash or restart of the process without
+ * syncing. Pass sync=true to commit() to also survive a power loss, at the cost of a blocking write.
+ */
+class ExecutorCheckpoint
+{
+public:
+  struct State
+  {
+    std::vector<uint8_t> data;
+    ModeBase::ModeID scheduled_mode_id{ModeBase::kModeIDInvalid};
+    uint64_t sequence{0};
+  };
+
+  /**
+   * Open (or create) the checkpoint file.
+   * @param capacity maximum size of the user state in bytes
+   * @throws std::runtime_error if the file cannot be opened or mapped
+   */
+  ExecutorCheckpoint(const std::string & file_path, size_t capacity);
+  ExecutorCheckpoint(const ExecutorCheckpoint &) = delete;
+  ExecutorCheckpoint & operator=(const ExecutorCheckpoint &) = delete;
+  ~ExecutorCheckpoint();
+
+  /**
+   * Atomically replace the checkpoint
+   * @return false if the state exceeds the capacity, or syncing failed
+   */
+  bool commit(
+    const uint8_t * data, size_t size, ModeBase::ModeID scheduled_mode_id,
+    bool sync = false);
+
+  /**
+   * @return the latest valid checkpoint, if any
+   */
+  std::optional<State> load() const;
+
+  /**
+   * Invalidate the checkpoint, e.g. after the mission completed
+   */
+  void clear();
+
+  size_t capacity() const {return _capacity;}
+
+private:
+  struct FileHeader
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+  };
+
+  struct SlotHeader
+  {
+    uint64_t sequence;
+    uint32_t size;
+    uint32_t scheduled_mode_id;
+    uint32_t checksum;
+    uint32_t reserved;
+  };
+
+  SlotHeader * slot(int index) const;
+  uint8_t * slotData(int index) const;
+  bool slotValid(int index) const;
+  static uint32_t checksum(const SlotHeader & header, const uint8_t * data);
+
+  const size_t _capacity;
+  size_t _slot_size{0};
+  size_t _file_size{0};
+  int _fd{-1};
+  uint8_t * _mapping{nullptr};
+};
+
+/** @}*/
+} // namespace px4_ros2
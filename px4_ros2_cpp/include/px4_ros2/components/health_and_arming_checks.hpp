@@ -12,14 +12,19 @@
 
 #include "events.hpp"
 
+#include <chrono>
 #include <memory>
 #include <functional>
+#include <string>
 
 class Registration;
+struct RegistrationSettings;
 
 namespace px4_ros2
 {
 
+class AsyncMessageCompatibilityCheck;
+
 class HealthAndArmingCheckReporter
 {
 public:
@@ -94,10 +99,20 @@ class HealthAndArmingChecks
 public:
   using CheckCallback = std::function<void (HealthAndArmingCheckReporter &)>;
 
+  struct FmuLossSettings
+  {
+    /// The FMU is considered lost if neither a vehicle status nor an arming check request is received for
+    /// this long
+    std::chrono::milliseconds timeout{2000};
+    /// Re-register automatically once the FMU is back (e.g. after a reboot), instead of shutting down
+    bool reregister{true};
+  };
+
   HealthAndArmingChecks(
     rclcpp::Node & node, CheckCallback check_callback,
     const std::string & topic_namespace_prefix = "");
   HealthAndArmingChecks(const HealthAndArmingChecks &) = delete;
+  ~HealthAndArmingChecks();
 
   /**
    * Register the checks. Call this once on startup. This is a blocking method.
@@ -113,24 +128,58 @@ public:
 
   RequirementFlags & modeRequirements() {return _mode_requirements;}
 
+  void setFmuLossSettings(const FmuLossSettings & settings);
+
+  bool fmuLost() const {return _fmu_lost;}
+
 private:
   friend class ModeBase;
   friend class ModeExecutorBase;
   void overrideRegistration(const std::shared_ptr<Registration> & registration);
 
+  struct FmuLossHandling
+  {
+    std::function<void()> on_fmu_lost; ///< called after the registration got invalidated
+    std::function<RegistrationSettings()> registration_settings;
+    std::function<bool()> on_registered; ///< called after registering again, false on failure
+    /// Re-run the message compatibility check first, the FMU might have been updated
+    bool check_message_compatibility{false};
+  };
+
+  /**
+   * Set how to recover from a loss of the FMU, for the owner of the registration
+   */
+  void setFmuLossHandling(const FmuLossHandling & handling);
+
+  /**
+   * Called for every received message that indicates the FMU is alive
+   */
+  void fmuActivity();
+
+  void startReregistration();
+  void requestReregistration();
+  void reregistrationCompleted(bool success);
+
   void watchdogTimerUpdate();
 
   rclcpp::Node & _node;
   std::shared_ptr<Registration> _registration;
   CheckCallback _check_callback;
-  bool _check_triggered{true};
 
   rclcpp::Subscription<px4_msgs::msg::ArmingCheckRequest>::SharedPtr _arming_check_request_sub;
   rclcpp::Publisher<px4_msgs::msg::ArmingCheckReply>::SharedPtr _arming_check_reply_pub;
 
   RequirementFlags _mode_requirements{};
   rclcpp::TimerBase::SharedPtr _watchdog_timer;
-  bool _shutdown_on_timeout{true};
+  FmuLossSettings _fmu_loss_settings{};
+  std::chrono::steady_clock::time_point _last_fmu_activity{std::chrono::steady_clock::now()};
+  std::chrono::steady_clock::time_point _last_reregister_attempt{};
+  bool _fmu_lost{false};
+  bool _reregistering{false};
+  std::string _name;
+  std::string _topic_namespace_prefix;
+  FmuLossHandling _fmu_loss_handling;
+  std::unique_ptr<AsyncMessageCompatibilityCheck> _message_compatibility_check;
 };
 
 } // namespace px4_ros2
@@ -0,0 +1,165 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <px4_msgs/msg/message_format_request.hpp>
+#include <px4_msgs/msg/message_format_response.hpp>
+#include <px4_ros2/common/context.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace px4_ros2
+{
+/** \ingroup components
+ *  @{
+ */
+
+/**
+ * @brief Sliding window over the outcomes of the last N latency measurements
+ *
+ * Each entry is either a latency sample or a loss. Percentiles are computed over the samples in the window
+ * (nearest-rank), the loss rate over all entries.
+ */
+class LatencyWindow
+{
+public:
+  explicit LatencyWindow(size_t capacity);
+
+  void addSample(std::chrono::microseconds latency);
+  void addLoss();
+  void clear();
+
+  /**
+   * @return number of latency samples (excluding losses) in the window
+   */
+  size_t numSamples() const {return _num_samples;}
+
+  /**
+   * @return fraction of lost measurements in the window, range [0, 1]
+   */
+  float lossRate() const;
+
+  /**
+   * @param percentile range [0, 100]
+   * @return latency percentile, or zero if there are no samples
+   */
+  std::chrono::microseconds percentile(float percentile) const;
+
+  std::chrono::microseconds min() const;
+  std::chrono::microseconds max() const;
+
+private:
+  static constexpr int64_t kLoss = -1;
+
+  void add(int64_t entry);
+
+  std::vector<int64_t> _entries; ///< ring buffer, latency in us or kLoss
+  size_t _next{0};
+  size_t _size{0};
+  size_t _num_samples{0};
+  mutable std::vector<int64_t> _sorted; ///< scratch buffer, avoids allocating for each query
+};
+
+/**
+ * @brief Continuously measures the latency of the link between this node and the FMU.
+ *
+ * Periodically sends a probe MessageFormatRequest and measures the round-trip time until the matching
+ * MessageFormatResponse arrives. The uXRCE-DDS client on the FMU answers these requests directly (they
+ * are also used by the message compatibility check), so the probe neither goes through commander nor
+ * has any side effects. The probe topic name carries a sequence number, which the response echoes, so a
+ * late response to an earlier probe is not mistaken for the current one.
+ *
+ * At most one probe is outstanding at any time. A probe that is not acked until the next one is sent counts
+ * as lost, so the interval should be well above the expected round-trip time.
+ *
+ * The one-way delay is estimated as half of the round-trip time, i.e. assuming a symmetric link.
+ */
+class LinkLatencyProbe
+{
+public:
+  struct Settings
+  {
+    std::chrono::milliseconds interval{1000}; ///< probe interval (and timeout)
+    size_t window_size{100}; ///< number of probes to compute the statistics over
+  };
+
+  struct Statistics
+  {
+    size_t num_samples{0};
+    float loss_rate{0.f}; ///< range [0, 1]
+    std::chrono::microseconds rtt_min{0};
+    std::chrono::microseconds rtt_median{0};
+    std::chrono::microseconds rtt_p90{0};
+    std::chrono::microseconds rtt_p99{0};
+    std::chrono::microseconds rtt_max{0};
+    std::chrono::microseconds one_way_median{0}; ///< estimated, rtt_median / 2
+  };
+
+  using UpdateCallback = std::function<void (const Statistics &)>;
+
+  explicit LinkLatencyProbe(Context & context);
+  LinkLatencyProbe(Context & context, const Settings & settings);
+
+  /**
+   * Set a callback that is called after each probe completed or got lost, e.g. to adapt setpoint
+   * rates or to warn about a degraded link
+   */
+  void onUpdate(const UpdateCallback & callback) {_on_update = callback;}
+
+  Statistics statistics() const;
+
+  /**
+   * @param percentile range [0, 100]
+   * @return round-trip time percentile over the window, or zero if there are no samples
+   */
+  std::chrono::microseconds rttPercentile(float percentile) const
+  {
+    return _window.percentile(percentile);
+  }
+
+  /**
+   * @return round-trip time of the last answered probe, or zero if none got answered yet
+   */
+  std::chrono::microseconds lastRtt() const {return _last_rtt;}
+
+  /**
+   * @return FMU timestamp of the last response [us]. Together with lastResponseReceiveTime() this can be
+   * used to relate the FMU and the local time.
+   */
+  uint64_t lastResponseFmuTimestamp() const {return _last_response_fmu_timestamp;}
+  std::chrono::steady_clock::time_point lastResponseReceiveTime() const
+  {
+    return _last_response_receive_time;
+  }
+
+private:
+  void sendProbe();
+  void messageFormatResponseUpdated(const px4_msgs::msg::MessageFormatResponse & response);
+  void notifyUpdate();
+
+  rclcpp::Node & _node;
+  const Settings _settings;
+  LatencyWindow _window;
+  UpdateCallback _on_update;
+
+  rclcpp::Publisher<px4_msgs::msg::MessageFormatRequest>::SharedPtr _message_format_request_pub;
+  rclcpp::Subscription<px4_msgs::msg::MessageFormatResponse>::SharedPtr
+    _message_format_response_sub;
+  rclcpp::TimerBase::SharedPtr _probe_timer;
+
+  bool _probe_pending{false};
+  uint32_t _probe_sequence{0};
+  std::chrono::steady_clock::time_point _probe_send_time{};
+  std::chrono::microseconds _last_rtt{0};
+  uint64_t _last_response_fmu_timestamp{0};
+  std::chrono::steady_clock::time_point _last_response_receive_time{};
+};
+
+/** @}*/
+} // namespace px4_ros2
@@ -25,6 +25,8 @@ using namespace std::chrono_literals; // NOLINT
   {"fmu/in/vehicle_command"}, \
   {"fmu/in/vehicle_command_mode_executor", "VehicleCommand"}, \
   {"fmu/in/vehicle_rates_setpoint"}, \
+  {"fmu/in/vehicle_thrust_setpoint"}, \
+  {"fmu/in/vehicle_torque_setpoint"}, \
   {"fmu/in/vehicle_visual_odometry", "VehicleOdometry"}, \
   {"fmu/out/arming_check_request"}, \
   {"fmu/out/battery_status"}, \
@@ -159,6 +159,17 @@ public:
    */
   RequirementFlags & modeRequirements() {return _health_and_arming_checks.modeRequirements();}
 
+  /**
+   * Configure how a loss of the FMU (e.g. a reboot) is detected and handled.
+   * This also applies to the mode executor owning this mode.
+   */
+  void setFmuLossSettings(const HealthAndArmingChecks::FmuLossSettings & settings)
+  {
+    _health_and_arming_checks.setFmuLossSettings(settings);
+  }
+
+  bool fmuLost() const {return _health_and_arming_checks.fmuLost();}
+
 protected:
   void setSkipMessageCompatibilityCheck() {_skip_message_compatibility_check = true;}
   void overrideRegistration(const std::shared_ptr<Registration> & registration);
@@ -6,7 +6,10 @@
 #pragma once
 
 #include "mode.hpp"
+#include "executor_checkpoint.hpp"
 #include "overrides.hpp"
+#include "wait_condition.hpp"
+#include "px4_ros2/utils/timer_wheel.hpp"
 
 #include <rclcpp/rclcpp.hpp>
 #include <px4_msgs/msg/vehicle_status.hpp>
@@ -14,7 +17,13 @@
 #include <px4_msgs/msg/vehicle_command_ack.hpp>
 #include <px4_msgs/msg/mode_completed.hpp>
 
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 class Registration;
 
@@ -31,6 +40,13 @@ class ModeExecutorBase
 {
 public:
   using CompletedCallback = std::function<void (Result)>;
+  using CommandProgressCallback = std::function<void (uint8_t progress_percent)>;
+
+  struct CommandSettings
+  {
+    std::chrono::milliseconds ack_timeout{300}; ///< Restarted whenever an IN_PROGRESS ack is received
+    CommandProgressCallback on_progress{}; ///< Optional, called for IN_PROGRESS acks
+  };
 
   struct Settings
   {
@@ -53,7 +69,7 @@ public:
     rclcpp::Node & node, const Settings & settings, ModeBase & owned_mode,
     const std::string & topic_namespace_prefix = "");
   ModeExecutorBase(const ModeExecutorBase &) = delete;
-  virtual ~ModeExecutorBase() = default;
+  virtual ~ModeExecutorBase();
 
   /**
    * Register the mode executor. Call this once on startup. This is a blocking method.
@@ -72,6 +88,18 @@ public:
    */
   virtual void onDeactivate(DeactivateReason reason) = 0;
 
+  /**
+   * Called instead of onActivate() on the first activation after a checkpoint got loaded on registration.
+   * @param state user state passed to checkpoint()
+   * @param scheduled_mode_id mode that was scheduled at the time of the checkpoint, or ModeBase::kModeIDInvalid
+   * @return false to ignore the checkpoint and start from scratch, in which case onActivate() is called
+   * @see enableCheckpointing()
+   */
+  virtual bool onResume(const std::vector<uint8_t> & state, ModeBase::ModeID scheduled_mode_id)
+  {
+    return false;
+  }
+
   /**
    * Called when failsafes are currently being deferred, and the FMU wants to trigger a failsafe.
    * @see deferFailsafesSync()
@@ -79,27 +107,132 @@ public:
   virtual void onFailsafeDeferred() {}
 
   /**
-  * Send command and wait for ack/nack
+  * Send command and wait for ack/nack.
+  * This blocks the calling thread (and thus the executor) until the ack is received, prefer sendCommandAsync().
+  * Callbacks of other commands acked in the meantime are called before returning.
   */
   Result sendCommandSync(
     uint32_t command, float param1 = NAN, float param2 = NAN, float param3 = NAN,
     float param4 = NAN,
     float param5 = NAN, float param6 = NAN, float param7 = NAN);
 
+  /**
+   * Send command without blocking.
+   * The callback is called from the ack subscription once the matching ack is received, or with
+   * Result::Timeout if no ack arrives in time.
+   * Any number of commands can be outstanding at the same time. Acks of the same command are matched in
+   * order of sending.
+   */
+  void sendCommandAsync(
+    uint32_t command, const CompletedCallback & on_completed, float param1 = NAN,
+    float param2 = NAN, float param3 = NAN, float param4 = NAN,
+    float param5 = NAN, float param6 = NAN, float param7 = NAN);
+
+  /**
+   * Send command without blocking, with custom ack timeout and progress reporting.
+   * source_component and timestamp are filled in automatically.
+   */
+  void sendCommandAsync(
+    px4_msgs::msg::VehicleCommand cmd,
+    const CompletedCallback & on_completed, const CommandSettings & settings);
+
   /**
    * Switch to a mode with a callback when it is finished.
    * The callback is also executed when the mode is deactivated.
    * If there's already a mode scheduling active, the previous one is cancelled.
+   * @param timeout if > 0, the callback is called with Result::Timeout if the mode does not complete in time
+   */
+  void scheduleMode(
+    ModeBase::ModeID mode_id, const CompletedCallback & on_completed,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+  /**
+   * Schedule a sequence of modes, one after the other.
+   * The commands are prepared upfront and the next one is sent directly when the previous mode completes,
+   * without a round-trip through user callbacks. The callback is called once the last mode completed, or
+   * with the result of the first mode that did not complete successfully (the remaining ones are dropped).
+   * @param on_mode_completed optional, called whenever a mode of the sequence (except the last) completed
    */
-  void scheduleMode(ModeBase::ModeID mode_id, const CompletedCallback & on_completed);
+  void scheduleModeSequence(
+    const std::vector<ModeBase::ModeID> & mode_ids, const CompletedCallback & on_completed,
+    const std::function<void(ModeBase::ModeID)> & on_mode_completed = {});
+
+  /**
+   * Append a mode to the currently scheduled mode or sequence. It gets activated as soon as the
+   * currently scheduled mode (and everything queued before) completes successfully.
+   * @return false if no mode is currently scheduled
+   */
+  bool queueMode(ModeBase::ModeID mode_id);
+
+  /**
+   * Cancel the currently scheduled mode (or sequence), calling its callback with the given result.
+   * This does not switch the vehicle out of the mode.
+   */
+  void cancelScheduledMode(Result result = Result::Deactivated)
+  {
+    _current_scheduled_mode.cancel(result);
+  }
 
   void takeoff(const CompletedCallback & on_completed, float altitude = NAN, float heading = NAN);
   void land(const CompletedCallback & on_completed);
   void rtl(const CompletedCallback & on_completed);
 
-  void arm(const CompletedCallback & on_completed);
-  void waitReadyToArm(const CompletedCallback & on_completed);
-  void waitUntilDisarmed(const CompletedCallback & on_completed);
+  /**
+   * @param timeout if > 0, the callback is called with Result::Timeout if not armed in time
+   */
+  void arm(
+    const CompletedCallback & on_completed,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+  void waitReadyToArm(
+    const CompletedCallback & on_completed,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+  void waitUntilDisarmed(
+    const CompletedCallback & on_completed,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+  /**
+   * Cancel a pending arm(), waitReadyToArm() or waitUntilDisarmed(), calling its callback with the given
+   * result
+   */
+  void cancelVehicleStatusWait(Result result = Result::Deactivated)
+  {
+    _current_wait_vehicle_status.cancel(result);
+  }
+
+  /**
+   * Wait until a condition over one or more subscriptions is met. Any number of waits can be active at the
+   * same time, they are cancelled (with Result::Deactivated) when the executor gets deactivated.
+   * @param timeout if > 0, the callback is called with Result::Timeout if the condition is not met in time
+   * @return id to cancel the wait via cancelWait()
+   */
+  ConditionWaiter::WaitId waitUntil(
+    const WaitCondition & condition, const CompletedCallback & on_completed,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+  bool cancelWait(ConditionWaiter::WaitId id, Result result = Result::Deactivated)
+  {
+    return _condition_waiter.cancel(id, result);
+  }
+
+  /**
+   * Enable checkpointing of the executor state to a memory-mapped file, so it can resume after a restart of
+   * the process. Call this before doRegister(), which loads an existing checkpoint to be passed to onResume().
+   * @param capacity maximum size of the state passed to checkpoint()
+   * @throws std::runtime_error if the file cannot be opened
+   */
+  void enableCheckpointing(const std::string & file_path, size_t capacity = 4096);
+
+  /**
+   * Atomically store a checkpoint of the given state, together with the currently scheduled mode.
+   * This is cheap (no system call), unless sync is set, in which case it is flushed to disk.
+   * @return false if checkpointing is not enabled or the state exceeds the capacity
+   */
+  bool checkpoint(const std::vector<uint8_t> & state, bool sync = false);
+
+  /**
+   * Remove the checkpoint, e.g. once the mission completed
+   */
+  void clearCheckpoint();
 
   bool isInCharge() const {return _is_in_charge;}
 
@@ -124,26 +257,79 @@ public:
    * @param enabled
    * @param timeout_s 0=system default, -1=no timeout
    * @return true on success
+   * @see deferFailsafes() for a non-blocking variant
    */
   bool deferFailsafesSync(bool enabled, int timeout_s = 0);
 
+  /**
+   * Non-blocking variant of deferFailsafesSync().
+   *
+   * If the executor is in charge and deferring gets enabled, the callback is called once the FMU reports
+   * failsafe deferring as enabled in the vehicle status, or with Result::Timeout if not confirmed within 1s.
+   * Otherwise it is called immediately with Result::Success.
+   * A pending confirmation is completed with Result::Interrupted on the next call, or with Result::Deactivated
+   * if the executor gets deactivated.
+   */
+  void deferFailsafes(bool enabled, const CompletedCallback & on_completed, int timeout_s = 0);
+
+protected:
+  void setSkipMessageCompatibilityCheck() {_skip_message_compatibility_check = true;}
+  void overrideRegistration(const std::shared_ptr<Registration> & registration);
+
 private:
   class ScheduledMode
   {
 public:
-    ScheduledMode(rclcpp::Node & node, const std::string & topic_namespace_prefix);
+    using SendCommand = std::function<void (const px4_msgs::msg::VehicleCommand &)>;
+    using ModeCompletedCallback = std::function<void (ModeBase::ModeID)>;
+
+    ScheduledMode(
+      rclcpp::Node & node, const std::string & topic_namespace_prefix,
+      NodeTimerWheel & timer_wheel, const SendCommand & send_command);
+    ~ScheduledMode() {_timer_wheel.cancel(_timeout);}
 
     bool active() const {return _mode_id != ModeBase::kModeIDInvalid;}
-    void activate(ModeBase::ModeID mode_id, const CompletedCallback & on_completed);
-    void cancel();
+    void activate(
+      ModeBase::ModeID mode_id, const CompletedCallback & on_completed,
+      std::chrono::milliseconds timeout);
+    void cancel(Result result = Result::Deactivated);
     ModeBase::ModeID modeId() const {return _mode_id;}
+    uint32_t activationId() const {return _activation_id;}
+
+    /**
+     * Queue a mode to be activated when the current one completes successfully
+     */
+    void queue(ModeBase::ModeID mode_id, const px4_msgs::msg::VehicleCommand & cmd);
+    void setModeCompletedCallback(const ModeCompletedCallback & on_mode_completed)
+    {
+      _on_mode_completed_callback = on_mode_completed;
+    }
 
 private:
-    void reset() {_mode_id = ModeBase::kModeIDInvalid;}
+    struct QueuedMode
+    {
+      ModeBase::ModeID mode_id;
+      px4_msgs::msg::VehicleCommand cmd;
+    };
+
+    void reset();
 
+    /**
+     * Let ModeCompleted messages of a mode pass the content filter. The filter only ever grows, as
+     * narrowing it could drop the message of a mode that is still running.
+     */
+    void addToFilter(ModeBase::ModeID mode_id);
+
+    NodeTimerWheel & _timer_wheel;
+    const SendCommand _send_command;
+    std::deque<QueuedMode> _queued_modes;
+    ModeCompletedCallback _on_mode_completed_callback;
+    TimerWheel::Handle _timeout;
     ModeBase::ModeID _mode_id{ModeBase::kModeIDInvalid};
+    uint32_t _activation_id{0}; ///< Incremented on every activation, to match asynchronous results
     CompletedCallback _on_completed_callback;
     rclcpp::Subscription<px4_msgs::msg::ModeCompleted>::SharedPtr _mode_completed_sub;
+    std::vector<ModeBase::ModeID> _filtered_mode_ids;
   };
 
   class WaitForVehicleStatusCondition
@@ -151,31 +337,87 @@ private:
 public:
     using RunCheckCallback =
       std::function<bool (const px4_msgs::msg::VehicleStatus::UniquePtr & msg)>;
-    WaitForVehicleStatusCondition() = default;
+    explicit WaitForVehicleStatusCondition(NodeTimerWheel & timer_wheel)
+    : _timer_wheel(timer_wheel) {}
+    ~WaitForVehicleStatusCondition() {_timer_wheel.cancel(_timeout);}
 
     bool active() const {return _on_completed_callback != nullptr;}
     void update(const px4_msgs::msg::VehicleStatus::UniquePtr & msg);
 
     void activate(
       const RunCheckCallback & run_check_callback,
-      const CompletedCallback & on_completed);
-    void cancel();
+      const CompletedCallback & on_completed, std::chrono::milliseconds timeout);
+    void cancel(Result result = Result::Deactivated);
+    uint32_t activationId() const {return _activation_id;}
 
 private:
+    void reset();
+
+    NodeTimerWheel & _timer_wheel;
+    TimerWheel::Handle _timeout;
     CompletedCallback _on_completed_callback;
     RunCheckCallback _run_check_callback;
+    uint32_t _activation_id{0}; ///< Incremented on every activation, to match asynchronous results
+  };
+
+  /**
+   * Acks carry the command and the component it is addressed to, which identifies the queue of a command.
+   * Within a queue, commands are acked in the order of sending.
+   */
+  struct PendingCommandKey
+  {
+    uint32_t command;
+    uint16_t source_component;
+
+    bool operator==(const PendingCommandKey & other) const
+    {
+      return command == other.command && source_component == other.source_component;
+    }
+  };
+
+  struct PendingCommandKeyHash
+  {
+    size_t operator()(const PendingCommandKey & key) const
+    {
+      return (static_cast<size_t>(key.command) << 16) ^ key.source_component;
+    }
+  };
+
+  struct PendingCommand
+  {
+    uint32_t sequence;
+    std::chrono::steady_clock::time_point deadline; ///< For blocking waits, which do not run the wheel
+    CommandSettings settings;
+    CompletedCallback on_completed;
+    TimerWheel::Handle timeout;
   };
 
   void onRegistered();
+  RegistrationSettings registrationSettings() const;
+  bool onReregistered();
 
   void callOnActivate();
   void callOnDeactivate(DeactivateReason reason);
 
   void vehicleStatusUpdated(const px4_msgs::msg::VehicleStatus::UniquePtr & msg);
 
+  void completeDeferFailsafes(Result result);
+
+  uint32_t sendCommand(
+    px4_msgs::msg::VehicleCommand cmd, const CompletedCallback & on_completed,
+    const CommandSettings & settings);
+  void vehicleCommandAckUpdated(const px4_msgs::msg::VehicleCommandAck & ack);
+  void scheduleCommandTimeout(const PendingCommandKey & key, PendingCommand & pending_command);
+  void commandTimedOut(const PendingCommandKey & key, uint32_t sequence);
+  void commandCompleted(const CompletedCallback & on_completed, Result result);
+
   void scheduleMode(
     ModeBase::ModeID mode_id, const px4_msgs::msg::VehicleCommand & cmd,
-    const ModeExecutorBase::CompletedCallback & on_completed);
+    const ModeExecutorBase::CompletedCallback & on_completed,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+  void sendScheduledModeCommand(const px4_msgs::msg::VehicleCommand & cmd);
+
+  static px4_msgs::msg::VehicleCommand setNavStateCommand(ModeBase::ModeID mode_id);
 
   rclcpp::Node & _node;
   const std::string _topic_namespace_prefix;
@@ -183,21 +425,35 @@ private:
   ModeBase & _owned_mode;
 
   std::shared_ptr<Registration> _registration;
+  bool _skip_message_compatibility_check{false};
+  std::shared_ptr<NodeTimerWheel> _timer_wheel; ///< Shared with other executors on the same node
 
   rclcpp::Subscription<px4_msgs::msg::VehicleStatus>::SharedPtr _vehicle_status_sub;
   rclcpp::Publisher<px4_msgs::msg::VehicleCommand>::SharedPtr _vehicle_command_pub;
   rclcpp::Subscription<px4_msgs::msg::VehicleCommandAck>::SharedPtr _vehicle_command_ack_sub;
 
+  std::unordered_map<PendingCommandKey, std::deque<PendingCommand>,
+    PendingCommandKeyHash> _pending_commands; ///< Commands waiting for an ack, in order of sending
+  uint32_t _next_command_sequence{0};
+  bool _defer_command_callbacks{false}; ///< Set while sendCommandSync() blocks
+  std::vector<std::function<void()>> _deferred_command_callbacks;
+
   ScheduledMode _current_scheduled_mode;
   WaitForVehicleStatusCondition _current_wait_vehicle_status;
+  ConditionWaiter _condition_waiter;
 
   bool _is_in_charge{false};
   bool _is_armed{false};
   bool _was_never_activated{true};
   ModeBase::ModeID _prev_nav_state{ModeBase::kModeIDInvalid};
   uint8_t _prev_failsafe_defer_state{px4_msgs::msg::VehicleStatus::FAILSAFE_DEFER_STATE_DISABLED};
+  CompletedCallback _defer_failsafes_on_completed; ///< Set while waiting for the FMU to confirm
+  TimerWheel::Handle _defer_failsafes_timeout;
 
   ConfigOverrides _config_overrides;
+
+  std::unique_ptr<ExecutorCheckpoint> _checkpoint;
+  std::optional<ExecutorCheckpoint::State> _resume_state; ///< Loaded on registration, until first activation
 };
 
 /** @}*/
@@ -0,0 +1,395 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+#error "mode_executor_coroutine.hpp requires C++20 coroutines (e.g. set CMAKE_CXX_STANDARD to 20)"
+#endif
+
+#include "mode_executor.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace px4_ros2
+{
+/** \ingroup components
+ *  @{
+ */
+
+/**
+ * @brief Free-list allocator for coroutine frames.
+ *
+ * Frames up to kBlockSize are recycled, so after the first run of a mission no further allocations
+ * happen. The pool is per thread, which matches the single-threaded ROS executor all callbacks run on.
+ */
+class CoroutineFramePool
+{
+public:
+  static constexpr size_t kBlockSize = 2048;
+
+  static void * allocate(size_t size)
+  {
+    if (size > kBlockSize) {
+      return ::operator new(size);
+    }
+
+    if (_free_list) {
+      FreeBlock * block = _free_list;
+      _free_list = block->next;
+      return block;
+    }
+
+    return ::operator new(kBlockSize);
+  }
+
+  static void deallocate(void * ptr, size_t size) noexcept
+  {
+    if (size > kBlockSize) {
+      ::operator delete(ptr);
+      return;
+    }
+
+    auto * block = static_cast<FreeBlock *>(ptr);
+    block->next = _free_list;
+    _free_list = block;
+  }
+
+private:
+  struct FreeBlock
+  {
+    FreeBlock * next;
+  };
+
+  static inline thread_local FreeBlock * _free_list{nullptr};
+};
+
+/**
+ * @brief Coroutine type for mode executor missions.
+ *
+ * A task can await the operations of ModeExecutorCoroutineBase as well as other tasks (which share the
+ * cancellation state of the awaiting task). Tasks are lazily started.
+ */
+class ExecutorTask
+{
+public:
+  class promise_type // NOLINT(readability-identifier-naming) required by the coroutine interface
+  {
+public:
+    ExecutorTask get_return_object() // NOLINT(readability-identifier-naming)
+    {
+      return ExecutorTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+
+    std::suspend_always initial_suspend() noexcept {return {};} // NOLINT(readability-identifier-naming)
+
+    auto final_suspend() noexcept // NOLINT(readability-identifier-naming)
+    {
+      struct FinalAwaiter
+      {
+        bool await_ready() noexcept {return false;} // NOLINT(readability-identifier-naming)
+        std::coroutine_handle<> await_suspend( // NOLINT(readability-identifier-naming)
+          std::coroutine_handle<promise_type> handle) noexcept
+        {
+          // Continue with the awaiting task, if any
+          const std::coroutine_handle<> continuation = handle.promise()._continuation;
+          return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() noexcept {} // NOLINT(readability-identifier-naming)
+      };
+      return FinalAwaiter{};
+    }
+
+    void return_void() {} // NOLINT(readability-identifier-naming)
+
+    // Propagate to the resuming callback, i.e. out of the ROS executor, same as for other callbacks
+    void unhandled_exception() {throw;} // NOLINT(readability-identifier-naming)
+
+    static void * operator new(size_t size) {return CoroutineFramePool::allocate(size);}
+    static void operator delete(void * ptr, size_t size) noexcept
+    {
+      CoroutineFramePool::deallocate(ptr, size);
+    }
+
+    bool cancelled() const {return *_cancelled;}
+    void cancel() {*_cancelled = true;}
+
+private:
+    friend class ExecutorTask;
+
+    std::coroutine_handle<> _continuation;
+    bool _cancelled_storage{false};
+    bool * _cancelled{&_cancelled_storage}; ///< Points to the state of the outermost task
+  };
+
+  ExecutorTask() = default;
+  ExecutorTask(const ExecutorTask &) = delete;
+  ExecutorTask & operator=(const ExecutorTask &) = delete;
+  ExecutorTask(ExecutorTask && other) noexcept
+  : _handle(std::exchange(other._handle, nullptr)) {}
+  ExecutorTask & operator=(ExecutorTask && other) noexcept
+  {
+    if (this != &other) {
+      destroy();
+      _handle = std::exchange(other._handle, nullptr);
+    }
+
+    return *this;
+  }
+  ~ExecutorTask() {destroy();}
+
+  bool valid() const {return static_cast<bool>(_handle);}
+  bool done() const {return !_handle || _handle.done();}
+
+  void start()
+  {
+    if (_handle && !_handle.done()) {
+      _handle.resume();
+    }
+  }
+
+  /**
+   * Mark the task as cancelled: all further awaited operations complete immediately with
+   * Result::Deactivated, without being started.
+   */
+  void cancel()
+  {
+    if (_handle) {
+      _handle.promise().cancel();
+    }
+  }
+
+  // Awaiting another task runs it to completion as part of this one
+  bool await_ready() const noexcept {return done();} // NOLINT(readability-identifier-naming)
+
+  std::coroutine_handle<> await_suspend( // NOLINT(readability-identifier-naming)
+    std::coroutine_handle<promise_type> awaiting) noexcept
+  {
+    _handle.promise()._continuation = awaiting;
+    _handle.promise()._cancelled = awaiting.promise()._cancelled;
+    return _handle;
+  }
+
+  void await_resume() const noexcept {} // NOLINT(readability-identifier-naming)
+
+private:
+  explicit ExecutorTask(std::coroutine_handle<promise_type> handle)
+  : _handle(handle) {}
+
+  void destroy()
+  {
+    if (_handle) {
+      _handle.destroy();
+      _handle = nullptr;
+    }
+  }
+
+  std::coroutine_handle<promise_type> _handle;
+};
+
+/**
+ * @brief Awaitable wrapping one of the callback-based ModeExecutorBase operations.
+ *
+ * The completion callback only captures this object, so it fits into the small buffer of
+ * std::function and awaiting does not allocate.
+ */
+template<typename StartT>
+class ExecutorOperation
+{
+public:
+  explicit ExecutorOperation(StartT start)
+  : _start(std::move(start)) {}
+
+  bool await_ready() const noexcept {return false;} // NOLINT(readability-identifier-naming)
+
+  bool await_suspend( // NOLINT(readability-identifier-naming)
+    std::coroutine_handle<ExecutorTask::promise_type> handle)
+  {
+    _handle = handle;
+
+    if (handle.promise().cancelled()) {
+      _result = Result::Deactivated;
+      return false;
+    }
+
+    _start(
+      [this](Result result) {
+        _result = result;
+        _completed = true;
+
+        if (result == Result::Deactivated) {
+          // The executor got deactivated: propagate to the rest of the mission
+          _handle.promise().cancel();
+        }
+
+        if (_suspended) {
+          _handle.resume();
+        }
+      });
+
+    // The operation might have completed immediately (e.g. rejected), in which case we continue directly
+    _suspended = !_completed;
+    return _suspended;
+  }
+
+  Result await_resume() const noexcept {return _result;} // NOLINT(readability-identifier-naming)
+
+private:
+  StartT _start;
+  std::coroutine_handle<ExecutorTask::promise_type> _handle;
+  Result _result{Result::Deactivated};
+  bool _completed{false};
+  bool _suspended{false};
+};
+
+/**
+ * @brief Mode executor with a coroutine interface.
+ *
+ * Instead of chaining callbacks, the mission is written as a single coroutine, which is started when the
+ * executor gets activated. When the executor is deactivated, the currently awaited operation completes with
+ * Result::Deactivated, and so does every following one.
+ *
+ * This is header-only and requires C++20. Example:
+ *
+ * @code{.cpp}
+ * px4_ros2::ExecutorTask run() override
+ * {
+ *   if (co_await takeoff() != px4_ros2::Result::Success) {
+ *     co_return;
+ *   }
+ *   co_await scheduleMode(ownedMode().id());
+ *   co_await rtl();
+ *   co_await waitUntilDisarmed();
+ * }
+ * @endcode
+ */
+class ModeExecutorCoroutineBase : public ModeExecutorBase
+{
+public:
+  using ModeExecutorBase::ModeExecutorBase;
+
+  /**
+   * The mission. Called whenever the executor is activated.
+   */
+  virtual ExecutorTask run() = 0;
+
+  /**
+   * Called whenever the executor is deactivated, after the mission got cancelled.
+   */
+  virtual void onCancelled(DeactivateReason reason) {}
+
+  void onActivate() final
+  {
+    // The previous run completed or is suspended in a cancelled state, either way it can be destroyed
+    _task = run();
+    _task.start();
+  }
+
+  void onDeactivate(DeactivateReason reason) final
+  {
+    _task.cancel();
+    onCancelled(reason);
+  }
+
+  // Keep the callback-based variants available
+  using ModeExecutorBase::takeoff;
+  using ModeExecutorBase::land;
+  using ModeExecutorBase::rtl;
+  using ModeExecutorBase::arm;
+  using ModeExecutorBase::waitReadyToArm;
+  using ModeExecutorBase::waitUntilDisarmed;
+  using ModeExecutorBase::waitUntil;
+
+  void scheduleMode(
+    ModeBase::ModeID mode_id, const CompletedCallback & on_completed,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero())
+  {
+    ModeExecutorBase::scheduleMode(mode_id, on_completed, timeout);
+  }
+
+  auto scheduleMode(
+    ModeBase::ModeID mode_id,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero())
+  {
+    return operation(
+      [this, mode_id, timeout](const CompletedCallback & on_completed) {
+        ModeExecutorBase::scheduleMode(mode_id, on_completed, timeout);
+      });
+  }
+
+  auto takeoff(float altitude = NAN, float heading = NAN)
+  {
+    return operation(
+      [this, altitude, heading](const CompletedCallback & on_completed) {
+        ModeExecutorBase::takeoff(on_completed, altitude, heading);
+      });
+  }
+
+  auto land()
+  {
+    return operation(
+      [this](const CompletedCallback & on_completed) {
+        ModeExecutorBase::land(on_completed);
+      });
+  }
+
+  auto rtl()
+  {
+    return operation(
+      [this](const CompletedCallback & on_completed) {
+        ModeExecutorBase::rtl(on_completed);
+      });
+  }
+
+  auto arm(std::chrono::milliseconds timeout = std::chrono::milliseconds::zero())
+  {
+    return operation(
+      [this, timeout](const CompletedCallback & on_completed) {
+        ModeExecutorBase::arm(on_completed, timeout);
+      });
+  }
+
+  auto waitReadyToArm(std::chrono::milliseconds timeout = std::chrono::milliseconds::zero())
+  {
+    return operation(
+      [this, timeout](const CompletedCallback & on_completed) {
+        ModeExecutorBase::waitReadyToArm(on_completed, timeout);
+      });
+  }
+
+  auto waitUntilDisarmed(std::chrono::milliseconds timeout = std::chrono::milliseconds::zero())
+  {
+    return operation(
+      [this, timeout](const CompletedCallback & on_completed) {
+        ModeExecutorBase::waitUntilDisarmed(on_completed, timeout);
+      });
+  }
+
+  auto waitUntil(
+    const WaitCondition & condition,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero())
+  {
+    return operation(
+      [this, condition, timeout](const CompletedCallback & on_completed) {
+        ModeExecutorBase::waitUntil(condition, on_completed, timeout);
+      });
+  }
+
+protected:
+  template<typename StartT>
+  static ExecutorOperation<StartT> operation(StartT start)
+  {
+    return ExecutorOperation<StartT>(std::move(start));
+  }
+
+private:
+  ExecutorTask _task;
+};
+
+/** @}*/
+} // namespace px4_ros2
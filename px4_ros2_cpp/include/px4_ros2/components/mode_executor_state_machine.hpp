@@ -0,0 +1,183 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include "mode_executor.hpp"
+#include "px4_ros2/utils/timer_wheel.hpp"
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace px4_ros2
+{
+/** \ingroup components
+ *  @{
+ */
+
+/**
+ * @brief Declarative state machine for mode executors.
+ *
+ * Each state runs an action (e.g. scheduling a mode), which completes with a Result. The transition to the
+ * next state is looked up from that result, optionally depending on a guard (e.g. on vehicle state).
+ * States can have a timeout, on which the state completes with Result::Timeout. The action is still
+ * running at that point, so such states should also set a cancel hook that stops it (e.g. cancelling the
+ * scheduled mode) before the next state starts another one.
+ *
+ * The definition is compiled into a flat transition table on construction, so dispatching a transition is
+ * a single table lookup. Results without a transition stop the state machine.
+ *
+ * Example:
+ * @code{.cpp}
+ * _state_machine = std::make_unique<px4_ros2::ModeExecutorStateMachine>(
+ *   *this,
+ *   std::vector<px4_ros2::ModeExecutorStateMachine::StateDefinition>{
+ *     {"takeoff", [this](const CompletedCallback & cb) {takeoff(cb);}},
+ *     {"my_mode", [this](const CompletedCallback & cb) {scheduleMode(ownedMode().id(), cb);}, 60s,
+ *       [this]() {cancelScheduledMode();}},
+ *     {"rtl", [this](const CompletedCallback & cb) {rtl(cb);}},
+ *   },
+ *   std::vector<px4_ros2::ModeExecutorStateMachine::TransitionDefinition>{
+ *     {"takeoff", px4_ros2::Result::Success, "my_mode"},
+ *     {"my_mode", px4_ros2::Result::Success, "rtl"},
+ *     {"my_mode", px4_ros2::Result::Timeout, "rtl"},
+ *   });
+ * @endcode
+ */
+class ModeExecutorStateMachine
+{
+public:
+  using StateId = uint16_t;
+  using CompletedCallback = ModeExecutorBase::CompletedCallback;
+  using Action = std::function<void (const CompletedCallback &)>;
+  using Cancel = std::function<void ()>;
+  using Guard = std::function<bool ()>;
+  using TransitionCallback = std::function<void (StateId from, StateId to, Result result)>;
+  using FinishedCallback = std::function<void (StateId last_state, Result result)>;
+
+  static constexpr StateId kStateStop = std::numeric_limits<StateId>::max();
+
+  struct StateDefinition
+  {
+    std::string name;
+    Action action;
+    std::chrono::milliseconds timeout{0}; ///< 0 = no timeout
+    Cancel cancel{}; ///< Optional, called on timeout to stop the still running action
+  };
+
+  struct TransitionDefinition
+  {
+    std::string from;
+    Result result;
+    std::string to; ///< Empty to stop
+    Guard guard{}; ///< Optional, if set and it returns false, to_if_guard_fails is used instead
+    std::string to_if_guard_fails{}; ///< Empty to stop
+  };
+
+  /**
+   * @throws std::runtime_error if the definition is invalid (e.g. unknown or duplicate state names)
+   */
+  ModeExecutorStateMachine(
+    ModeExecutorBase & executor, const std::vector<StateDefinition> & states,
+    const std::vector<TransitionDefinition> & transitions);
+  ModeExecutorStateMachine(const ModeExecutorStateMachine &) = delete;
+  ~ModeExecutorStateMachine() {stop();}
+
+  /**
+   * Start executing from the given state. If already running, the current execution is stopped first.
+   * @param on_finished called when a result without transition (or a transition to stop) is reached
+   */
+  void start(StateId initial_state, const FinishedCallback & on_finished = {});
+  void start(const std::string & initial_state, const FinishedCallback & on_finished = {});
+
+  /**
+   * Stop execution. A pending action completing afterwards is ignored. Call this from
+   * ModeExecutorBase::onDeactivate() if the actions are not cancelled by the deactivation.
+   */
+  void stop();
+
+  bool running() const {return _current_state != kStateStop;}
+
+  void setTransitionCallback(const TransitionCallback & on_transition)
+  {
+    _on_transition = on_transition;
+  }
+
+  // Introspection
+
+  StateId currentState() const {return _current_state;}
+  const std::string & currentStateName() const;
+  size_t numStates() const {return _states.size();}
+  const std::string & stateName(StateId state) const;
+
+  /**
+   * @throws std::runtime_error if there is no state with that name
+   */
+  StateId stateId(const std::string & name) const;
+
+  /**
+   * Get the transition target for a result, evaluating the guard if there is one
+   */
+  StateId transitionTarget(StateId from, Result result) const;
+
+  /**
+   * Time since the current state was entered
+   */
+  rclcpp::Duration timeInCurrentState() const;
+
+private:
+  static constexpr int kNumResults = 6;
+  static constexpr uint16_t kNoGuard = std::numeric_limits<uint16_t>::max();
+
+  struct State
+  {
+    std::string name;
+    Action action;
+    std::chrono::milliseconds timeout;
+    Cancel cancel;
+  };
+
+  struct Transition
+  {
+    StateId target{kStateStop};
+    StateId target_if_guard_fails{kStateStop};
+    uint16_t guard{kNoGuard};
+  };
+
+  static int resultIndex(Result result);
+
+  StateId lookupState(const std::string & name) const;
+  void runState(StateId state);
+  StateId transition(Result result);
+  void actionCompleted(uint32_t generation, Result result);
+  void stateTimedOut(uint32_t generation);
+
+  rclcpp::Node & _node;
+  std::vector<State> _states;
+  std::unordered_map<std::string, StateId> _state_ids;
+  std::vector<Transition> _table; ///< kNumResults entries per state
+  std::vector<Guard> _guards;
+
+  StateId _current_state{kStateStop};
+  uint32_t _generation{0}; ///< Incremented on every state entry, to discard outdated completions
+  bool _in_action{false};
+  bool _completed_in_action{false};
+  Result _result_in_action{Result::Success};
+  rclcpp::Time _state_entry_time{};
+  std::shared_ptr<NodeTimerWheel> _timer_wheel;
+  TimerWheel::Handle _state_timeout;
+
+  TransitionCallback _on_transition;
+  FinishedCallback _on_finished;
+};
+
+/** @}*/
+} // namespace px4_ros2
@@ -0,0 +1,174 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <px4_ros2/common/context.hpp>
+#include <px4_ros2/utils/subscription.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace px4_ros2
+{
+/** \ingroup components
+ *  @{
+ */
+
+/**
+ * @brief Estimates offset and drift between a remote and the local clock from timestamped messages.
+ *
+ * Each sample pairs the remote timestamp of a message with its local receive time. The difference contains
+ * the clock offset plus a variable transport delay, which is always positive. So per time bucket only the
+ * sample with the smallest difference (i.e. the least delayed) is kept, and a line is fit through these
+ * minima of the sliding window. The fit uses the Theil-Sen estimator (median of the pairwise slopes),
+ * which is robust against up to ~29% of outliers, e.g. buckets in which all messages got delayed.
+ *
+ * The estimated offset thus includes the minimum transport delay.
+ *
+ * All times are in microseconds.
+ */
+class ClockOffsetEstimator
+{
+public:
+  static constexpr double kMaxDrift = 1e-3; ///< 1000 ppm, anything larger is not a clock drift
+
+  /**
+   * @param bucket_duration remote time span over which the minimum delay sample is kept
+   * @param num_buckets size of the sliding window (in buckets) to fit over
+   */
+  explicit ClockOffsetEstimator(
+    std::chrono::microseconds bucket_duration = std::chrono::seconds(1),
+    size_t num_buckets = 30);
+
+  void addSample(uint64_t remote_us, int64_t local_us);
+  void reset();
+
+  /**
+   * @return true once there is an estimate (i.e. after the first sample)
+   */
+  bool valid() const {return _valid;}
+
+  int64_t remoteToLocal(uint64_t remote_us) const;
+  uint64_t localToRemote(int64_t local_us) const;
+
+  /**
+   * @return estimated local - remote time at the most recent bucket [us]
+   */
+  double offset() const {return _offset;}
+
+  /**
+   * @return estimated relative drift of the local clock w.r.t. the remote clock (e.g. 1e-5 = 10 ppm)
+   */
+  double drift() const {return _drift;}
+
+  /**
+   * @return number of (completed) buckets the estimate is based on
+   */
+  size_t numBuckets() const {return _num_buckets;}
+
+private:
+  struct Point
+  {
+    int64_t remote;
+    int64_t difference; ///< local - remote
+  };
+
+  void completeBucket();
+  void fit();
+
+  const int64_t _bucket_duration;
+  std::vector<Point> _buckets; ///< ring buffer of per-bucket minima
+  size_t _next{0};
+  size_t _num_buckets{0};
+
+  bool _has_current_bucket{false};
+  int64_t _current_bucket_index{0};
+  Point _current_bucket_min{};
+
+  bool _valid{false};
+  int64_t _reference_remote{0};
+  double _offset{0.}; ///< at _reference_remote
+  double _drift{0.};
+
+  std::vector<double> _scratch; ///< avoids allocating for each fit
+};
+
+/**
+ * @brief Maps between FMU timestamps (FMU boot-relative) and ROS time of the node.
+ *
+ * The estimate is derived from the timestamps of incoming FMU messages (see ClockOffsetEstimator). Add
+ * subscriptions with addSource(), ideally of a topic with a steady, high rate.
+ *
+ * Since the estimated offset includes the minimum transport delay, timestamps converted to the FMU clock are
+ * slightly too early. This can be compensated with setTransportDelay(), e.g. with the one-way delay
+ * estimate of a LinkLatencyProbe.
+ */
+class TimeSync
+{
+public:
+  explicit TimeSync(Context & context);
+  TimeSync(
+    Context & context, std::chrono::microseconds bucket_duration,
+    size_t num_buckets);
+
+  /**
+   * Use the messages of a subscription for the estimate. The message type needs a 'timestamp' field in FMU
+   * time [us].
+   */
+  template<typename RosMessageType>
+  void addSource(Subscription<RosMessageType> & subscription)
+  {
+    subscription.onUpdate(
+      [this, &subscription](const RosMessageType & msg) {
+        addSample(msg.timestamp, subscription.lastTime());
+      });
+  }
+
+  /**
+   * Add a sample manually
+   * @param fmu_timestamp_us message timestamp in FMU time
+   * @param receive_time local ROS time at which the message was received
+   */
+  void addSample(uint64_t fmu_timestamp_us, const rclcpp::Time & receive_time);
+
+  /**
+   * Set the minimum one-way transport delay from the FMU to this node
+   */
+  void setTransportDelay(std::chrono::microseconds delay) {_transport_delay_us = delay.count();}
+
+  /**
+   * Reset the estimate, e.g. after an FMU reboot. A reboot is also detected automatically by a jump back
+   * in time of the FMU timestamps.
+   */
+  void reset() {_estimator.reset();}
+
+  bool valid() const {return _estimator.valid();}
+
+  rclcpp::Time fmuToRos(uint64_t fmu_timestamp_us) const;
+  uint64_t rosToFmu(const rclcpp::Time & time) const;
+
+  /**
+   * @return current time in the FMU clock [us], e.g. to fill in setpoint timestamps
+   */
+  uint64_t fmuNow() const;
+
+  /**
+   * @return estimated ROS time - FMU time [us]
+   */
+  double offsetUs() const {return _estimator.offset() - static_cast<double>(_transport_delay_us);}
+  double driftPpm() const {return _estimator.drift() * 1e6;}
+
+  const ClockOffsetEstimator & estimator() const {return _estimator;}
+
+private:
+  rclcpp::Node & _node;
+  ClockOffsetEstimator _estimator;
+  int64_t _transport_delay_us{0};
+};
+
+/** @}*/
+} // namespace px4_ros2
@@ -0,0 +1,184 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include "mode.hpp"
+
+#include <px4_ros2/utils/subscription.hpp>
+#include <px4_ros2/utils/timer_wheel.hpp>
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace px4_ros2
+{
+/** \ingroup components
+ *  @{
+ */
+
+/**
+ * @brief Predicate over the last message of a Subscription, combinable with && and ||.
+ *
+ * The predicate is only evaluated when the subscription receives a message (and once when a wait starts).
+ * It is false as long as no message got received.
+ *
+ * Example:
+ * @code{.cpp}
+ * const px4_ros2::WaitCondition altitude_reached(*_local_position,
+ *   [](const px4_msgs::msg::VehicleLocalPosition & msg) {return -msg.z > 10.f;});
+ * const px4_ros2::WaitCondition battery_low(*_battery,
+ *   [](const px4_msgs::msg::BatteryStatus & msg) {return msg.remaining < 0.2f;});
+ * waitUntil(altitude_reached || battery_low, [](px4_ros2::Result result) {...});
+ * @endcode
+ */
+class WaitCondition
+{
+public:
+  template<typename RosMessageType, typename PredicateT>
+  WaitCondition(Subscription<RosMessageType> & subscription, PredicateT predicate)
+  {
+    auto node = std::make_shared<Node>();
+    node->type = Type::Leaf;
+    node->source = &subscription;
+    node->evaluate = [&subscription, predicate = std::move(predicate)]() {
+        return subscription.lastTime().nanoseconds() != 0 && predicate(subscription.last());
+      };
+    node->subscribe = [&subscription](const std::function<void()> & on_update) {
+        subscription.onUpdate([on_update](const RosMessageType &) {on_update();});
+      };
+    _node = std::move(node);
+  }
+
+  friend WaitCondition operator&&(const WaitCondition & lhs, const WaitCondition & rhs)
+  {
+    return WaitCondition(Type::And, lhs, rhs);
+  }
+
+  friend WaitCondition operator||(const WaitCondition & lhs, const WaitCondition & rhs)
+  {
+    return WaitCondition(Type::Or, lhs, rhs);
+  }
+
+private:
+  friend class ConditionWaiter;
+
+  enum class Type
+  {
+    Leaf,
+    And,
+    Or
+  };
+
+  struct Node
+  {
+    Type type{Type::Leaf};
+    const void * source{nullptr}; ///< Subscription of a leaf
+    std::function<bool ()> evaluate;
+    std::function<void (const std::function<void()> &)> subscribe; ///< Register an update callback
+    std::shared_ptr<const Node> lhs;
+    std::shared_ptr<const Node> rhs;
+  };
+
+  WaitCondition(Type type, const WaitCondition & lhs, const WaitCondition & rhs)
+  {
+    auto node = std::make_shared<Node>();
+    node->type = type;
+    node->lhs = lhs._node;
+    node->rhs = rhs._node;
+    _node = std::move(node);
+  }
+
+  std::shared_ptr<const Node> _node;
+};
+
+/**
+ * @brief Event-driven waiting on any number of WaitCondition's at the same time.
+ *
+ * A wait is only re-evaluated when one of the subscriptions it references receives a message, and only
+ * the predicates on that subscription are evaluated again.
+ * The referenced subscriptions must outlive the waiter.
+ */
+class ConditionWaiter
+{
+public:
+  using CompletedCallback = std::function<void (Result)>;
+  using WaitId = uint64_t;
+
+  explicit ConditionWaiter(rclcpp::Node & node);
+  ConditionWaiter(const ConditionWaiter &) = delete;
+  ~ConditionWaiter();
+
+  /**
+   * Wait until the condition is true. If it is already true, the callback is called immediately.
+   * @param timeout if > 0, the callback is called with Result::Timeout if the condition is not met in time
+   * @return id to cancel the wait
+   */
+  WaitId waitUntil(
+    const WaitCondition & condition, const CompletedCallback & on_completed,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero());
+
+  /**
+   * Cancel a wait, calling its callback with the given result
+   * @return false if the wait is not active anymore
+   */
+  bool cancel(WaitId id, Result result = Result::Deactivated);
+  void cancelAll(Result result = Result::Deactivated);
+
+  size_t numActive() const {return _waits.size();}
+
+private:
+  using ConditionNode = WaitCondition::Node;
+
+  /// Condition in postfix order, so it can be evaluated without recursion
+  struct Instruction
+  {
+    WaitCondition::Type type;
+    uint16_t leaf;
+  };
+
+  struct Wait
+  {
+    std::vector<Instruction> program;
+    std::vector<std::shared_ptr<const ConditionNode>> leaves;
+    std::vector<bool> leaf_values;
+    CompletedCallback on_completed;
+    TimerWheel::Handle timeout;
+  };
+
+  struct Listener
+  {
+    WaitId wait_id;
+    uint16_t leaf;
+  };
+
+  struct Source
+  {
+    std::vector<Listener> listeners; ///< Entries of completed waits are removed lazily
+  };
+
+  static void compile(const std::shared_ptr<const ConditionNode> & node, Wait & wait);
+  static bool evaluate(const Wait & wait);
+
+  void sourceUpdated(const void * source);
+  void complete(WaitId id, Result result);
+
+  std::shared_ptr<NodeTimerWheel> _timer_wheel;
+  std::unordered_map<WaitId, Wait> _waits;
+  std::unordered_map<const void *, Source> _sources;
+  WaitId _next_wait_id{0};
+  /// Subscription callbacks cannot be removed, so they check this for whether the waiter still exists
+  std::shared_ptr<ConditionWaiter *> _self;
+};
+
+/** @}*/
+} // namespace px4_ros2
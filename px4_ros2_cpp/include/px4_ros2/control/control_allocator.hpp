@@ -0,0 +1,100 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <Eigen/Core>
+
+#include <px4_ros2/control/setpoint_types/direct_actuators.hpp>
+
+namespace px4_ros2
+{
+/** \ingroup control
+ *  @{
+ */
+
+/**
+ * @brief Maps thrust and torque setpoints to motor commands
+ *
+ * The (weighted) pseudo-inverse of the actuator effectiveness matrix is computed once on
+ * construction. Each allocation then uses fixed-size matrices only and prioritizes the controls when
+ * actuators saturate: thrust is reduced before roll and pitch, and yaw has the lowest priority (same
+ * as the sequential desaturation of PX4 with airmode disabled).
+ *
+ * The output can be passed directly to DirectActuatorsSetpointType::updateMotors():
+ * @code
+ * direct_actuators->updateMotors(allocator.allocate(thrust_frd, torque_frd));
+ * @endcode
+ */
+class ControlAllocator
+{
+public:
+  static constexpr int kMaxNumActuators = DirectActuatorsSetpointType::kMaxNumMotors;
+  static constexpr int kNumControls = 6; ///< roll, pitch, yaw torque, x, y, z thrust (FRD)
+
+  using EffectivenessMatrix = Eigen::Matrix<float, kNumControls, kMaxNumActuators>;
+  using ActuatorVector = Eigen::Matrix<float, kMaxNumActuators, 1>;
+  using ControlVector = Eigen::Matrix<float, kNumControls, 1>;
+
+  struct Settings
+  {
+    /// Higher weights make the pseudo-inverse use an actuator less
+    ActuatorVector weights{ActuatorVector::Ones()};
+    ActuatorVector actuator_min{ActuatorVector::Zero()};
+    ActuatorVector actuator_max{ActuatorVector::Ones()};
+  };
+
+  /**
+   * @param effectiveness maps actuator commands u to the controls: control = effectiveness * u
+   * @param num_actuators number of used actuators (columns)
+   * @throws std::runtime_error on invalid arguments
+   */
+  ControlAllocator(const EffectivenessMatrix & effectiveness, int num_actuators);
+  ControlAllocator(
+    const EffectivenessMatrix & effectiveness, int num_actuators,
+    const Settings & settings);
+
+  /**
+   * Allocate a setpoint
+   * @param thrust_frd normalized thrust in body frame
+   * @param torque_frd normalized torque in body frame
+   * @return actuator commands, NAN for unused actuators
+   */
+  ActuatorVector allocate(const Eigen::Vector3f & thrust_frd, const Eigen::Vector3f & torque_frd);
+
+  /**
+   * @return controls achieved by the last allocation. They differ from the setpoint when saturating.
+   */
+  const ControlVector & allocatedControl() const {return _allocated_control;}
+
+  const EffectivenessMatrix & effectiveness() const {return _effectiveness;}
+
+  /**
+   * @return the weighted pseudo-inverse of the effectiveness matrix
+   */
+  const Eigen::Matrix<float, kMaxNumActuators, kNumControls> & mix() const {return _mix;}
+
+private:
+  /**
+   * Compute the gain to add to an actuator setpoint along a vector, so that the setpoint is within
+   * the limits
+   */
+  float desaturationGain(
+    const ActuatorVector & desaturation_vector, const ActuatorVector & actuator_sp,
+    const ActuatorVector & actuator_max) const;
+
+  void desaturate(
+    ActuatorVector & actuator_sp, const ActuatorVector & desaturation_vector,
+    const ActuatorVector & actuator_max, bool increase_only = false) const;
+
+  const int _num_actuators;
+  const Settings _settings;
+  EffectivenessMatrix _effectiveness;
+  Eigen::Matrix<float, kMaxNumActuators, kNumControls> _mix;
+  ControlVector _allocated_control{ControlVector::Zero()};
+};
+
+/** @}*/
+} // namespace px4_ros2
@@ -0,0 +1,134 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include <px4_ros2/common/context.hpp>
+#include <px4_ros2/control/setpoint_types/experimental/attitude.hpp>
+#include <px4_ros2/control/trajectory/polynomial_trajectory.hpp>
+#include <px4_ros2/odometry/attitude.hpp>
+#include <px4_ros2/odometry/local_position.hpp>
+
+#include <cstdint>
+#include <memory>
+
+namespace px4_ros2
+{
+/** \ingroup control
+ *  @{
+ */
+
+/**
+ * @brief Geometric tracking controller on SE(3) for multicopters (position loop)
+ *
+ * Computes the desired thrust vector from position and velocity errors plus the reference
+ * acceleration. The attitude setpoint aligns the body z-axis with it at the reference yaw, and the
+ * collective thrust is the projection onto the current body z-axis (Lee et al., "Geometric tracking
+ * control of a quadrotor UAV on SE(3)", 2010). The attitude loop runs on the FMU.
+ */
+class GeometricPositionController
+{
+public:
+  struct Gains
+  {
+    Eigen::Vector3f position{1.f, 1.f, 1.f}; ///< [1/s^2]
+    Eigen::Vector3f velocity{1.8f, 1.8f, 4.f}; ///< [1/s]
+    Eigen::Vector3f integral{Eigen::Vector3f::Zero()}; ///< [1/s^3] on the position error
+    Eigen::Vector3f integrator_limit{1.f, 1.f, 1.f}; ///< [m/s^2]
+  };
+
+  struct Settings
+  {
+    float hover_thrust{0.5f}; ///< normalized thrust to hover
+    float min_thrust{0.1f};
+    float max_thrust{1.f};
+    float max_tilt_rad{0.785f};
+  };
+
+  struct State
+  {
+    Eigen::Vector3f position_ned_m;
+    Eigen::Vector3f velocity_ned_m_s;
+    Eigen::Quaternionf attitude;
+  };
+
+  struct Output
+  {
+    Eigen::Quaternionf attitude;
+    Eigen::Vector3f thrust_frd; ///< normalized
+    float yaw_rate_rad_s; ///< yaw setpoint move rate
+  };
+
+  static constexpr float kGravity = 9.80665f; ///< [m/s^2]
+
+  GeometricPositionController() = default;
+  GeometricPositionController(const Gains & gains, const Settings & settings)
+  : _gains(gains), _settings(settings) {}
+
+  void setGains(const Gains & gains) {_gains = gains;}
+  void reset() {_integral.setZero();}
+
+  /**
+   * Run the controller
+   * @param reference reference position, velocity and acceleration. Unset (NAN) yaw keeps the
+   * current heading.
+   * @param dt_s [s] time since the last update, for the integrator
+   */
+  Output update(const State & state, const TrajectorySample & reference, float dt_s);
+
+  const Eigen::Vector3f & integral() const {return _integral;}
+
+private:
+  Gains _gains;
+  Settings _settings;
+  Eigen::Vector3f _integral{Eigen::Vector3f::Zero()}; ///< [m/s^2] subtracted from the force
+};
+
+/**
+ * @brief Position tracking with a GeometricPositionController, sending attitude setpoints
+ *
+ * The position and velocity are predicted to the current time to compensate for the odometry
+ * latency. Call update() with the reference at the setpoint rate (100-250 Hz), e.g. from a mode's
+ * updateSetpoint().
+ */
+class GeometricTrackingController
+{
+public:
+  GeometricTrackingController(
+    Context & context, std::shared_ptr<AttitudeSetpointType> attitude_setpoint);
+  GeometricTrackingController(
+    Context & context, std::shared_ptr<AttitudeSetpointType> attitude_setpoint,
+    const GeometricPositionController::Gains & gains,
+    const GeometricPositionController::Settings & settings);
+
+  /**
+   * Compute and send the attitude setpoint for a reference
+   * @return false if the odometry is not valid (nothing is sent)
+   */
+  bool update(const TrajectorySample & reference);
+
+  /**
+   * Reset the integrator and time step, e.g. when the mode gets activated
+   */
+  void reset();
+
+  void setTimeSync(const TimeSync & time_sync) {_local_position.setTimeSync(time_sync);}
+
+  GeometricPositionController & controller() {return _controller;}
+
+private:
+  rclcpp::Node & _node;
+  std::shared_ptr<AttitudeSetpointType> _attitude_setpoint;
+  OdometryLocalPosition _local_position;
+  OdometryAttitude _attitude;
+  GeometricPositionController _controller;
+  int64_t _last_update_ns{0};
+};
+
+/** @}*/
+} // namespace px4_ros2
@@ -0,0 +1,146 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <Eigen/Core>
+
+#include <px4_ros2/common/context.hpp>
+#include <px4_ros2/control/control_allocator.hpp>
+#include <px4_ros2/control/setpoint_types/direct_actuators.hpp>
+#include <px4_ros2/control/setpoint_types/experimental/thrust_torque.hpp>
+#include <px4_ros2/odometry/angular_velocity.hpp>
+
+#include <cstdint>
+#include <memory>
+
+namespace px4_ros2
+{
+/** \ingroup control
+ *  @{
+ */
+
+/**
+ * @brief PID body rate controller producing normalized torques
+ *
+ * The derivative term acts on the measured rate and is low-pass filtered. The integrator is
+ * limited, stops growing in the direction of a saturated output, and grows slower for large errors.
+ */
+class RateController
+{
+public:
+  struct Gains
+  {
+    Eigen::Vector3f p{0.15f, 0.15f, 0.2f};
+    Eigen::Vector3f i{0.2f, 0.2f, 0.1f};
+    Eigen::Vector3f d{0.003f, 0.003f, 0.f};
+    Eigen::Vector3f feed_forward{Eigen::Vector3f::Zero()};
+    Eigen::Vector3f integrator_limit{0.3f, 0.3f, 0.3f};
+    float derivative_cutoff_hz{30.f};
+  };
+
+  RateController() = default;
+  explicit RateController(const Gains & gains)
+  : _gains(gains) {}
+
+  void setGains(const Gains & gains) {_gains = gains;}
+  const Gains & gains() const {return _gains;}
+
+  void reset();
+
+  /**
+   * Set the saturation of the last output, e.g. from the control allocation.
+   * @param positive per axis, whether the torque could not be increased further
+   * @param negative per axis, whether the torque could not be decreased further
+   */
+  void setSaturation(
+    const Eigen::Matrix<bool, 3, 1> & positive,
+    const Eigen::Matrix<bool, 3, 1> & negative);
+
+  /**
+   * Run the controller
+   * @param rate_setpoint_frd [rad/s]
+   * @param rate_frd [rad/s] measured
+   * @param dt_s [s] time since the last update. The integrator and derivative are not updated for
+   * invalid values.
+   * @return normalized torque FRD
+   */
+  Eigen::Vector3f update(
+    const Eigen::Vector3f & rate_setpoint_frd, const Eigen::Vector3f & rate_frd,
+    float dt_s);
+
+  const Eigen::Vector3f & integral() const {return _integral;}
+
+private:
+  static constexpr float kMaxDt = 0.1f; ///< [s] Longer intervals restart the derivative
+
+  Gains _gains;
+  Eigen::Vector3f _integral{Eigen::Vector3f::Zero()};
+  Eigen::Vector3f _previous_rate{Eigen::Vector3f::Zero()};
+  Eigen::Vector3f _rate_derivative{Eigen::Vector3f::Zero()};
+  bool _has_previous_rate{false};
+  Eigen::Matrix<bool, 3, 1> _saturation_positive{Eigen::Matrix<bool, 3, 1>::Constant(false)};
+  Eigen::Matrix<bool, 3, 1> _saturation_negative{Eigen::Matrix<bool, 3, 1>::Constant(false)};
+};
+
+/**
+ * @brief Body rate control loop running on each angular velocity sample
+ *
+ * The controller runs directly in the angular velocity subscription callback, and the output is
+ * either sent as torque setpoint (allocation on the FMU), or allocated locally and sent as motor
+ * commands. The time step is taken from the sample timestamps, so transport jitter does not
+ * affect it.
+ *
+ * The loop is disabled initially. A mode would typically enable it in onActivate() and disable it
+ * in onDeactivate(), and set the setpoint in updateSetpoint().
+ */
+class BodyRateController
+{
+public:
+  BodyRateController(
+    Context & context, std::shared_ptr<ThrustTorqueSetpointType> thrust_torque_setpoint,
+    const RateController::Gains & gains = {});
+
+  BodyRateController(
+    Context & context, std::shared_ptr<DirectActuatorsSetpointType> direct_actuators_setpoint,
+    std::shared_ptr<ControlAllocator> allocator, const RateController::Gains & gains = {});
+
+  /**
+   * @param rates_frd [rad/s] body rate setpoint
+   * @param thrust_frd normalized thrust
+   */
+  void setSetpoint(const Eigen::Vector3f & rates_frd, const Eigen::Vector3f & thrust_frd);
+
+  /**
+   * Enable or disable the loop. The controller state is reset when enabling.
+   */
+  void setEnabled(bool enabled);
+  bool enabled() const {return _enabled;}
+
+  RateController & controller() {return _controller;}
+
+  /**
+   * @return the last computed torque (before saturation)
+   */
+  const Eigen::Vector3f & lastTorque() const {return _last_torque;}
+
+private:
+  void onAngularVelocity(const px4_msgs::msg::VehicleAngularVelocity & angular_velocity);
+
+  OdometryAngularVelocity _angular_velocity;
+  std::shared_ptr<ThrustTorqueSetpointType> _thrust_torque_setpoint;
+  std::shared_ptr<DirectActuatorsSetpointType> _direct_actuators_setpoint;
+  std::shared_ptr<ControlAllocator> _allocator;
+  RateController _controller;
+
+  Eigen::Vector3f _rates_setpoint{Eigen::Vector3f::Zero()};
+  Eigen::Vector3f _thrust_setpoint{Eigen::Vector3f::Zero()};
+  Eigen::Vector3f _last_torque{Eigen::Vector3f::Zero()};
+  uint64_t _last_timestamp_sample{0};
+  bool _enabled{false};
+};
+
+/** @}*/
+} // namespace px4_ros2
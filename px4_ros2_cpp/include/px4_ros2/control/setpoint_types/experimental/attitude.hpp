@@ -9,6 +9,9 @@
 #include <Eigen/Eigen>
 
 #include <px4_ros2/common/setpoint_base.hpp>
+#include <px4_ros2/utils/serialized_message_template.hpp>
+
+#include <memory>
 
 namespace px4_ros2
 {
@@ -51,6 +54,8 @@ private:
   rclcpp::Node & _node;
   rclcpp::Publisher<px4_msgs::msg::VehicleAttitudeSetpoint>::SharedPtr
     _vehicle_attitude_setpoint_pub;
+  std::unique_ptr<SerializedMessageTemplate<px4_msgs::msg::VehicleAttitudeSetpoint>>
+    _serialized_setpoint;
 };
 
 /** @}*/
@@ -0,0 +1,53 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <px4_msgs/msg/vehicle_thrust_setpoint.hpp>
+#include <px4_msgs/msg/vehicle_torque_setpoint.hpp>
+#include <Eigen/Core>
+
+#include <px4_ros2/common/setpoint_base.hpp>
+
+namespace px4_ros2
+{
+/** \ingroup setpoint_types_experimental
+ *  @{
+ */
+
+/**
+ * @brief Setpoint type for thrust and torque control
+ *
+ * The FMU rate controller is disabled, while the control allocation stays enabled and maps the
+ * setpoints to the actuators. This allows running a custom rate controller.
+*/
+class ThrustTorqueSetpointType : public SetpointBase
+{
+public:
+  explicit ThrustTorqueSetpointType(Context & context);
+
+  ~ThrustTorqueSetpointType() override = default;
+
+  Configuration getConfiguration() override;
+  float desiredUpdateRateHz() override {return 200.f;}
+
+  /**
+   * @brief Thrust and torque setpoint update
+   *
+   * @param thrust_setpoint_frd normalized thrust [-1, 1] in body frame (FRD)
+   * @param torque_setpoint_frd normalized torque [-1, 1] in body frame (FRD)
+   */
+  void update(
+    const Eigen::Vector3f & thrust_setpoint_frd,
+    const Eigen::Vector3f & torque_setpoint_frd);
+
+private:
+  rclcpp::Node & _node;
+  rclcpp::Publisher<px4_msgs::msg::VehicleThrustSetpoint>::SharedPtr _vehicle_thrust_setpoint_pub;
+  rclcpp::Publisher<px4_msgs::msg::VehicleTorqueSetpoint>::SharedPtr _vehicle_torque_setpoint_pub;
+};
+
+/** @}*/
+} /* namespace px4_ros2 */
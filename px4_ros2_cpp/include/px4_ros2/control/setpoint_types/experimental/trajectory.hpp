@@ -9,6 +9,10 @@
 #include <Eigen/Eigen>
 
 #include <px4_ros2/common/setpoint_base.hpp>
+#include <px4_ros2/control/trajectory/polynomial_trajectory.hpp>
+#include <px4_ros2/utils/serialized_message_template.hpp>
+
+#include <memory>
 
 namespace px4_ros2
 {
@@ -46,9 +50,44 @@ public:
   void updatePosition(
     const Eigen::Vector3f & position_ned_m);
 
+  /**
+   * @brief Full kinematic state setpoint update, e.g. sampled from a trajectory.
+   */
+  void update(const TrajectorySample & sample);
+
+  /**
+   * @brief Set a trajectory to follow with updateFromTrajectory().
+   *
+   * The trajectory is shared and not copied. It must not be sampled concurrently from another thread.
+   * @param start_time time at which the start of the trajectory is reached
+   */
+  void setTrajectory(
+    std::shared_ptr<const PolynomialTrajectory> trajectory,
+    const rclcpp::Time & start_time);
+
+  void clearTrajectory() {_trajectory.reset();}
+
+  /**
+   * @brief Sample the trajectory at the current time and send it as setpoint.
+   *
+   * Call this at the setpoint rate. After the end of the trajectory, the final position is held.
+   * @return false if there is no trajectory (nothing is sent)
+   */
+  bool updateFromTrajectory();
+
+  /**
+   * @return true if there is no trajectory or the end has been reached
+   */
+  bool trajectoryFinished() const;
+
 private:
   rclcpp::Node & _node;
   rclcpp::Publisher<px4_msgs::msg::TrajectorySetpoint>::SharedPtr _trajectory_setpoint_pub;
+  std::unique_ptr<SerializedMessageTemplate<px4_msgs::msg::TrajectorySetpoint>>
+    _serialized_setpoint;
+
+  std::shared_ptr<const PolynomialTrajectory> _trajectory;
+  rclcpp::Time _trajectory_start_time;
 };
 
 /** @}*/
@@ -0,0 +1,127 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <Eigen/Core>
+
+#include <px4_ros2/control/trajectory/polynomial_trajectory.hpp>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace px4_ros2
+{
+/** \ingroup trajectory
+ *  @{
+ */
+
+/**
+ * @brief Generator for smooth trajectories through waypoints, minimizing the integral of a squared
+ * derivative of the position (and yaw)
+ *
+ * The optimal trajectory for given segment durations consists of polynomials of degree
+ * 2 * Derivative - 1, which are continuous up to derivative 2 * Derivative - 2. The velocity,
+ * acceleration (and jerk) at the waypoints are obtained from a block-tridiagonal system, which is
+ * solved in linear time using fixed-size matrices. The solve does not allocate memory, and the output
+ * trajectory reuses its capacity, so replanning at the control rate is possible.
+ *
+ * Example:
+ * @code
+ * auto trajectory = std::make_shared<PolynomialTrajectory>();
+ * generator.generate(waypoints, *trajectory);
+ * trajectory_setpoint.setTrajectory(trajectory, node.get_clock()->now());
+ * // then call trajectory_setpoint.updateFromTrajectory() at the setpoint rate
+ * @endcode
+ */
+template<int Derivative>
+class MinimumDerivativeTrajectoryGenerator
+{
+public:
+  static_assert(
+    Derivative >= 2 && 2 * Derivative <= PolynomialTrajectory::kNumCoefficients,
+    "Unsupported derivative");
+
+  static constexpr int kMaxNumWaypoints = 32; ///< Including the start
+
+  struct Settings
+  {
+    // Used to compute the segment durations for waypoints without a given duration
+    float max_velocity_m_s{5.f};
+    float max_acceleration_m_s2{3.f};
+    float max_yaw_rate_rad_s{1.f};
+    float min_segment_duration_s{0.1f};
+  };
+
+  struct Waypoint
+  {
+    Eigen::Vector3f position_ned_m{Eigen::Vector3f::Zero()};
+    float yaw_ned_rad{NAN}; ///< Yaw is only controlled if set for all waypoints
+    float duration_s{NAN}; ///< Time to reach the waypoint from the previous one, NAN to compute it
+  };
+
+  MinimumDerivativeTrajectoryGenerator();
+  explicit MinimumDerivativeTrajectoryGenerator(const Settings & settings);
+
+  /**
+   * Generate a trajectory through all waypoints, starting and ending at rest
+   * @throws std::runtime_error if there are less than 2 or more than kMaxNumWaypoints waypoints
+   */
+  void generate(const std::vector<Waypoint> & waypoints, PolynomialTrajectory & trajectory);
+
+  /**
+   * Generate a trajectory from a given state (e.g. sampled from the currently flown trajectory)
+   * through all waypoints, ending at rest. Higher derivatives at the start are 0.
+   * @throws std::runtime_error if there are no or more than kMaxNumWaypoints - 1 waypoints
+   */
+  void generate(
+    const TrajectorySample & start, const std::vector<Waypoint> & waypoints,
+    PolynomialTrajectory & trajectory);
+
+  const Settings & settings() const {return _settings;}
+
+private:
+  static constexpr int kNumAxes = PolynomialTrajectory::kNumAxes;
+  static constexpr int kNumFree = Derivative - 1; ///< Free derivatives per waypoint
+
+  using State = Eigen::Matrix<double, Derivative, kNumAxes>; ///< Row i is the i-th derivative
+  using FreeState = Eigen::Matrix<double, kNumFree, kNumAxes>;
+  using Block = Eigen::Matrix<double, kNumFree, kNumFree>;
+  using ContinuityRows = Eigen::Matrix<double, kNumFree, 2 * Derivative>;
+
+  void addPoint(const Eigen::Vector3f & position_ned_m, float yaw_ned_rad);
+  void addSegmentDuration(float duration_s);
+  void solve(PolynomialTrajectory & trajectory);
+
+  /**
+   * Map the boundary states of a segment to its derivatives Derivative..2*Derivative-2 at the start
+   * or end
+   */
+  ContinuityRows scaledContinuity(const ContinuityRows & unit_continuity, double duration) const;
+
+  const Settings _settings;
+
+  // Precomputed on the unit interval
+  Eigen::Matrix<double, 2 * Derivative, 2 * Derivative> _boundary_to_coefficients;
+  ContinuityRows _start_continuity;
+  ContinuityRows _end_continuity;
+
+  int _num_points{0};
+  bool _yaw_enabled{false};
+  std::array<State, kMaxNumWaypoints> _states;
+  std::array<double, kMaxNumWaypoints> _durations; ///< Segment from point i to i + 1
+
+  // Block-tridiagonal solver state
+  std::array<Block, kMaxNumWaypoints> _diagonal_inverse;
+  std::array<Block, kMaxNumWaypoints> _upper;
+  std::array<FreeState, kMaxNumWaypoints> _rhs;
+};
+
+using MinimumJerkTrajectoryGenerator = MinimumDerivativeTrajectoryGenerator<3>;
+using MinimumSnapTrajectoryGenerator = MinimumDerivativeTrajectoryGenerator<4>;
+
+/** @}*/
+} // namespace px4_ros2
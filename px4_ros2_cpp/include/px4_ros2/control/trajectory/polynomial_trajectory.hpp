@@ -0,0 +1,100 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <Eigen/Core>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace px4_ros2
+{
+/** \ingroup trajectory
+ *  @{
+ */
+
+/**
+ * @brief Kinematic state along a trajectory
+ */
+struct TrajectorySample
+{
+  Eigen::Vector3f position_ned_m{Eigen::Vector3f::Zero()};
+  Eigen::Vector3f velocity_ned_m_s{Eigen::Vector3f::Zero()};
+  Eigen::Vector3f acceleration_ned_m_s2{Eigen::Vector3f::Zero()};
+  float yaw_ned_rad{NAN}; ///< NAN if yaw is not controlled
+  float yaw_rate_ned_rad_s{NAN};
+};
+
+/**
+ * @brief Piecewise polynomial trajectory in NED, including yaw
+ *
+ * Each segment holds one polynomial per axis (x, y, z and yaw), evaluated in the segment's local time.
+ * Sampling evaluates all axes and derivatives at once as a fixed-size matrix product, and finding the
+ * segment is O(1) for monotonically increasing sample times.
+ */
+class PolynomialTrajectory
+{
+public:
+  static constexpr int kNumCoefficients = 8; ///< Up to degree 7, sufficient for minimum snap
+  static constexpr int kNumAxes = 4; ///< x, y, z [m] and yaw [rad]
+
+  /**
+   * Polynomial coefficients of a segment. Row i is the axis, column k the coefficient of t^k.
+   */
+  using Coefficients = Eigen::Matrix<double, kNumAxes, kNumCoefficients>;
+
+  void reserve(size_t num_segments) {_segments.reserve(num_segments);}
+
+  /**
+   * Remove all segments. The capacity is kept, so the trajectory can be refilled without allocating.
+   */
+  void clear();
+
+  /**
+   * Append a segment
+   * @param duration_s segment duration [s], the polynomials are evaluated for t in [0, duration_s]
+   * @throws std::runtime_error if the duration is not positive
+   */
+  void addSegment(double duration_s, const Coefficients & coefficients);
+
+  size_t numSegments() const {return _segments.size();}
+  bool empty() const {return _segments.empty();}
+  double duration() const;
+
+  const Coefficients & coefficients(size_t segment) const {return _segments[segment].coefficients;}
+  double segmentDuration(size_t segment) const {return _segments[segment].duration;}
+
+  /**
+   * Set whether yaw is part of the trajectory. If not, the sampled yaw and yaw rate are NAN.
+   */
+  void setYawEnabled(bool enabled) {_yaw_enabled = enabled;}
+  bool yawEnabled() const {return _yaw_enabled;}
+
+  /**
+   * Sample the trajectory
+   * @param time_s time since the start of the trajectory [s]. Times before the start are clamped. After
+   * the end, the final position and yaw are held with zero derivatives.
+   */
+  TrajectorySample sample(double time_s) const;
+
+private:
+  struct Segment
+  {
+    double start_time;
+    double duration;
+    Coefficients coefficients;
+  };
+
+  size_t findSegment(double time_s) const;
+
+  std::vector<Segment> _segments;
+  mutable size_t _last_segment{0}; ///< Search hint
+  bool _yaw_enabled{true};
+};
+
+/** @}*/
+} // namespace px4_ros2
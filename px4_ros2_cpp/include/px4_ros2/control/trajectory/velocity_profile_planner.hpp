@@ -0,0 +1,139 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <Eigen/Core>
+
+#include <px4_ros2/control/trajectory/polynomial_trajectory.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace px4_ros2
+{
+/** \ingroup trajectory
+ *  @{
+ */
+
+/**
+ * @brief Time-optimal velocity profile along a geometric path
+ *
+ * The path is a polyline through local NED waypoints, discretized along its arc length. The speed at
+ * each point is limited by the velocity limits (depending on the direction), the lateral acceleration
+ * through the corners, and by what can be reached with the acceleration and jerk limits in a backward
+ * and forward pass.
+ *
+ * Corners are rounded with an arc tangential to both edges, starting at the corner acceptance
+ * radius before the vertex (at most half of each edge). The arc radius sets the speed limit through
+ * the corner. Corners too sharp to be taken at a minimum speed (e.g. reversals) are not rounded, and
+ * the profile stops at the vertex instead. Arc lengths and durations refer to the polyline.
+ *
+ * Jerk is limited when ramping up acceleration or deceleration. Changing directly from accelerating
+ * to decelerating is not jerk limited.
+ *
+ * The result can either be followed exactly with a TrajectorySetpointType (see toTrajectory()), or
+ * used to set the speed limits of a GotoSetpointType depending on the vehicle position (see
+ * gotoConstraints()).
+ */
+class VelocityProfilePlanner
+{
+public:
+  struct Settings
+  {
+    float max_horizontal_speed_m_s{5.f};
+    float max_vertical_speed_m_s{2.f};
+    float max_acceleration_m_s2{3.f};
+    float max_jerk_m_s3{10.f};
+    float corner_acceptance_radius_m{1.f}; ///< Distance before a corner at which the turn starts
+    float resolution_m{0.2f}; ///< Maximum discretization step
+  };
+
+  struct GotoConstraints
+  {
+    Eigen::Vector3f position_ned_m; ///< End of the current path segment
+    float max_horizontal_speed_m_s;
+    float max_vertical_speed_m_s;
+  };
+
+  VelocityProfilePlanner();
+  explicit VelocityProfilePlanner(const Settings & settings);
+
+  /**
+   * Plan the velocity profile along a path, ending at rest.
+   * @param path_ned_m path waypoints, starting at the current position
+   * @param start_speed_m_s current speed along the path. It is reduced if stopping is not possible
+   * otherwise.
+   * @throws std::runtime_error if the path has less than 2 distinct waypoints
+   */
+  void plan(const std::vector<Eigen::Vector3f> & path_ned_m, float start_speed_m_s = 0.f);
+
+  double length() const {return _arc_length.empty() ? 0. : _arc_length.back();}
+  double duration() const {return _time.empty() ? 0. : _time.back();}
+
+  /**
+   * @param arc_length_m distance along the path from its start
+   * @return planned speed [m/s]
+   */
+  float speedAt(double arc_length_m) const;
+
+  /**
+   * Convert the profile into a trajectory (one segment per discretization step, without yaw).
+   * The trajectory follows the rounded corners with a continuous velocity. As an arc is shorter
+   * than the corner it replaces, the trajectory is slightly shorter than duration().
+   */
+  void toTrajectory(PolynomialTrajectory & trajectory) const;
+
+  /**
+   * Get the goto setpoint for the current vehicle position. The position is projected onto the path,
+   * and the speed limits are set from the planned speed at that point.
+   */
+  GotoConstraints gotoConstraints(const Eigen::Vector3f & vehicle_position_ned_m);
+
+private:
+  static constexpr float kMinGotoSpeed = 0.2f; ///< [m/s] Avoids stopping before reaching the target
+  static constexpr float kMinCornerSpeed = 0.5f; ///< [m/s] Sharper corners are not rounded
+
+  Eigen::Vector3f edgeDirection(size_t edge) const;
+  double edgeLength(size_t edge) const;
+
+  /**
+   * Point on the arc of a rounded corner
+   * @param arc_length along the polyline, within the corner
+   * @return arc length along the arc, from its start
+   */
+  double cornerPoint(
+    size_t vertex, double arc_length, Eigen::Vector3d & position,
+    Eigen::Vector3d & tangent) const;
+
+  /**
+   * Speed reachable after a step of length distance, with acceleration ramping up from
+   * previous_acceleration
+   */
+  double reachableSpeed(double speed, double previous_acceleration, double distance) const;
+
+  /**
+   * @return acceleration of the step from point index to index + 1
+   */
+  double stepAcceleration(size_t index) const;
+
+  const Settings _settings;
+
+  std::vector<Eigen::Vector3f> _vertices;
+  std::vector<double> _vertex_arc_length;
+  std::vector<double> _corner_tangent_length; ///< Per vertex, 0 if not rounded
+
+  // Discretization points
+  std::vector<double> _arc_length;
+  std::vector<double> _speed;
+  std::vector<double> _time;
+  std::vector<size_t> _edge; ///< Edge of the step starting at the point
+  std::vector<size_t> _corner; ///< Corner vertex of the step starting at the point, 0 if straight
+
+  size_t _goto_edge{0}; ///< Search hint for the projection
+};
+
+/** @}*/
+} // namespace px4_ros2
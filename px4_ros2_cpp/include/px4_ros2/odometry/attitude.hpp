@@ -8,6 +8,7 @@
 #include <Eigen/Eigen>
 #include <px4_msgs/msg/vehicle_attitude.hpp>
 #include <px4_ros2/common/context.hpp>
+#include <px4_ros2/components/time_sync.hpp>
 #include <px4_ros2/utils/geometry.hpp>
 #include <px4_ros2/utils/subscription.hpp>
 
@@ -23,8 +24,20 @@ namespace px4_ros2
 class OdometryAttitude : public Subscription<px4_msgs::msg::VehicleAttitude>
 {
 public:
+  /**
+   * Maximum time span over which predictedAttitude() extrapolates
+   */
+  static constexpr std::chrono::milliseconds kMaxPredictionHorizon{500};
+
   explicit OdometryAttitude(Context & context);
 
+  /**
+   * @brief Use a time synchronization to relate the sample time to the ROS time.
+   *
+   * Without it, the sample time is derived from the receive time, which ignores the transport delay.
+   */
+  void setTimeSync(const TimeSync & time_sync) {_time_sync = &time_sync;}
+
   /**
    * @brief Get the vehicle's attitude.
    *
@@ -65,6 +78,34 @@ public:
   {
     return quaternionToYaw(attitude());
   }
+
+  /**
+   * @brief Get the ROS time at which the last estimate was sampled on the FMU.
+   */
+  rclcpp::Time sampleTime() const;
+
+  /**
+   * @brief Get the attitude extrapolated to a given time, assuming constant angular velocity.
+   *
+   * @param angular_velocity_frd current angular velocity in body FRD frame [rad/s],
+   * e.g. from OdometryAngularVelocity
+   * @param time ROS time
+   * @return the predicted attitude quaternion
+   */
+  Eigen::Quaternionf predictedAttitude(
+    const Eigen::Vector3f & angular_velocity_frd,
+    const rclcpp::Time & time) const;
+
+  /**
+   * @brief Get the attitude extrapolated to the current time.
+   */
+  Eigen::Quaternionf predictedAttitude(const Eigen::Vector3f & angular_velocity_frd) const
+  {
+    return predictedAttitude(angular_velocity_frd, _node.get_clock()->now());
+  }
+
+private:
+  const TimeSync * _time_sync{nullptr};
 };
 
 /** @}*/
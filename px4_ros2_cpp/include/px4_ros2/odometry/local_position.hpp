@@ -8,6 +8,7 @@
 #include <Eigen/Eigen>
 #include <px4_msgs/msg/vehicle_local_position.hpp>
 #include <px4_ros2/common/context.hpp>
+#include <px4_ros2/components/time_sync.hpp>
 #include <px4_ros2/utils/subscription.hpp>
 
 namespace px4_ros2
@@ -22,8 +23,21 @@ namespace px4_ros2
 class OdometryLocalPosition : public Subscription<px4_msgs::msg::VehicleLocalPosition>
 {
 public:
+  /**
+   * Maximum time span over which the predicted* methods extrapolate. Beyond that the constant acceleration
+   * assumption does not hold.
+   */
+  static constexpr std::chrono::milliseconds kMaxPredictionHorizon{500};
+
   explicit OdometryLocalPosition(Context & context);
 
+  /**
+   * @brief Use a time synchronization to relate the sample time to the ROS time.
+   *
+   * Without it, the sample time is derived from the receive time, which ignores the transport delay.
+   */
+  void setTimeSync(const TimeSync & time_sync) {_time_sync = &time_sync;}
+
   bool positionXYValid() const
   {
     return lastValid() && last().xy_valid;
@@ -61,6 +75,43 @@ public:
     return {pos.ax, pos.ay, pos.az};
   }
 
+  /**
+   * @brief Get the ROS time at which the last estimate was sampled on the FMU.
+   */
+  rclcpp::Time sampleTime() const;
+
+  /**
+   * @brief Get the position extrapolated to a given time, assuming constant acceleration.
+   *
+   * @param time ROS time, e.g. the time at which a setpoint is expected to take effect
+   * @return the predicted position in NED frame
+   */
+  Eigen::Vector3f predictedPositionNed(const rclcpp::Time & time) const;
+
+  /**
+   * @brief Get the position extrapolated to the current time.
+   */
+  Eigen::Vector3f predictedPositionNed() const
+  {
+    return predictedPositionNed(_node.get_clock()->now());
+  }
+
+  /**
+   * @brief Get the velocity extrapolated to a given time, assuming constant acceleration.
+   *
+   * @param time ROS time
+   * @return the predicted velocity in NED frame
+   */
+  Eigen::Vector3f predictedVelocityNed(const rclcpp::Time & time) const;
+
+  /**
+   * @brief Get the velocity extrapolated to the current time.
+   */
+  Eigen::Vector3f predictedVelocityNed() const
+  {
+    return predictedVelocityNed(_node.get_clock()->now());
+  }
+
   /**
    * @brief Get the vehicle's heading relative to NED earth-fixed frame.
    *
@@ -77,6 +128,9 @@ public:
     const px4_msgs::msg::VehicleLocalPosition & pos = last();
     return pos.dist_bottom;
   }
+
+private:
+  const TimeSync * _time_sync{nullptr};
 };
 
 /** @}*/
@@ -0,0 +1,165 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <rclcpp/rclcpp.hpp>
+#include <rclcpp/serialization.hpp>
+
+namespace px4_ros2
+{
+/** \ingroup utils
+ *  @{
+ */
+
+/**
+ * @brief Serialized message that is updated by patching individual fields in place.
+ *
+ * The message is serialized once from a prototype. Fields that change are then copied directly into the
+ * serialized buffer at their offset, so publishing only costs a few stores instead of a serialization.
+ *
+ * Field offsets are determined at runtime by serializing the message with different field values and
+ * comparing the results, so no assumptions about the serialization format are made. A field can only be
+ * patched if it is serialized as a contiguous copy of its in-memory representation (e.g. fixed-size
+ * numeric fields and arrays, with the serialization in host byte order), otherwise field() throws.
+ */
+template<typename MessageT>
+class SerializedMessageTemplate
+{
+public:
+  /**
+   * @param prototype values for all fields that are not patched
+   */
+  explicit SerializedMessageTemplate(const MessageT & prototype = MessageT{})
+  : _prototype(prototype)
+  {
+    _serialization.serialize_message(&_prototype, &_message);
+  }
+
+  /**
+   * Add a field that is patched by patch()
+   * @param member e.g. &px4_msgs::msg::VehicleAttitudeSetpoint::q_d
+   * @throws std::runtime_error if the field cannot be patched in place
+   */
+  template<typename FieldT>
+  void addField(FieldT MessageT::* member)
+  {
+    static_assert(std::is_trivially_copyable_v<FieldT>, "Field must be trivially copyable");
+    MessageT message_a = _prototype;
+    MessageT message_b = _prototype;
+    setPattern(message_a.*member, message_b.*member);
+
+    rclcpp::SerializedMessage serialized_a;
+    rclcpp::SerializedMessage serialized_b;
+    _serialization.serialize_message(&message_a, &serialized_a);
+    _serialization.serialize_message(&message_b, &serialized_b);
+    const auto & raw_a = serialized_a.get_rcl_serialized_message();
+    const auto & raw_b = serialized_b.get_rcl_serialized_message();
+
+    if (raw_a.buffer_length != size() || raw_b.buffer_length != size()) {
+      throw std::runtime_error("Message size depends on the field value");
+    }
+
+    size_t first = size();
+    size_t last = 0;
+
+    for (size_t i = 0; i < size(); ++i) {
+      if (raw_a.buffer[i] != raw_b.buffer[i]) {
+        first = std::min(first, i);
+        last = i;
+      }
+    }
+
+    // Every byte of the field differs between both patterns, and the serialized bytes must match the
+    // in-memory representation (i.e. same byte order and no padding)
+    if (first == size() || last - first + 1 != sizeof(FieldT) ||
+      std::memcmp(raw_a.buffer + first, &(message_a.*member), sizeof(FieldT)) != 0)
+    {
+      throw std::runtime_error("Field cannot be patched in place");
+    }
+
+    const auto * message_start = reinterpret_cast<const uint8_t *>(&_prototype);
+    const auto * field_start = reinterpret_cast<const uint8_t *>(&(_prototype.*member));
+    _fields.push_back(
+      FieldLocation{static_cast<size_t>(field_start - message_start), first,
+        sizeof(FieldT)});
+  }
+
+  /**
+   * Copy the values of all added fields into the serialized message. All other fields keep the value of
+   * the prototype.
+   */
+  void patch(const MessageT & message)
+  {
+    const auto * source = reinterpret_cast<const uint8_t *>(&message);
+    uint8_t * buffer = _message.get_rcl_serialized_message().buffer;
+
+    for (const FieldLocation & field : _fields) {
+      std::memcpy(buffer + field.serialized_offset, source + field.memory_offset, field.size);
+    }
+  }
+
+  const rclcpp::SerializedMessage & message() const {return _message;}
+  size_t size() const {return _message.get_rcl_serialized_message().buffer_length;}
+
+private:
+  struct FieldLocation
+  {
+    size_t memory_offset;
+    size_t serialized_offset;
+    size_t size;
+  };
+
+  template<typename FieldT>
+  static constexpr bool isBoolArray()
+  {
+    if constexpr (std::is_arithmetic_v<FieldT>) {
+      return false;
+    } else {
+      return std::is_same_v<typename FieldT::value_type, bool>;
+    }
+  }
+
+  /**
+   * Set two values that differ in every byte
+   */
+  template<typename FieldT>
+  static void setPattern(FieldT & value_a, FieldT & value_b)
+  {
+    if constexpr (std::is_same_v<FieldT, bool>) {
+      value_a = false;
+      value_b = true;
+
+    } else {
+      static_assert(!isBoolArray<FieldT>(), "Arrays of bool are not supported");
+      uint8_t bytes_a[sizeof(FieldT)];
+      uint8_t bytes_b[sizeof(FieldT)];
+
+      for (size_t i = 0; i < sizeof(FieldT); ++i) {
+        bytes_a[i] = static_cast<uint8_t>(0x11 * (i % 8 + 1));
+        bytes_b[i] = static_cast<uint8_t>(~bytes_a[i]);
+      }
+
+      std::memcpy(&value_a, bytes_a, sizeof(FieldT));
+      std::memcpy(&value_b, bytes_b, sizeof(FieldT));
+    }
+  }
+
+  const MessageT _prototype;
+  rclcpp::Serialization<MessageT> _serialization;
+  rclcpp::SerializedMessage _message;
+  std::vector<FieldLocation> _fields;
+};
+
+/** @}*/
+} // namespace px4_ros2
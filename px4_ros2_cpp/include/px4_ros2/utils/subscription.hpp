@@ -7,6 +7,10 @@
 
 #include <px4_ros2/common/context.hpp>
 
+#include <functional>
+#include <iterator>
+#include <vector>
+
 using namespace std::chrono_literals; // NOLINT
 
 namespace px4_ros2
@@ -33,9 +37,20 @@ public:
       [this](const typename RosMessageType::UniquePtr msg) {
         _last = *msg;
         _last_message_time = _node.get_clock()->now();
+        _calling_callbacks = true;
         for (const auto & callback : _callbacks) {
           callback(_last);
         }
+        _calling_callbacks = false;
+
+        // Callbacks added from within a callback are only added now, as the vector cannot grow
+        // while iterating
+        if (!_added_callbacks.empty()) {
+          _callbacks.insert(
+            _callbacks.end(), std::make_move_iterator(_added_callbacks.begin()),
+            std::make_move_iterator(_added_callbacks.end()));
+          _added_callbacks.clear();
+        }
       });
   }
 
@@ -46,7 +61,12 @@ public:
    */
   void onUpdate(const UpdateCallback & callback)
   {
-    _callbacks.push_back(callback);
+    if (_calling_callbacks) {
+      _added_callbacks.push_back(callback);
+
+    } else {
+      _callbacks.push_back(callback);
+    }
   }
 
   /**
@@ -96,6 +116,8 @@ private:
   rclcpp::Time _last_message_time;
 
   std::vector<std::function<void(const RosMessageType &)>> _callbacks{};
+  std::vector<std::function<void(const RosMessageType &)>> _added_callbacks{};
+  bool _calling_callbacks{false};
 
   bool hasReceivedMessages() const
   {
@@ -0,0 +1,129 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <rclcpp/rclcpp.hpp>
+
+namespace px4_ros2
+{
+/** \ingroup utils
+ *  @{
+ */
+
+/**
+ * @brief Hierarchical timing wheel for a large number of timeouts.
+ *
+ * Scheduling and cancelling are O(1), and entries are recycled, so they do not allocate once the
+ * wheel has grown to its working size. Timeouts fire on the first tick after their deadline (i.e. with up
+ * to one tick resolution of delay). Deadlines further out than the wheel's range are clamped.
+ */
+class TimerWheel
+{
+public:
+  using Clock = std::chrono::steady_clock;
+  using Callback = std::function<void ()>;
+
+  static constexpr int kSlotBits = 6;
+  static constexpr int kNumSlots = 1 << kSlotBits;
+  static constexpr int kNumLevels = 4;
+
+  struct Handle
+  {
+    uint32_t index{std::numeric_limits<uint32_t>::max()};
+    uint32_t generation{0};
+  };
+
+  explicit TimerWheel(
+    Clock::duration resolution = std::chrono::milliseconds(10),
+    Clock::time_point start = Clock::now());
+
+  /**
+   * Schedule a callback. Deadlines in the past fire on the next tick.
+   * @return handle to cancel the timeout
+   */
+  Handle schedule(Clock::time_point deadline, Callback callback);
+
+  /**
+   * Cancel a timeout. Does nothing if it already fired or got cancelled before.
+   * @return true if the timeout was pending
+   */
+  bool cancel(Handle & handle);
+
+  /**
+   * Advance the wheel up to the given time, calling all expired callbacks.
+   * Callbacks may schedule and cancel timeouts.
+   */
+  void advance(Clock::time_point now);
+
+  size_t size() const {return _num_scheduled;}
+  bool empty() const {return _num_scheduled == 0;}
+  Clock::duration resolution() const {return _resolution;}
+
+private:
+  static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+  static constexpr uint64_t kMaxTicks = (uint64_t{1} << (kSlotBits * kNumLevels)) - 1;
+
+  struct Entry
+  {
+    Callback callback;
+    uint64_t expiry_tick{0};
+    uint32_t prev{kInvalidIndex};
+    uint32_t next{kInvalidIndex}; ///< Next entry in the slot, or in the free list
+    uint32_t generation{0};
+    uint16_t slot{0}; ///< level * kNumSlots + slot index
+    bool scheduled{false};
+  };
+
+  uint64_t toTick(Clock::time_point time) const;
+  void insert(uint32_t index);
+  void unlink(uint32_t index);
+  void release(uint32_t index);
+  void cascade(int level);
+  void expireSlot(uint16_t slot);
+
+  const Clock::duration _resolution;
+  const Clock::time_point _start;
+  uint64_t _current_tick{0};
+  std::vector<Entry> _entries;
+  std::array<uint32_t, kNumSlots * kNumLevels> _slots;
+  uint32_t _free_list{kInvalidIndex};
+  size_t _num_scheduled{0};
+};
+
+/**
+ * @brief TimerWheel shared by all users on the same node, driven by a single ROS timer.
+ * The ROS timer is only running while timeouts are pending.
+ */
+class NodeTimerWheel
+{
+public:
+  static std::shared_ptr<NodeTimerWheel> forNode(rclcpp::Node & node);
+
+  explicit NodeTimerWheel(rclcpp::Node & node);
+
+  TimerWheel::Handle schedule(std::chrono::nanoseconds timeout, TimerWheel::Callback callback);
+  bool cancel(TimerWheel::Handle & handle) {return _wheel.cancel(handle);}
+
+  size_t size() const {return _wheel.size();}
+
+private:
+  void tick();
+
+  TimerWheel _wheel;
+  rclcpp::TimerBase::SharedPtr _timer;
+  bool _timer_running{false};
+};
+
+/** @}*/
+} // namespace px4_ros2
@@ -0,0 +1,69 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <rclcpp/rclcpp.hpp>
+#include <px4_msgs/msg/message_format_request.hpp>
+#include <px4_msgs/msg/message_format_response.hpp>
+#include <px4_ros2/components/message_compatibility_check.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace px4_ros2
+{
+
+/**
+ * Non-blocking version of messageCompatibilityCheck(), for use from within callbacks.
+ * The topics are requested one after the other: each response triggers the next request, and a
+ * timer repeats unanswered requests.
+ */
+class AsyncMessageCompatibilityCheck
+{
+public:
+  using CompletedCallback = std::function<void (bool compatible)>;
+
+  AsyncMessageCompatibilityCheck(
+    rclcpp::Node & node,
+    const std::string & topic_namespace_prefix = "");
+  AsyncMessageCompatibilityCheck(const AsyncMessageCompatibilityCheck &) = delete;
+
+  /**
+   * @param on_completed called once with the result, unless cancelled before. Might be called from
+   * within this method.
+   */
+  void start(
+    const std::vector<MessageCompatibilityTopic> & messages_to_check,
+    const CompletedCallback & on_completed);
+  void cancel();
+
+  bool running() const {return static_cast<bool>(_on_completed);}
+
+private:
+  void requestMessageFormat();
+  void responseReceived(px4_msgs::msg::MessageFormatResponse & response);
+  void retryTimerUpdate();
+  void complete(bool compatible);
+
+  rclcpp::Node & _node;
+  rclcpp::Subscription<px4_msgs::msg::MessageFormatResponse>::SharedPtr
+    _message_format_response_sub;
+  rclcpp::Publisher<px4_msgs::msg::MessageFormatRequest>::SharedPtr _message_format_request_pub;
+  rclcpp::TimerBase::SharedPtr _retry_timer;
+
+  std::vector<MessageCompatibilityTopic> _messages_to_check;
+  std::string _msgs_dir;
+  size_t _current_index{0};
+  px4_msgs::msg::MessageFormatRequest _request{};
+  uint32_t _expected_message_hash{0};
+  int _num_retries{0};
+  bool _compatible{true};
+  std::string _mismatched_topics;
+  CompletedCallback _on_completed;
+};
+
+} // namespace px4_ros2
@@ -0,0 +1,205 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include "px4_ros2/components/executor_checkpoint.hpp"
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace px4_ros2
+{
+
+static constexpr uint32_t kCheckpointMagic = 0x50583443; // "PX4C"
+static constexpr uint32_t kCheckpointVersion = 1;
+static constexpr int kNumSlots = 2;
+
+static std::array<uint32_t, 256> crc32Table()
+{
+  std::array<uint32_t, 256> table{};
+
+  for (uint32_t i = 0; i < table.size(); ++i) {
+    uint32_t crc = i;
+
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 1u) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+    }
+
+    table[i] = crc;
+  }
+
+  return table;
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t * data, size_t size)
+{
+  static const std::array<uint32_t, 256> kTable = crc32Table();
+  crc = ~crc;
+
+  for (size_t i = 0; i < size; ++i) {
+    crc = kTable[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+  }
+
+  return ~crc;
+}
+
+ExecutorCheckpoint::ExecutorCheckpoint(const std::string & file_path, size_t capacity)
+: _capacity(capacity)
+{
+  // Keep slots 8-byte aligned
+  _slot_size = (sizeof(SlotHeader) + capacity + 7) & ~size_t{7};
+  _file_size = sizeof(FileHeader) + kNumSlots * _slot_size;
+
+  _fd = open(file_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+  if (_fd < 0) {
+    throw std::runtime_error(
+            "Failed to open checkpoint file '" + file_path + "': " + std::strerror(errno));
+  }
+
+  struct stat file_stat {};
+  bool initialize = fstat(_fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) != _file_size;
+
+  if (initialize && ftruncate(_fd, static_cast<off_t>(_file_size)) != 0) {
+    close(_fd);
+    throw std::runtime_error("Failed to resize checkpoint file '" + file_path + "'");
+  }
+
+  void * mapping = mmap(nullptr, _file_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+
+  if (mapping == MAP_FAILED) {
+    close(_fd);
+    throw std::runtime_error("Failed to map checkpoint file '" + file_path + "'");
+  }
+
+  _mapping = static_cast<uint8_t *>(mapping);
+  auto * header = reinterpret_cast<FileHeader *>(_mapping);
+  initialize = initialize || header->magic != kCheckpointMagic ||
+    header->version != kCheckpointVersion || header->capacity != capacity;
+
+  if (initialize) {
+    // Different layout (or new file): start from an empty checkpoint
+    std::memset(_mapping, 0, _file_size);
+    header->magic = kCheckpointMagic;
+    header->version = kCheckpointVersion;
+    header->capacity = capacity;
+  }
+}
+
+ExecutorCheckpoint::~ExecutorCheckpoint()
+{
+  if (_mapping) {
+    munmap(_mapping, _file_size);
+  }
+
+  if (_fd >= 0) {
+    close(_fd);
+  }
+}
+
+ExecutorCheckpoint::SlotHeader * ExecutorCheckpoint::slot(int index) const
+{
+  return reinterpret_cast<SlotHeader *>(_mapping + sizeof(FileHeader) + index * _slot_size);
+}
+
+uint8_t * ExecutorCheckpoint::slotData(int index) const
+{
+  return reinterpret_cast<uint8_t *>(slot(index)) + sizeof(SlotHeader);
+}
+
+uint32_t ExecutorCheckpoint::checksum(const SlotHeader & header, const uint8_t * data)
+{
+  SlotHeader header_without_checksum = header;
+  header_without_checksum.checksum = 0;
+  const uint32_t crc = crc32(
+    0, reinterpret_cast<const uint8_t *>(&header_without_checksum),
+    sizeof(header_without_checksum));
+  return crc32(crc, data, header.size);
+}
+
+bool ExecutorCheckpoint::slotValid(int index) const
+{
+  const SlotHeader & header = *slot(index);
+  return header.sequence != 0 && header.size <= _capacity &&
+         checksum(header, slotData(index)) == header.checksum;
+}
+
+bool ExecutorCheckpoint::commit(
+  const uint8_t * data, size_t size, ModeBase::ModeID scheduled_mode_id,
+  bool sync)
+{
+  if (size > _capacity) {
+    return false;
+  }
+
+  // Write into the slot not holding the latest valid checkpoint
+  uint64_t latest_sequence = 0;
+  int target_slot = 0;
+
+  for (int i = 0; i < kNumSlots; ++i) {
+    if (slotValid(i) && slot(i)->sequence >= latest_sequence) {
+      latest_sequence = slot(i)->sequence;
+      target_slot = (i + 1) % kNumSlots;
+    }
+  }
+
+  SlotHeader header{};
+  header.sequence = latest_sequence + 1;
+  header.size = static_cast<uint32_t>(size);
+  header.scheduled_mode_id = scheduled_mode_id;
+
+  if (size > 0) {
+    std::memcpy(slotData(target_slot), data, size);
+  }
+
+  header.checksum = checksum(header, slotData(target_slot));
+  // The header is written last, a torn write is detected by the checksum
+  std::atomic_thread_fence(std::memory_order_release);
+  *slot(target_slot) = header;
+
+  if (sync) {
+    return msync(_mapping, _file_size, MS_SYNC) == 0;
+  }
+
+  return true;
+}
+
+std::optional<ExecutorCheckpoint::State> ExecutorCheckpoint::load() const
+{
+  int latest_slot = -1;
+
+  for (int i = 0; i < kNumSlots; ++i) {
+    if (slotValid(i) && (latest_slot < 0 || slot(i)->sequence > slot(latest_slot)->sequence)) {
+      latest_slot = i;
+    }
+  }
+
+  if (latest_slot < 0) {
+    return std::nullopt;
+  }
+
+  const SlotHeader & header = *slot(latest_slot);
+  State state;
+  state.data.assign(slotData(latest_slot), slotData(latest_slot) + header.size);
+  state.scheduled_mode_id = static_cast<ModeBase::ModeID>(header.scheduled_mode_id);
+  state.sequence = header.sequence;
+  return state;
+}
+
+void ExecutorCheckpoint::clear()
+{
+  for (int i = 0; i < kNumSlots; ++i) {
+    slot(i)->sequence = 0;
+  }
+}
+
+} // namespace px4_ros2
@@ -4,8 +4,10 @@
  ****************************************************************************/
 
 #include "registration.hpp"
+#include "async_message_compatibility_check.hpp"
 #include "px4_ros2/components/health_and_arming_checks.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <utility>
 
@@ -18,7 +20,7 @@ HealthAndArmingChecks::HealthAndArmingChecks(
   rclcpp::Node & node, CheckCallback check_callback,
   const std::string & topic_namespace_prefix)
 : _node(node), _registration(std::make_shared<Registration>(node, topic_namespace_prefix)),
-  _check_callback(std::move(check_callback))
+  _check_callback(std::move(check_callback)), _topic_namespace_prefix(topic_namespace_prefix)
 {
   _arming_check_reply_pub = _node.create_publisher<px4_msgs::msg::ArmingCheckReply>(
     topic_namespace_prefix + "fmu/in/arming_check_reply", 1);
@@ -32,6 +34,8 @@ HealthAndArmingChecks::HealthAndArmingChecks(
         _node.get_logger(), "Arming check request (id=%i, only printed once)",
         msg->request_id);
 
+      fmuActivity();
+
       if (_registration->registered()) {
         px4_msgs::msg::ArmingCheckReply reply{};
         reply.registration_id = _registration->armingCheckId();
@@ -45,15 +49,34 @@ HealthAndArmingChecks::HealthAndArmingChecks(
 
         reply.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
         _arming_check_reply_pub->publish(reply);
-        _check_triggered = true;
 
       } else {
         RCLCPP_DEBUG(_node.get_logger(), "...not registered yet");
       }
     });
 
-  _watchdog_timer =
-    _node.create_wall_timer(4s, [this] {watchdogTimerUpdate();});
+  setFmuLossSettings(_fmu_loss_settings);
+}
+
+HealthAndArmingChecks::~HealthAndArmingChecks()
+{
+  // The registration is shared with the owner, and might outlive us
+  if (_reregistering) {
+    _registration->cancelRegistrationRequest();
+  }
+}
+
+void HealthAndArmingChecks::setFmuLossSettings(const FmuLossSettings & settings)
+{
+  _fmu_loss_settings = settings;
+  // Check at a fraction of the timeout, so the detection delay stays close to the timeout
+  const auto period = std::max<std::chrono::milliseconds>(settings.timeout / 4, 50ms);
+  _watchdog_timer = _node.create_wall_timer(period, [this] {watchdogTimerUpdate();});
+}
+
+void HealthAndArmingChecks::setFmuLossHandling(const FmuLossHandling & handling)
+{
+  _fmu_loss_handling = handling;
 }
 
 void HealthAndArmingChecks::overrideRegistration(const std::shared_ptr<Registration> & registration)
@@ -68,23 +91,123 @@ bool HealthAndArmingChecks::doRegister(const std::string & name)
   RegistrationSettings settings{};
   settings.name = name;
   settings.register_arming_check = true;
+  _name = name;
+
+  if (!_fmu_loss_handling.registration_settings) {
+    _fmu_loss_handling.registration_settings = [this]() {
+        RegistrationSettings reregister_settings{};
+        reregister_settings.name = _name;
+        reregister_settings.register_arming_check = true;
+        return reregister_settings;
+      };
+  }
+
   return _registration->doRegister(settings);
 }
 
-void HealthAndArmingChecks::watchdogTimerUpdate()
+void HealthAndArmingChecks::fmuActivity()
 {
-  if (_registration->registered()) {
-    if (!_check_triggered && _shutdown_on_timeout) {
-      rclcpp::shutdown();
-      throw std::runtime_error(
-              "Timeout, no request received from FMU, exiting (this can happen on FMU reboots)");
-    }
+  const auto now = std::chrono::steady_clock::now();
+  _last_fmu_activity = now;
+
+  // Retry at most once per timeout, as the FMU might not be ready to respond yet
+  if (_fmu_lost && !_reregistering &&
+    now - _last_reregister_attempt > _fmu_loss_settings.timeout)
+  {
+    _last_reregister_attempt = now;
+    RCLCPP_INFO(_node.get_logger(), "FMU is back, registering again");
+    startReregistration();
+  }
+}
 
-    _check_triggered = false;
+void HealthAndArmingChecks::startReregistration()
+{
+  // Registering blocks, so this is split into requests which complete from within callbacks
+  _reregistering = true;
+
+  if (!_fmu_loss_handling.check_message_compatibility) {
+    requestReregistration();
+    return;
+  }
+
+  if (!_message_compatibility_check) {
+    _message_compatibility_check = std::make_unique<AsyncMessageCompatibilityCheck>(
+      _node, _topic_namespace_prefix);
+  }
+
+  _message_compatibility_check->start(
+    {ALL_PX4_ROS2_MESSAGES}, [this](bool compatible) {
+      if (compatible) {
+        requestReregistration();
+
+      } else {
+        reregistrationCompleted(false);
+      }
+    });
+}
+
+void HealthAndArmingChecks::requestReregistration()
+{
+  _registration->requestRegistration(
+    _fmu_loss_handling.registration_settings(), [this](bool registered) {
+      if (!registered) {
+        reregistrationCompleted(false);
+        return;
+      }
+
+      if (_fmu_loss_handling.on_registered && !_fmu_loss_handling.on_registered()) {
+        // Do not stay half set up, the next attempt registers from scratch
+        _registration->doUnregister();
+        reregistrationCompleted(false);
+        return;
+      }
+
+      reregistrationCompleted(true);
+    });
+}
+
+void HealthAndArmingChecks::reregistrationCompleted(bool success)
+{
+  _reregistering = false;
+
+  if (success) {
+    RCLCPP_INFO(_node.get_logger(), "Registered again");
+    _fmu_lost = false;
+    _last_fmu_activity = std::chrono::steady_clock::now();
 
   } else {
+    RCLCPP_WARN(_node.get_logger(), "Registration failed, retrying");
+  }
+}
+
+void HealthAndArmingChecks::watchdogTimerUpdate()
+{
+  if (!_registration->registered() || _fmu_lost) {
     // avoid false positives while unregistered
-    _check_triggered = true;
+    if (!_fmu_lost) {
+      _last_fmu_activity = std::chrono::steady_clock::now();
+    }
+
+    return;
+  }
+
+  if (std::chrono::steady_clock::now() - _last_fmu_activity < _fmu_loss_settings.timeout) {
+    return;
+  }
+
+  if (!_fmu_loss_settings.reregister) {
+    rclcpp::shutdown();
+    throw std::runtime_error(
+            "Timeout, no request received from FMU, exiting (this can happen on FMU reboots)");
+  }
+
+  RCLCPP_WARN(_node.get_logger(), "Lost connection to FMU, waiting to register again");
+  _fmu_lost = true;
+  // The FMU forgot about us (or will, after a reboot), so we must not unregister explicitly
+  _registration->invalidate();
+
+  if (_fmu_loss_handling.on_fmu_lost) {
+    _fmu_loss_handling.on_fmu_lost();
   }
 }
 
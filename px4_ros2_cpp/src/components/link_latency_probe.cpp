@@ -0,0 +1,209 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include "px4_ros2/components/link_latency_probe.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace px4_ros2
+{
+
+using ProbeTopicName = decltype(px4_msgs::msg::MessageFormatRequest::topic_name);
+
+/**
+ * Write the probe topic name of a sequence number, which is not a valid topic (the response reports
+ * success = false), but the FMU echoes it in the response
+ */
+static void probeTopicName(uint32_t sequence, ProbeTopicName & topic_name)
+{
+  topic_name.fill(0);
+  snprintf(
+    reinterpret_cast<char *>(topic_name.data()), topic_name.size(), "px4_ros2/latency_probe/%u",
+    sequence);
+}
+
+LatencyWindow::LatencyWindow(size_t capacity)
+: _entries(capacity)
+{
+  if (capacity == 0) {
+    throw std::runtime_error("Latency window capacity must be positive");
+  }
+
+  _sorted.reserve(capacity);
+}
+
+void LatencyWindow::add(int64_t entry)
+{
+  if (_size == _entries.size()) {
+    // Full: drop the oldest entry
+    if (_entries[_next] != kLoss) {
+      --_num_samples;
+    }
+  } else {
+    ++_size;
+  }
+
+  _entries[_next] = entry;
+  _next = (_next + 1) % _entries.size();
+
+  if (entry != kLoss) {
+    ++_num_samples;
+  }
+}
+
+void LatencyWindow::addSample(std::chrono::microseconds latency)
+{
+  add(std::max<int64_t>(latency.count(), 0));
+}
+
+void LatencyWindow::addLoss()
+{
+  add(kLoss);
+}
+
+void LatencyWindow::clear()
+{
+  _next = 0;
+  _size = 0;
+  _num_samples = 0;
+}
+
+float LatencyWindow::lossRate() const
+{
+  if (_size == 0) {
+    return 0.f;
+  }
+
+  return static_cast<float>(_size - _num_samples) / static_cast<float>(_size);
+}
+
+std::chrono::microseconds LatencyWindow::percentile(float percentile) const
+{
+  if (_num_samples == 0) {
+    return std::chrono::microseconds{0};
+  }
+
+  _sorted.clear();
+
+  for (size_t i = 0; i < _size; ++i) {
+    if (_entries[i] != kLoss) {
+      _sorted.push_back(_entries[i]);
+    }
+  }
+
+  // Nearest-rank
+  const float clamped = std::min(std::max(percentile, 0.f), 100.f);
+  const auto rank = static_cast<size_t>(
+    std::ceil(clamped / 100.f * static_cast<float>(_sorted.size())));
+  const size_t index = rank > 0 ? std::min(rank - 1, _sorted.size() - 1) : 0;
+  std::nth_element(
+    _sorted.begin(), _sorted.begin() + static_cast<std::ptrdiff_t>(index), _sorted.end());
+  return std::chrono::microseconds{_sorted[index]};
+}
+
+std::chrono::microseconds LatencyWindow::min() const
+{
+  return percentile(0.f);
+}
+
+std::chrono::microseconds LatencyWindow::max() const
+{
+  return percentile(100.f);
+}
+
+LinkLatencyProbe::LinkLatencyProbe(Context & context)
+: LinkLatencyProbe(context, Settings{})
+{
+}
+
+LinkLatencyProbe::LinkLatencyProbe(Context & context, const Settings & settings)
+: _node(context.node()), _settings(settings), _window(settings.window_size)
+{
+  _message_format_request_pub = _node.create_publisher<px4_msgs::msg::MessageFormatRequest>(
+    context.topicNamespacePrefix() + "fmu/in/message_format_request", 1);
+
+  _message_format_response_sub =
+    _node.create_subscription<px4_msgs::msg::MessageFormatResponse>(
+    context.topicNamespacePrefix() + "fmu/out/message_format_response",
+    rclcpp::QoS(10).best_effort(),
+    [this](px4_msgs::msg::MessageFormatResponse::UniquePtr msg) {
+      messageFormatResponseUpdated(*msg);
+    });
+
+  _probe_timer = _node.create_wall_timer(_settings.interval, [this]() {sendProbe();});
+}
+
+void LinkLatencyProbe::sendProbe()
+{
+  if (_probe_pending) {
+    // Not acked within the interval
+    _probe_pending = false;
+    _window.addLoss();
+    notifyUpdate();
+  }
+
+  px4_msgs::msg::MessageFormatRequest request{};
+  request.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+  request.protocol_version = px4_msgs::msg::MessageFormatRequest::LATEST_PROTOCOL_VERSION;
+  probeTopicName(++_probe_sequence, request.topic_name);
+
+  _probe_pending = true;
+  _probe_send_time = std::chrono::steady_clock::now();
+  _message_format_request_pub->publish(request);
+}
+
+void LinkLatencyProbe::messageFormatResponseUpdated(
+  const px4_msgs::msg::MessageFormatResponse & response)
+{
+  if (!_probe_pending) {
+    return;
+  }
+
+  // Ignore responses to other requests (e.g. the compatibility check) and to earlier, lost probes
+  ProbeTopicName expected_topic_name;
+  probeTopicName(_probe_sequence, expected_topic_name);
+
+  if (strncmp(
+      reinterpret_cast<const char *>(response.topic_name.data()),
+      reinterpret_cast<const char *>(expected_topic_name.data()), expected_topic_name.size()) != 0)
+  {
+    return;
+  }
+
+  _probe_pending = false;
+  _last_response_receive_time = std::chrono::steady_clock::now();
+  _last_response_fmu_timestamp = response.timestamp;
+  _last_rtt = std::chrono::duration_cast<std::chrono::microseconds>(
+    _last_response_receive_time - _probe_send_time);
+  _window.addSample(_last_rtt);
+  notifyUpdate();
+}
+
+void LinkLatencyProbe::notifyUpdate()
+{
+  if (_on_update) {
+    _on_update(statistics());
+  }
+}
+
+LinkLatencyProbe::Statistics LinkLatencyProbe::statistics() const
+{
+  Statistics statistics;
+  statistics.num_samples = _window.numSamples();
+  statistics.loss_rate = _window.lossRate();
+  statistics.rtt_min = _window.min();
+  statistics.rtt_median = _window.percentile(50.f);
+  statistics.rtt_p90 = _window.percentile(90.f);
+  statistics.rtt_p99 = _window.percentile(99.f);
+  statistics.rtt_max = _window.max();
+  statistics.one_way_median = statistics.rtt_median / 2;
+  return statistics;
+}
+
+} // namespace px4_ros2
@@ -4,19 +4,28 @@
  ****************************************************************************/
 
 #include "px4_ros2/components/message_compatibility_check.hpp"
+#include "async_message_compatibility_check.hpp"
+#include "../utils/wait_for_graph_change.hpp"
 #include <px4_msgs/msg/message_format_request.hpp>
 #include <px4_msgs/msg/message_format_response.hpp>
 
+#include <cassert>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <ament_index_cpp/get_package_share_directory.hpp>
 #include <fstream>
 #include <regex>
-#include <unistd.h>
 
 namespace
 {
+constexpr auto kDiscoveryTimeout = 10s;
+constexpr int kMaxRetries = 5;
+constexpr auto kReplyTimeout = 300ms;
+// Responses to other requests (e.g. from the LinkLatencyProbe) must not push out the expected one
+constexpr size_t kResponseQueueDepth = 10;
+
 std::string messageFieldsStrForMessageHash(
   rclcpp::Node & node,
   const std::string & topic_type,
@@ -121,6 +130,56 @@ std::string snakeToCamelCase(std::string s) noexcept
   return s;
 }
 
+std::string topicType(const px4_ros2::MessageCompatibilityTopic & message_to_check)
+{
+  if (!message_to_check.topic_type.empty()) {
+    return message_to_check.topic_type;
+  }
+
+  // Infer topic type from topic_name
+  std::string topic_type;
+  auto last_slash = message_to_check.topic_name.find_last_of('/');
+  if (last_slash == std::string::npos) {
+    topic_type = message_to_check.topic_name;
+  } else {
+    topic_type = message_to_check.topic_name.substr(last_slash + 1);
+  }
+  return snakeToCamelCase(topic_type);
+}
+
+px4_msgs::msg::MessageFormatRequest messageFormatRequest(
+  rclcpp::Node & node,
+  const std::string & topic_name)
+{
+  px4_msgs::msg::MessageFormatRequest request;
+  request.protocol_version = px4_msgs::msg::MessageFormatRequest::LATEST_PROTOCOL_VERSION;
+  strncpy(
+    reinterpret_cast<char *>(request.topic_name.data()),
+    topic_name.c_str(), request.topic_name.size() - 1);
+  request.topic_name.back() = '\0';
+  request.timestamp = node.get_clock()->now().nanoseconds() / 1000;
+  return request;
+}
+
+bool isResponseForRequest(
+  px4_msgs::msg::MessageFormatResponse & response,
+  const px4_msgs::msg::MessageFormatRequest & request)
+{
+  response.topic_name.back() = 0;
+  return strcmp(
+    reinterpret_cast<const char *>(response.topic_name.data()),
+    reinterpret_cast<const char *>(request.topic_name.data())) == 0;
+}
+
+void reportMismatchedTopics(rclcpp::Node & node, const std::string & mismatched_topics)
+{
+  if (!mismatched_topics.empty()) {
+    RCLCPP_ERROR(
+      node.get_logger(), "Mismatch for the following topics, update PX4 or the px4_ros2 library and px4_msgs:%s",
+      mismatched_topics.c_str());
+  }
+}
+
 enum class RequestMessageFormatReturn
 {
   GotReply,
@@ -138,38 +197,32 @@ RequestMessageFormatReturn requestMessageFormat(
   wait_set.add_subscription(message_format_response_sub);
 
   // wait for subscription, it might take a while initially...
-  for (int i = 0; i < 100; ++i) {
-    if (message_format_request_pub->get_subscription_count() > 0) {
-      if (verbose) {
-        RCLCPP_DEBUG(node.get_logger(), "Subscriber found, continuing");
-      }
-      break;
-    }
-
-    usleep(100000);
+  if (px4_ros2::waitForGraphCondition(
+      node, [&message_format_request_pub]() {
+        return message_format_request_pub->get_subscription_count() > 0;
+      }, kDiscoveryTimeout) && verbose)
+  {
+    RCLCPP_DEBUG(node.get_logger(), "Subscriber found, continuing");
   }
 
   RequestMessageFormatReturn request_message_format_return{RequestMessageFormatReturn::Timeout};
   for (int retries = 0;
-    retries < 5 && request_message_format_return == RequestMessageFormatReturn::Timeout;
+    retries < kMaxRetries && request_message_format_return == RequestMessageFormatReturn::Timeout;
     ++retries)
   {
     message_format_request_pub->publish(request);
 
     // wait for publisher, it might take a while initially...
-    for (int i = 0; i < 100 && retries == 0; ++i) {
-      if (message_format_response_sub->get_publisher_count() > 0) {
-        if (verbose) {
-          RCLCPP_DEBUG(node.get_logger(), "Publisher found, continuing");
-        }
-        break;
-      }
-
-      usleep(100000);
+    if (retries == 0 && px4_ros2::waitForGraphCondition(
+        node, [&message_format_response_sub]() {
+          return message_format_response_sub->get_publisher_count() > 0;
+        }, kDiscoveryTimeout) && verbose)
+    {
+      RCLCPP_DEBUG(node.get_logger(), "Publisher found, continuing");
     }
 
     auto start_time = std::chrono::steady_clock::now();
-    auto timeout = 300ms;
+    auto timeout = kReplyTimeout;
 
     while (request_message_format_return == RequestMessageFormatReturn::Timeout) {
       auto now = std::chrono::steady_clock::now();
@@ -188,11 +241,7 @@ RequestMessageFormatReturn requestMessageFormat(
           if (response.protocol_version ==
             px4_msgs::msg::MessageFormatRequest::LATEST_PROTOCOL_VERSION)
           {
-            response.topic_name.back() = 0;
-            if (strcmp(
-                reinterpret_cast<const char *>(response.topic_name.data()),
-                reinterpret_cast<const char *>(request.topic_name.data())) == 0)
-            {
+            if (isResponseForRequest(response, request)) {
               request_message_format_return = RequestMessageFormatReturn::GotReply;
             }                                     // Else: response to a different topic, try again
           } else {
@@ -229,7 +278,8 @@ bool messageCompatibilityCheck(
     message_format_response_sub
     =
     node.create_subscription<px4_msgs::msg::MessageFormatResponse>(
-      topic_namespace_prefix + "fmu/out/message_format_response", rclcpp::QoS(1).best_effort(),
+      topic_namespace_prefix + "fmu/out/message_format_response",
+      rclcpp::QoS(kResponseQueueDepth).best_effort(),
       [](px4_msgs::msg::MessageFormatResponse::UniquePtr msg) {});
 
   const rclcpp::Publisher<px4_msgs::msg::MessageFormatRequest>::SharedPtr message_format_request_pub
@@ -248,28 +298,13 @@ bool messageCompatibilityCheck(
   bool first_message = true;
 
   for (const auto & message_to_check : messages_to_check) {
-    std::string topic_type = message_to_check.topic_type;
-    if (topic_type.empty()) {
-      // Infer topic type from topic_name
-      auto last_slash = message_to_check.topic_name.find_last_of('/');
-      if (last_slash == std::string::npos) {
-        topic_type = message_to_check.topic_name;
-      } else {
-        topic_type = message_to_check.topic_name.substr(last_slash + 1);
-      }
-      topic_type = snakeToCamelCase(topic_type);
-    }
     // Read the local message definition and get the hash
-    const uint32_t expected_message_hash = messageHash(node, topic_type, msgs_dir);
+    const uint32_t expected_message_hash =
+      messageHash(node, topicType(message_to_check), msgs_dir);
 
     // Ask for the message hash from PX4
-    px4_msgs::msg::MessageFormatRequest request;
-    request.protocol_version = px4_msgs::msg::MessageFormatRequest::LATEST_PROTOCOL_VERSION;
-    strncpy(
-      reinterpret_cast<char *>(request.topic_name.data()),
-      message_to_check.topic_name.c_str(), request.topic_name.size() - 1);
-    request.topic_name.back() = '\0';
-    request.timestamp = node.get_clock()->now().nanoseconds() / 1000;
+    const px4_msgs::msg::MessageFormatRequest request =
+      messageFormatRequest(node, message_to_check.topic_name);
     px4_msgs::msg::MessageFormatResponse response;
     switch (requestMessageFormat(
         node, request, message_format_response_sub, message_format_request_pub,
@@ -299,13 +334,136 @@ bool messageCompatibilityCheck(
     first_message = false;
   }
 
-  if (!mismatched_topics.empty()) {
+  reportMismatchedTopics(node, mismatched_topics);
+
+  return ret;
+}
+
+AsyncMessageCompatibilityCheck::AsyncMessageCompatibilityCheck(
+  rclcpp::Node & node,
+  const std::string & topic_namespace_prefix)
+: _node(node)
+{
+  _message_format_response_sub = node.create_subscription<px4_msgs::msg::MessageFormatResponse>(
+    topic_namespace_prefix + "fmu/out/message_format_response",
+    rclcpp::QoS(kResponseQueueDepth).best_effort(),
+    [this](px4_msgs::msg::MessageFormatResponse::UniquePtr msg) {
+      responseReceived(*msg);
+    });
+
+  _message_format_request_pub = node.create_publisher<px4_msgs::msg::MessageFormatRequest>(
+    topic_namespace_prefix + "fmu/in/message_format_request", 1);
+}
+
+void AsyncMessageCompatibilityCheck::start(
+  const std::vector<MessageCompatibilityTopic> & messages_to_check,
+  const CompletedCallback & on_completed)
+{
+  assert(!running());
+  RCLCPP_DEBUG(_node.get_logger(), "Checking message compatibility...");
+  _msgs_dir = ament_index_cpp::get_package_share_directory("px4_msgs");
+
+  if (_msgs_dir.empty()) {
+    RCLCPP_FATAL(_node.get_logger(), "Failed to get installation directory for 'px4_msgs' package");
+    on_completed(false);
+    return;
+  }
+
+  if (messages_to_check.empty()) {
+    on_completed(true);
+    return;
+  }
+
+  _messages_to_check = messages_to_check;
+  _current_index = 0;
+  _compatible = true;
+  _mismatched_topics.clear();
+  _on_completed = on_completed;
+  requestMessageFormat();
+}
+
+void AsyncMessageCompatibilityCheck::cancel()
+{
+  if (running()) {
+    _retry_timer->cancel();
+    _on_completed = nullptr;
+  }
+}
+
+void AsyncMessageCompatibilityCheck::requestMessageFormat()
+{
+  const MessageCompatibilityTopic & message_to_check = _messages_to_check[_current_index];
+  _expected_message_hash = messageHash(_node, topicType(message_to_check), _msgs_dir);
+  _request = messageFormatRequest(_node, message_to_check.topic_name);
+  _num_retries = 0;
+  _message_format_request_pub->publish(_request);
+
+  if (_retry_timer) {
+    _retry_timer->reset();
+
+  } else {
+    _retry_timer = _node.create_wall_timer(kReplyTimeout, [this]() {retryTimerUpdate();});
+  }
+}
+
+void AsyncMessageCompatibilityCheck::responseReceived(
+  px4_msgs::msg::MessageFormatResponse & response)
+{
+  if (!running()) {
+    return;
+  }
+
+  if (response.protocol_version != px4_msgs::msg::MessageFormatRequest::LATEST_PROTOCOL_VERSION) {
     RCLCPP_ERROR(
-      node.get_logger(), "Mismatch for the following topics, update PX4 or the px4_ros2 library and px4_msgs:%s",
-      mismatched_topics.c_str());
+      _node.get_logger(), "Protocol version mismatch: got %i, expected %i",
+      response.protocol_version, px4_msgs::msg::MessageFormatRequest::LATEST_PROTOCOL_VERSION);
+    complete(false);
+    return;
   }
 
-  return ret;
+  if (!isResponseForRequest(response, _request)) {
+    // Response to a different topic, keep waiting
+    return;
+  }
+
+  if (response.success) {
+    if (response.message_hash != _expected_message_hash) {
+      _mismatched_topics += "\n  - " + _messages_to_check[_current_index].topic_name;
+      _compatible = false;
+    }
+
+  } else {
+    RCLCPP_FATAL(_node.get_logger(), "MessageFormatResponse::success == false");
+    _compatible = false;
+  }
+
+  if (++_current_index < _messages_to_check.size()) {
+    requestMessageFormat();
+
+  } else {
+    reportMismatchedTopics(_node, _mismatched_topics);
+    complete(_compatible);
+  }
+}
+
+void AsyncMessageCompatibilityCheck::retryTimerUpdate()
+{
+  if (++_num_retries >= kMaxRetries) {
+    RCLCPP_FATAL(_node.get_logger(), "Timed out waiting for message format. Is the FMU running?");
+    complete(false);
+    return;
+  }
+
+  _request.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+  _message_format_request_pub->publish(_request);
+}
+
+void AsyncMessageCompatibilityCheck::complete(bool compatible)
+{
+  _retry_timer->cancel();
+  const CompletedCallback on_completed = std::move(_on_completed);
+  _on_completed = nullptr;
+  on_completed(compatible);
 }
 
 } // namespace px4_ros2
@@ -30,6 +30,8 @@ ModeBase::ModeBase(
   _vehicle_status_sub = node.create_subscription<px4_msgs::msg::VehicleStatus>(
     topic_namespace_prefix + "fmu/out/vehicle_status", rclcpp::QoS(1).best_effort(),
     [this](px4_msgs::msg::VehicleStatus::UniquePtr msg) {
+      _health_and_arming_checks.fmuActivity();
+
       if (_registration->registered()) {
         vehicleStatusUpdated(msg);
       }
@@ -65,6 +67,16 @@ bool ModeBase::doRegister()
   onAboutToRegister();
 
   _health_and_arming_checks.overrideRegistration(_registration);
+  HealthAndArmingChecks::FmuLossHandling fmu_loss_handling{};
+  fmu_loss_handling.on_fmu_lost = [this]() {
+      if (_is_active) {
+        callOnDeactivate();
+      }
+    };
+  fmu_loss_handling.registration_settings = [this]() {return getRegistrationSettings();};
+  fmu_loss_handling.on_registered = [this]() {return onRegistered();};
+  fmu_loss_handling.check_message_compatibility = !_skip_message_compatibility_check;
+  _health_and_arming_checks.setFmuLossHandling(fmu_loss_handling);
   const RegistrationSettings settings = getRegistrationSettings();
   bool ret = _registration->doRegister(settings);
 
@@ -8,26 +8,55 @@
 #include "px4_ros2/components/wait_for_fmu.hpp"
 
 #include "registration.hpp"
+#include "../utils/content_filter.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <future>
+#include <utility>
 using namespace std::chrono_literals;
 
 namespace px4_ros2
 {
 
+static constexpr size_t kVehicleCommandAckQueueDepth = 10; ///< Allow bursts of acks with pipelined commands
+static constexpr auto kDeferFailsafesConfirmationTimeout = 1s;
+static constexpr size_t kMaxFilteredModeIds = 32; ///< Filter parameters are limited to 100
+
+static px4_msgs::msg::VehicleCommand vehicleCommand(
+  uint32_t command, float param1, float param2,
+  float param3, float param4, float param5, float param6, float param7)
+{
+  px4_msgs::msg::VehicleCommand cmd{};
+  cmd.command = command;
+  cmd.param1 = param1;
+  cmd.param2 = param2;
+  cmd.param3 = param3;
+  cmd.param4 = param4;
+  cmd.param5 = param5;
+  cmd.param6 = param6;
+  cmd.param7 = param7;
+  return cmd;
+}
+
 ModeExecutorBase::ModeExecutorBase(
   rclcpp::Node & node, const ModeExecutorBase::Settings & settings,
   ModeBase & owned_mode, const std::string & topic_namespace_prefix)
 : _node(node), _topic_namespace_prefix(topic_namespace_prefix), _settings(settings), _owned_mode(
     owned_mode),
   _registration(std::make_shared<Registration>(node, topic_namespace_prefix)),
-  _current_scheduled_mode(node, topic_namespace_prefix),
+  _timer_wheel(NodeTimerWheel::forNode(node)),
+  _current_scheduled_mode(node, topic_namespace_prefix, *_timer_wheel,
+    [this](const px4_msgs::msg::VehicleCommand & cmd) {sendScheduledModeCommand(cmd);}),
+  _current_wait_vehicle_status(*_timer_wheel),
+  _condition_waiter(node),
   _config_overrides(node, topic_namespace_prefix)
 {
   _vehicle_status_sub = _node.create_subscription<px4_msgs::msg::VehicleStatus>(
     topic_namespace_prefix + "fmu/out/vehicle_status", rclcpp::QoS(1).best_effort(),
     [this](px4_msgs::msg::VehicleStatus::UniquePtr msg) {
+      _owned_mode._health_and_arming_checks.fmuActivity();
+
       if (_registration->registered()) {
         vehicleStatusUpdated(msg);
       }
@@ -36,9 +65,29 @@ ModeExecutorBase::ModeExecutorBase(
   _vehicle_command_pub = _node.create_publisher<px4_msgs::msg::VehicleCommand>(
     topic_namespace_prefix + "fmu/in/vehicle_command_mode_executor", 1);
 
+  // Until registered, the executor id is unknown: only let acks for any executor through.
+  // vehicleCommandAckUpdated() still matches the ids, as the filter might not be supported.
   _vehicle_command_ack_sub = _node.create_subscription<px4_msgs::msg::VehicleCommandAck>(
-    topic_namespace_prefix + "fmu/out/vehicle_command_ack", rclcpp::QoS(1).best_effort(),
-    [](px4_msgs::msg::VehicleCommandAck::UniquePtr msg) {});
+    topic_namespace_prefix + "fmu/out/vehicle_command_ack",
+    rclcpp::QoS(kVehicleCommandAckQueueDepth).best_effort(),
+    [this](px4_msgs::msg::VehicleCommandAck::UniquePtr msg) {
+      vehicleCommandAckUpdated(*msg);
+    },
+    contentFilterOptions(
+      "target_component >= %0",
+      {std::to_string(px4_msgs::msg::VehicleCommand::COMPONENT_MODE_EXECUTOR_START)}));
+}
+
+ModeExecutorBase::~ModeExecutorBase()
+{
+  // The timer wheel is shared, and might outlive us
+  for (auto & queue : _pending_commands) {
+    for (auto & pending_command : queue.second) {
+      _timer_wheel->cancel(pending_command.timeout);
+    }
+  }
+
+  _timer_wheel->cancel(_defer_failsafes_timeout);
 }
 
 bool ModeExecutorBase::doRegister()
@@ -51,20 +100,33 @@ bool ModeExecutorBase::doRegister()
 
   assert(!_registration->registered());
 
-  if (!waitForFMU(node(), 15s) ||
-    !messageCompatibilityCheck(node(), {ALL_PX4_ROS2_MESSAGES}, _topic_namespace_prefix))
+  if (!_skip_message_compatibility_check && (!waitForFMU(node(), 15s) ||
+    !messageCompatibilityCheck(node(), {ALL_PX4_ROS2_MESSAGES}, _topic_namespace_prefix)))
   {
     return false;
   }
 
   _owned_mode.onAboutToRegister();
   _owned_mode.overrideRegistration(_registration);
+
+  // The owned mode's checks detect the loss of the FMU, but the registration is ours
+  HealthAndArmingChecks::FmuLossHandling fmu_loss_handling{};
+  fmu_loss_handling.on_fmu_lost = [this]() {
+      if (_is_in_charge) {
+        callOnDeactivate(DeactivateReason::Other);
+      }
+
+      if (_owned_mode.isActive()) {
+        _owned_mode.callOnDeactivate();
+      }
+    };
+  fmu_loss_handling.registration_settings = [this]() {return registrationSettings();};
+  fmu_loss_handling.on_registered = [this]() {return onReregistered();};
+  fmu_loss_handling.check_message_compatibility = !_skip_message_compatibility_check;
+  _owned_mode._health_and_arming_checks.setFmuLossHandling(fmu_loss_handling);
+
   _owned_mode.unsubscribeVehicleStatus();
-  RegistrationSettings settings = _owned_mode.getRegistrationSettings();
-  settings.register_mode_executor = true;
-  settings.activate_mode_immediately =
-    (_settings.activation == Settings::Activation::ActivateImmediately);
-  bool ret = _registration->doRegister(settings);
+  bool ret = _registration->doRegister(registrationSettings());
 
   if (ret) {
     if (!_owned_mode.onRegistered()) {
@@ -76,20 +138,99 @@ bool ModeExecutorBase::doRegister()
   return ret;
 }
 
+void ModeExecutorBase::overrideRegistration(const std::shared_ptr<Registration> & registration)
+{
+  assert(!_registration->registered());
+  _registration = registration;
+}
+
+RegistrationSettings ModeExecutorBase::registrationSettings() const
+{
+  RegistrationSettings settings = _owned_mode.getRegistrationSettings();
+  settings.register_mode_executor = true;
+  settings.activate_mode_immediately =
+    (_settings.activation == Settings::Activation::ActivateImmediately);
+  return settings;
+}
+
+bool ModeExecutorBase::onReregistered()
+{
+  // Same as after doRegister(), but the mode is already set up.
+  // If checkpointing is enabled, onRegistered() loads the checkpoint, so the executor resumes from there.
+  _was_never_activated = true;
+
+  if (!_owned_mode.onRegistered()) {
+    return false;
+  }
+
+  onRegistered();
+  return true;
+}
+
 void ModeExecutorBase::onRegistered()
 {
+  // Commands are only sent from here on, so narrowing the filter cannot drop an ack we wait for
+  updateContentFilter(
+    *_vehicle_command_ack_sub, "target_component = %0",
+    {std::to_string(px4_msgs::msg::VehicleCommand::COMPONENT_MODE_EXECUTOR_START + id())});
+
   _config_overrides.setup(
     px4_msgs::msg::ConfigOverrides::SOURCE_TYPE_MODE_EXECUTOR,
     _registration->modeExecutorId());
+
+  if (_checkpoint) {
+    _resume_state = _checkpoint->load();
+
+    if (_resume_state) {
+      RCLCPP_INFO(
+        _node.get_logger(), "Mode executor '%s': found checkpoint (%zu bytes)",
+        _registration->name().c_str(), _resume_state->data.size());
+    }
+  }
 }
 
 void ModeExecutorBase::callOnActivate()
 {
   RCLCPP_DEBUG(_node.get_logger(), "Mode executor '%s' activated", _registration->name().c_str());
   _is_in_charge = true;
+
+  if (_resume_state) {
+    const ExecutorCheckpoint::State state = std::move(*_resume_state);
+    _resume_state.reset();
+
+    if (onResume(state.data, state.scheduled_mode_id)) {
+      return;
+    }
+  }
+
   onActivate();
 }
 
+void ModeExecutorBase::enableCheckpointing(const std::string & file_path, size_t capacity)
+{
+  _checkpoint = std::make_unique<ExecutorCheckpoint>(file_path, capacity);
+}
+
+bool ModeExecutorBase::checkpoint(const std::vector<uint8_t> & state, bool sync)
+{
+  if (!_checkpoint) {
+    return false;
+  }
+
+  const ModeBase::ModeID scheduled_mode_id = _current_scheduled_mode.active() ?
+    _current_scheduled_mode.modeId() : ModeBase::kModeIDInvalid;
+  return _checkpoint->commit(state.data(), state.size(), scheduled_mode_id, sync);
+}
+
+void ModeExecutorBase::clearCheckpoint()
+{
+  _resume_state.reset();
+
+  if (_checkpoint) {
+    _checkpoint->clear();
+  }
+}
+
 void ModeExecutorBase::callOnDeactivate(DeactivateReason reason)
 {
   RCLCPP_DEBUG(
@@ -97,6 +238,8 @@ void ModeExecutorBase::callOnDeactivate(DeactivateReason reason)
     _registration->name().c_str(), (int)reason);
   _current_scheduled_mode.cancel();
   _current_wait_vehicle_status.cancel();
+  _condition_waiter.cancelAll(Result::Deactivated);
+  completeDeferFailsafes(Result::Deactivated);
   _is_in_charge = false;
   _was_never_activated = false;       // Set on deactivation, so we stay activated for the first time (while disarmed)
   onDeactivate(reason);
@@ -111,50 +254,49 @@ Result ModeExecutorBase::sendCommandSync(
   uint32_t command, float param1, float param2, float param3, float param4,
   float param5, float param6, float param7)
 {
-  // Send command and wait for ack
-  Result result{Result::Rejected};
-  px4_msgs::msg::VehicleCommand cmd{};
-  cmd.command = command;
-  cmd.param1 = param1;
-  cmd.param2 = param2;
-  cmd.param3 = param3;
-  cmd.param4 = param4;
-  cmd.param5 = param5;
-  cmd.param6 = param6;
-  cmd.param7 = param7;
-  cmd.source_component = px4_msgs::msg::VehicleCommand::COMPONENT_MODE_EXECUTOR_START + id();
-  cmd.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
-
-
+  const px4_msgs::msg::VehicleCommand cmd =
+    vehicleCommand(command, param1, param2, param3, param4, param5, param6, param7);
+  Result result{Result::Timeout};
+  const uint32_t sequence = sendCommand(
+    cmd, [&result](Result command_result) {result = command_result;}, CommandSettings{});
+  const PendingCommandKey key{cmd.command,
+    static_cast<uint16_t>(px4_msgs::msg::VehicleCommand::COMPONENT_MODE_EXECUTOR_START + id())};
+
+  // The executor cannot dispatch acks (nor run the timer wheel) while we block, so take the acks
+  // directly and pass them through the regular ack handling (this also completes other pending
+  // commands instead of dropping their acks). The callbacks are deferred until the wait set is
+  // released, as they might send another command synchronously.
+  _defer_command_callbacks = true;
   rclcpp::WaitSet wait_set;
   wait_set.add_subscription(_vehicle_command_ack_sub);
 
-  bool got_reply = false;
-  auto start_time = std::chrono::steady_clock::now();
-  auto timeout = 300ms;
-  _vehicle_command_pub->publish(cmd);
+  while (true) {
+    const std::deque<PendingCommand> & queue = _pending_commands.find(key)->second;
+    const auto iter = std::find_if(
+      queue.begin(), queue.end(), [sequence](const PendingCommand & pending_command) {
+        return pending_command.sequence == sequence;
+      });
 
-  while (!got_reply) {
-    auto now = std::chrono::steady_clock::now();
+    if (iter == queue.end()) {
+      // Acked or timed out
+      break;
+    }
 
-    if (now >= start_time + timeout) {
+    const auto now = std::chrono::steady_clock::now();
+
+    if (now >= iter->deadline) {
+      commandTimedOut(key, sequence);
       break;
     }
 
-    auto wait_ret = wait_set.wait(timeout - (now - start_time));
+    auto wait_ret = wait_set.wait(iter->deadline - now);
 
     if (wait_ret.kind() == rclcpp::WaitResultKind::Ready) {
       px4_msgs::msg::VehicleCommandAck ack;
       rclcpp::MessageInfo info;
 
       if (_vehicle_command_ack_sub->take(ack, info)) {
-        if (ack.command == cmd.command && ack.target_component == cmd.source_component) {
-          if (ack.result == px4_msgs::msg::VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED) {
-            result = Result::Success;
-          }
-
-          got_reply = true;
-        }
+        vehicleCommandAckUpdated(ack);
 
       } else {
         RCLCPP_DEBUG(_node.get_logger(), "no VehicleCommandAck message received");
@@ -166,29 +308,199 @@ Result ModeExecutorBase::sendCommandSync(
   }
 
   wait_set.remove_subscription(_vehicle_command_ack_sub);
+  _defer_command_callbacks = false;
+
+  std::vector<std::function<void()>> deferred_callbacks;
+  deferred_callbacks.swap(_deferred_command_callbacks);
 
-  if (!got_reply) {
-    // We don't expect to run into an ack timeout
-    result = Result::Timeout;
-    RCLCPP_WARN(_node.get_logger(), "Cmd %i: timeout, no ack received", cmd.command);
+  for (const auto & callback : deferred_callbacks) {
+    callback();
   }
 
   return result;
 }
 
+void ModeExecutorBase::sendCommandAsync(
+  uint32_t command, const CompletedCallback & on_completed, float param1,
+  float param2, float param3, float param4, float param5, float param6, float param7)
+{
+  sendCommand(
+    vehicleCommand(command, param1, param2, param3, param4, param5, param6, param7),
+    on_completed, CommandSettings{});
+}
+
+void ModeExecutorBase::sendCommandAsync(
+  px4_msgs::msg::VehicleCommand cmd,
+  const CompletedCallback & on_completed, const CommandSettings & settings)
+{
+  sendCommand(std::move(cmd), on_completed, settings);
+}
+
+uint32_t ModeExecutorBase::sendCommand(
+  px4_msgs::msg::VehicleCommand cmd,
+  const CompletedCallback & on_completed, const CommandSettings & settings)
+{
+  cmd.source_component = px4_msgs::msg::VehicleCommand::COMPONENT_MODE_EXECUTOR_START + id();
+  cmd.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+
+  // Register before publishing, the ack might arrive any time after
+  const PendingCommandKey key{cmd.command, cmd.source_component};
+  const uint32_t sequence = _next_command_sequence++;
+  std::deque<PendingCommand> & queue = _pending_commands[key];
+  queue.push_back(PendingCommand{sequence, {}, settings, on_completed, {}});
+  scheduleCommandTimeout(key, queue.back());
+
+  _vehicle_command_pub->publish(cmd);
+  return sequence;
+}
+
+void ModeExecutorBase::scheduleCommandTimeout(
+  const PendingCommandKey & key,
+  PendingCommand & pending_command)
+{
+  _timer_wheel->cancel(pending_command.timeout);
+  pending_command.deadline = std::chrono::steady_clock::now() + pending_command.settings.ack_timeout;
+  const uint32_t sequence = pending_command.sequence;
+  pending_command.timeout = _timer_wheel->schedule(
+    pending_command.settings.ack_timeout, [this, key, sequence]() {
+      commandTimedOut(key, sequence);
+    });
+}
+
+void ModeExecutorBase::vehicleCommandAckUpdated(const px4_msgs::msg::VehicleCommandAck & ack)
+{
+  const auto queue_iter = _pending_commands.find(
+    PendingCommandKey{ack.command, ack.target_component});
+
+  if (queue_iter == _pending_commands.end() || queue_iter->second.empty()) {
+    // Not for us, or it already timed out
+    return;
+  }
+
+  std::deque<PendingCommand> & queue = queue_iter->second;
+
+  if (ack.result == px4_msgs::msg::VehicleCommandAck::VEHICLE_CMD_RESULT_IN_PROGRESS) {
+    // The command is still running: restart the timeout and report the progress
+    PendingCommand & pending_command = queue.front();
+    scheduleCommandTimeout(queue_iter->first, pending_command);
+
+    if (pending_command.settings.on_progress) {
+      const auto progress = ack.result_param1;
+
+      if (_defer_command_callbacks) {
+        _deferred_command_callbacks.emplace_back(
+          [on_progress = pending_command.settings.on_progress, progress]() {
+            on_progress(progress);
+          });
+
+      } else {
+        pending_command.settings.on_progress(progress);
+      }
+    }
+
+    return;
+  }
+
+  _timer_wheel->cancel(queue.front().timeout);
+  const CompletedCallback on_completed(std::move(queue.front().on_completed));
+  queue.pop_front();
+
+  const Result result =
+    ack.result == px4_msgs::msg::VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED ?
+    Result::Success : Result::Rejected;
+  commandCompleted(on_completed, result); // Call after, as it might trigger new requests
+}
+
+void ModeExecutorBase::commandTimedOut(const PendingCommandKey & key, uint32_t sequence)
+{
+  const auto queue_iter = _pending_commands.find(key);
+
+  if (queue_iter == _pending_commands.end()) {
+    return;
+  }
+
+  std::deque<PendingCommand> & queue = queue_iter->second;
+  const auto iter = std::find_if(
+    queue.begin(), queue.end(), [sequence](const PendingCommand & pending_command) {
+      return pending_command.sequence == sequence;
+    });
+
+  if (iter == queue.end()) {
+    // Already acked
+    return;
+  }
+
+  _timer_wheel->cancel(iter->timeout);
+  const CompletedCallback on_completed(std::move(iter->on_completed));
+  queue.erase(iter);
+
+  // We don't expect to run into an ack timeout
+  RCLCPP_WARN(_node.get_logger(), "Cmd %i: timeout, no ack received", key.command);
+  commandCompleted(on_completed, Result::Timeout); // Call after, as it might trigger new requests
+}
+
+void ModeExecutorBase::commandCompleted(const CompletedCallback & on_completed, Result result)
+{
+  if (_defer_command_callbacks) {
+    _deferred_command_callbacks.emplace_back([on_completed, result]() {on_completed(result);});
+
+  } else {
+    on_completed(result);
+  }
+}
+
 void ModeExecutorBase::scheduleMode(
   ModeBase::ModeID mode_id,
-  const CompletedCallback & on_completed)
+  const CompletedCallback & on_completed, std::chrono::milliseconds timeout)
+{
+  scheduleMode(mode_id, setNavStateCommand(mode_id), on_completed, timeout);
+}
+
+px4_msgs::msg::VehicleCommand ModeExecutorBase::setNavStateCommand(ModeBase::ModeID mode_id)
 {
   px4_msgs::msg::VehicleCommand cmd{};
   cmd.command = px4_msgs::msg::VehicleCommand::VEHICLE_CMD_SET_NAV_STATE;
   cmd.param1 = mode_id;
-  scheduleMode(mode_id, cmd, on_completed);
+  return cmd;
+}
+
+void ModeExecutorBase::scheduleModeSequence(
+  const std::vector<ModeBase::ModeID> & mode_ids,
+  const CompletedCallback & on_completed,
+  const std::function<void(ModeBase::ModeID)> & on_mode_completed)
+{
+  if (mode_ids.empty()) {
+    on_completed(Result::Success);
+    return;
+  }
+
+  scheduleMode(mode_ids[0], on_completed);
+
+  if (!_current_scheduled_mode.active()) {
+    // Rejected
+    return;
+  }
+
+  _current_scheduled_mode.setModeCompletedCallback(on_mode_completed);
+
+  for (size_t i = 1; i < mode_ids.size(); ++i) {
+    _current_scheduled_mode.queue(mode_ids[i], setNavStateCommand(mode_ids[i]));
+  }
+}
+
+bool ModeExecutorBase::queueMode(ModeBase::ModeID mode_id)
+{
+  if (!_current_scheduled_mode.active()) {
+    return false;
+  }
+
+  _current_scheduled_mode.queue(mode_id, setNavStateCommand(mode_id));
+  return true;
 }
 
 void ModeExecutorBase::scheduleMode(
   ModeBase::ModeID mode_id, const px4_msgs::msg::VehicleCommand & cmd,
-  const CompletedCallback & on_completed)
+  const CompletedCallback & on_completed, std::chrono::milliseconds timeout)
 {
   if (!_is_armed) {
     on_completed(Result::Rejected);
@@ -198,20 +510,27 @@ void ModeExecutorBase::scheduleMode(
   // If there's already an active mode, cancel it (it will call the callback with a failure result)
   _current_scheduled_mode.cancel();
 
-  const Result result = sendCommandSync(
-    cmd.command, cmd.param1, cmd.param2, cmd.param3, cmd.param4, cmd.param5, cmd.param6,
-    cmd.param7);
-
-  if (result != Result::Success) {
-    on_completed(result);
-    return;
-  }
-
   // Store the callback and ensure it's called eventually. There's a number of outcomes:
+  // - The command is rejected or times out.
   // - The mode finishes and publishes the completion result.
   // - Failsafe is entered or the user switches out. In that case the executor gets deactivated.
   // - The user switches into the owned mode. In that case the fmu does not deactivate the executor.
-  _current_scheduled_mode.activate(mode_id, on_completed);
+  // - The optional timeout expires.
+  // The mode is scheduled before the ack arrives, so a deactivation in between is handled as well.
+  _current_scheduled_mode.activate(mode_id, on_completed, timeout);
+  sendScheduledModeCommand(cmd);
+}
+
+void ModeExecutorBase::sendScheduledModeCommand(const px4_msgs::msg::VehicleCommand & cmd)
+{
+  const uint32_t activation_id = _current_scheduled_mode.activationId();
+
+  sendCommandAsync(
+    cmd, [this, activation_id](Result result) {
+      if (result != Result::Success && _current_scheduled_mode.activationId() == activation_id) {
+        _current_scheduled_mode.cancel(result);
+      }
+    }, CommandSettings{});
 }
 
 void ModeExecutorBase::takeoff(
@@ -240,28 +559,31 @@ void ModeExecutorBase::rtl(const CompletedCallback & on_completed)
   scheduleMode(ModeBase::kModeIDRtl, on_completed);
 }
 
-void ModeExecutorBase::arm(const CompletedCallback & on_completed)
+void ModeExecutorBase::arm(const CompletedCallback & on_completed, std::chrono::milliseconds timeout)
 {
   if (_is_armed) {
     on_completed(Result::Success);
     return;
   }
 
-  const Result result = sendCommandSync(
-    px4_msgs::msg::VehicleCommand::VEHICLE_CMD_COMPONENT_ARM_DISARM,
-    1.f);
-
-  if (result != Result::Success) {
-    on_completed(result);
-    return;
-  }
-
   // Wait until our internal state changes to armed
   _current_wait_vehicle_status.activate(
-    [this](const px4_msgs::msg::VehicleStatus::UniquePtr & msg) {return _is_armed;}, on_completed);
+    [this](const px4_msgs::msg::VehicleStatus::UniquePtr & msg) {return _is_armed;}, on_completed,
+    timeout);
+  const uint32_t activation_id = _current_wait_vehicle_status.activationId();
+
+  sendCommandAsync(
+    px4_msgs::msg::VehicleCommand::VEHICLE_CMD_COMPONENT_ARM_DISARM,
+    [this, activation_id](Result result) {
+      if (result != Result::Success && _current_wait_vehicle_status.activationId() == activation_id) {
+        _current_wait_vehicle_status.cancel(result);
+      }
+    }, 1.f);
 }
 
-void ModeExecutorBase::waitReadyToArm(const CompletedCallback & on_completed)
+void ModeExecutorBase::waitReadyToArm(
+  const CompletedCallback & on_completed,
+  std::chrono::milliseconds timeout)
 {
   if (_is_armed) {
     on_completed(Result::Success);
@@ -271,10 +593,12 @@ void ModeExecutorBase::waitReadyToArm(const CompletedCallback & on_completed)
   RCLCPP_DEBUG(_node.get_logger(), "Waiting until ready to arm...");
   _current_wait_vehicle_status.activate(
     [](const px4_msgs::msg::VehicleStatus::UniquePtr & msg) {return msg->pre_flight_checks_pass;},
-    on_completed);
+    on_completed, timeout);
 }
 
-void ModeExecutorBase::waitUntilDisarmed(const CompletedCallback & on_completed)
+void ModeExecutorBase::waitUntilDisarmed(
+  const CompletedCallback & on_completed,
+  std::chrono::milliseconds timeout)
 {
   if (!_is_armed) {
     on_completed(Result::Success);
@@ -284,7 +608,14 @@ void ModeExecutorBase::waitUntilDisarmed(const CompletedCallback & on_completed)
   RCLCPP_DEBUG(_node.get_logger(), "Waiting until disarmed...");
   _current_wait_vehicle_status.activate(
     [this](const px4_msgs::msg::VehicleStatus::UniquePtr & msg) {return !_is_armed;},
-    on_completed);
+    on_completed, timeout);
+}
+
+ConditionWaiter::WaitId ModeExecutorBase::waitUntil(
+  const WaitCondition & condition,
+  const CompletedCallback & on_completed, std::chrono::milliseconds timeout)
+{
+  return _condition_waiter.waitUntil(condition, on_completed, timeout);
 }
 
 void ModeExecutorBase::vehicleStatusUpdated(const px4_msgs::msg::VehicleStatus::UniquePtr & msg)
@@ -332,6 +663,12 @@ void ModeExecutorBase::vehicleStatusUpdated(const px4_msgs::msg::VehicleStatus::
 
   _prev_failsafe_defer_state = msg->failsafe_defer_state;
 
+  if (_defer_failsafes_on_completed &&
+    msg->failsafe_defer_state != px4_msgs::msg::VehicleStatus::FAILSAFE_DEFER_STATE_DISABLED)
+  {
+    completeDeferFailsafes(Result::Success);
+  }
+
   // Do not activate the mode if we're scheduling another mode. This is only expected to happen for a brief moment,
   // e.g. when the executor gets activated or right after arming. It thus prevents unnecessary mode activation toggling.
   const bool do_not_activate_mode =
@@ -398,39 +735,147 @@ bool ModeExecutorBase::deferFailsafesSync(bool enabled, int timeout_s)
   return true;
 }
 
+void ModeExecutorBase::deferFailsafes(
+  bool enabled, const CompletedCallback & on_completed,
+  int timeout_s)
+{
+  completeDeferFailsafes(Result::Interrupted);
+  _config_overrides.deferFailsafes(enabled, timeout_s);
+
+  // Same as deferFailsafesSync(), but the confirmation is taken from the regular vehicle status updates
+  if (enabled && _is_in_charge && _registration->registered() &&
+    _prev_failsafe_defer_state == px4_msgs::msg::VehicleStatus::FAILSAFE_DEFER_STATE_DISABLED)
+  {
+    _defer_failsafes_on_completed = on_completed;
+    _defer_failsafes_timeout = _timer_wheel->schedule(
+      kDeferFailsafesConfirmationTimeout, [this]() {
+        RCLCPP_DEBUG(_node.get_logger(), "Failsafe deferring not confirmed");
+        completeDeferFailsafes(Result::Timeout);
+      });
+    return;
+  }
+
+  on_completed(Result::Success);
+}
+
+void ModeExecutorBase::completeDeferFailsafes(Result result)
+{
+  _timer_wheel->cancel(_defer_failsafes_timeout);
+
+  if (_defer_failsafes_on_completed) {
+    const CompletedCallback on_completed(std::move(_defer_failsafes_on_completed));
+    _defer_failsafes_on_completed = nullptr;
+    on_completed(result);             // Call after, as it might trigger new requests
+  }
+}
+
 ModeExecutorBase::ScheduledMode::ScheduledMode(
   rclcpp::Node & node,
-  const std::string & topic_namespace_prefix)
+  const std::string & topic_namespace_prefix, NodeTimerWheel & timer_wheel,
+  const SendCommand & send_command)
+: _timer_wheel(timer_wheel), _send_command(send_command)
 {
   _mode_completed_sub = node.create_subscription<px4_msgs::msg::ModeCompleted>(
     topic_namespace_prefix + "fmu/out/mode_completed", rclcpp::QoS(1).best_effort(),
     [this, &node](px4_msgs::msg::ModeCompleted::UniquePtr msg) {
       if (active() && msg->nav_state == static_cast<uint8_t>(_mode_id)) {
+        const auto result = static_cast<Result>(msg->result);
+
+        if (result == Result::Success && !_queued_modes.empty()) {
+          // Continue with the next mode right away, the command is already prepared
+          const ModeBase::ModeID completed_mode_id = _mode_id;
+          _mode_id = _queued_modes.front().mode_id;
+          ++_activation_id;
+          _send_command(_queued_modes.front().cmd);
+          _queued_modes.pop_front();
+          RCLCPP_DEBUG(
+            node.get_logger(), "Mode %i completed, continuing with mode %i", completed_mode_id,
+            _mode_id);
+
+          if (_on_mode_completed_callback) {
+            _on_mode_completed_callback(completed_mode_id);
+          }
+
+          return;
+        }
+
         RCLCPP_DEBUG(
           node.get_logger(), "Got matching ModeCompleted message, result: %i",
           msg->result);
         const CompletedCallback on_completed_callback(std::move(_on_completed_callback));
         reset();
-        on_completed_callback(static_cast<Result>(msg->result));                 // Call after, as it might trigger new requests
+        on_completed_callback(result);                 // Call after, as it might trigger new requests
       }
-    });
+    },
+    contentFilterOptions(
+      "nav_state = %0", {std::to_string(static_cast<int>(ModeBase::kModeIDInvalid))}));
+}
+
+void ModeExecutorBase::ScheduledMode::addToFilter(ModeBase::ModeID mode_id)
+{
+  if (std::find(_filtered_mode_ids.begin(), _filtered_mode_ids.end(), mode_id) !=
+    _filtered_mode_ids.end() || _filtered_mode_ids.size() > kMaxFilteredModeIds)
+  {
+    return;
+  }
+
+  _filtered_mode_ids.push_back(mode_id);
+
+  if (_filtered_mode_ids.size() > kMaxFilteredModeIds) {
+    // Too many different modes, let everything through
+    updateContentFilter(*_mode_completed_sub, "nav_state >= %0", {"0"});
+    return;
+  }
+
+  std::string expression;
+  std::vector<std::string> parameters;
+
+  for (size_t i = 0; i < _filtered_mode_ids.size(); ++i) {
+    expression += (i == 0 ? "nav_state = %" : " OR nav_state = %") + std::to_string(i);
+    parameters.push_back(std::to_string(static_cast<int>(_filtered_mode_ids[i])));
+  }
+
+  updateContentFilter(*_mode_completed_sub, expression, parameters);
 }
 
 void ModeExecutorBase::ScheduledMode::activate(
   ModeBase::ModeID mode_id,
-  const CompletedCallback & on_completed)
+  const CompletedCallback & on_completed, std::chrono::milliseconds timeout)
 {
   assert(!active());
+  addToFilter(mode_id);
   _mode_id = mode_id;
   _on_completed_callback = on_completed;
+  ++_activation_id;
+
+  if (timeout.count() > 0) {
+    _timeout = _timer_wheel.schedule(timeout, [this]() {cancel(Result::Timeout);});
+  }
+}
+
+void ModeExecutorBase::ScheduledMode::queue(
+  ModeBase::ModeID mode_id,
+  const px4_msgs::msg::VehicleCommand & cmd)
+{
+  assert(active());
+  addToFilter(mode_id);
+  _queued_modes.push_back(QueuedMode{mode_id, cmd});
+}
+
+void ModeExecutorBase::ScheduledMode::reset()
+{
+  _mode_id = ModeBase::kModeIDInvalid;
+  _queued_modes.clear();
+  _on_mode_completed_callback = nullptr;
+  _timer_wheel.cancel(_timeout);
 }
 
-void ModeExecutorBase::ScheduledMode::cancel()
+void ModeExecutorBase::ScheduledMode::cancel(Result result)
 {
   if (active()) {
     const CompletedCallback on_completed_callback(std::move(_on_completed_callback));
     reset();
-    on_completed_callback(Result::Deactivated);             // Call after, as it might trigger new requests
+    on_completed_callback(result);             // Call after, as it might trigger new requests
   }
 }
 
@@ -439,29 +884,39 @@ void ModeExecutorBase::WaitForVehicleStatusCondition::update(
 {
   if (_on_completed_callback && _run_check_callback(msg)) {
     const CompletedCallback on_completed_callback(std::move(_on_completed_callback));
-    _on_completed_callback = nullptr;
-    _run_check_callback = nullptr;
+    reset();
     on_completed_callback(Result::Success);             // Call after, as it might trigger new requests
   }
 }
 
 void ModeExecutorBase::WaitForVehicleStatusCondition::activate(
   const RunCheckCallback & run_check_callback,
-  const CompletedCallback & on_completed)
+  const CompletedCallback & on_completed, std::chrono::milliseconds timeout)
 {
   assert(!_on_completed_callback);
   _on_completed_callback = on_completed;
   _run_check_callback = run_check_callback;
+  ++_activation_id;
+
+  if (timeout.count() > 0) {
+    _timeout = _timer_wheel.schedule(timeout, [this]() {cancel(Result::Timeout);});
+  }
 }
 
-void ModeExecutorBase::WaitForVehicleStatusCondition::cancel()
+void ModeExecutorBase::WaitForVehicleStatusCondition::cancel(Result result)
 {
   if (_on_completed_callback) {
     const CompletedCallback on_completed_callback(std::move(_on_completed_callback));
-    _on_completed_callback = nullptr;
-    _run_check_callback = nullptr;
-    on_completed_callback(Result::Deactivated);             // Call after, as it might trigger new requests
+    reset();
+    on_completed_callback(result);             // Call after, as it might trigger new requests
   }
 }
 
+void ModeExecutorBase::WaitForVehicleStatusCondition::reset()
+{
+  _on_completed_callback = nullptr;
+  _run_check_callback = nullptr;
+  _timer_wheel.cancel(_timeout);
+}
+
 } // namespace px4_ros2
@@ -0,0 +1,249 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include "px4_ros2/components/mode_executor_state_machine.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace px4_ros2
+{
+
+ModeExecutorStateMachine::ModeExecutorStateMachine(
+  ModeExecutorBase & executor, const std::vector<StateDefinition> & states,
+  const std::vector<TransitionDefinition> & transitions)
+: _node(executor.node()), _timer_wheel(NodeTimerWheel::forNode(_node))
+{
+  if (states.size() >= kStateStop) {
+    throw std::runtime_error("Too many states");
+  }
+
+  _states.reserve(states.size());
+
+  for (const auto & state : states) {
+    if (!_state_ids.emplace(state.name, static_cast<StateId>(_states.size())).second) {
+      throw std::runtime_error("Duplicate state '" + state.name + "'");
+    }
+
+    if (!state.action) {
+      throw std::runtime_error("State '" + state.name + "' has no action");
+    }
+
+    _states.push_back(State{state.name, state.action, state.timeout, state.cancel});
+  }
+
+  _table.resize(_states.size() * kNumResults);
+
+  for (const auto & transition_definition : transitions) {
+    Transition & transition =
+      _table[lookupState(transition_definition.from) * kNumResults +
+      resultIndex(transition_definition.result)];
+    transition.target = lookupState(transition_definition.to);
+
+    if (transition_definition.guard) {
+      if (_guards.size() >= kNoGuard) {
+        throw std::runtime_error("Too many guards");
+      }
+
+      transition.guard = static_cast<uint16_t>(_guards.size());
+      transition.target_if_guard_fails = lookupState(transition_definition.to_if_guard_fails);
+      _guards.push_back(transition_definition.guard);
+    }
+  }
+}
+
+int ModeExecutorStateMachine::resultIndex(Result result)
+{
+  switch (result) {
+    case Result::Success: return 0;
+
+    case Result::Rejected: return 1;
+
+    case Result::Interrupted: return 2;
+
+    case Result::Timeout: return 3;
+
+    case Result::Deactivated: return 4;
+
+    case Result::ModeFailureOther: return 5;
+  }
+
+  // Unknown mode-specific failure
+  return 5;
+}
+
+ModeExecutorStateMachine::StateId ModeExecutorStateMachine::lookupState(
+  const std::string & name) const
+{
+  if (name.empty()) {
+    return kStateStop;
+  }
+
+  return stateId(name);
+}
+
+ModeExecutorStateMachine::StateId ModeExecutorStateMachine::stateId(const std::string & name) const
+{
+  const auto iter = _state_ids.find(name);
+
+  if (iter == _state_ids.end()) {
+    throw std::runtime_error("Unknown state '" + name + "'");
+  }
+
+  return iter->second;
+}
+
+const std::string & ModeExecutorStateMachine::stateName(StateId state) const
+{
+  static const std::string kStopName{"stop"};
+  return state < _states.size() ? _states[state].name : kStopName;
+}
+
+const std::string & ModeExecutorStateMachine::currentStateName() const
+{
+  return stateName(_current_state);
+}
+
+ModeExecutorStateMachine::StateId ModeExecutorStateMachine::transitionTarget(
+  StateId from,
+  Result result) const
+{
+  const Transition & transition = _table[from * kNumResults + resultIndex(result)];
+
+  if (transition.guard != kNoGuard && !_guards[transition.guard]()) {
+    return transition.target_if_guard_fails;
+  }
+
+  return transition.target;
+}
+
+rclcpp::Duration ModeExecutorStateMachine::timeInCurrentState() const
+{
+  return _node.get_clock()->now() - _state_entry_time;
+}
+
+void ModeExecutorStateMachine::start(StateId initial_state, const FinishedCallback & on_finished)
+{
+  stop();
+  _on_finished = on_finished;
+  runState(initial_state);
+}
+
+void ModeExecutorStateMachine::start(
+  const std::string & initial_state,
+  const FinishedCallback & on_finished)
+{
+  start(stateId(initial_state), on_finished);
+}
+
+void ModeExecutorStateMachine::stop()
+{
+  _current_state = kStateStop;
+  ++_generation;
+  _timer_wheel->cancel(_state_timeout);
+}
+
+void ModeExecutorStateMachine::runState(StateId state)
+{
+  // Actions completing immediately are handled in this loop instead of recursing, so long chains of
+  // states do not grow the stack
+  while (state != kStateStop) {
+    _current_state = state;
+    const uint32_t generation = ++_generation;
+    _state_entry_time = _node.get_clock()->now();
+    RCLCPP_DEBUG(_node.get_logger(), "Entering state '%s'", _states[state].name.c_str());
+
+    if (_states[state].timeout.count() > 0) {
+      _state_timeout = _timer_wheel->schedule(
+        _states[state].timeout, [this, generation]() {stateTimedOut(generation);});
+    }
+
+    _in_action = true;
+    _completed_in_action = false;
+    _states[state].action(
+      [this, generation](Result result) {
+        actionCompleted(generation, result);
+      });
+    _in_action = false;
+
+    if (!_completed_in_action || generation != _generation) {
+      // Still running, or the action itself started or stopped the state machine
+      return;
+    }
+
+    state = transition(_result_in_action);
+  }
+}
+
+void ModeExecutorStateMachine::actionCompleted(uint32_t generation, Result result)
+{
+  if (generation != _generation || !running()) {
+    // Outdated, e.g. the state timed out before
+    return;
+  }
+
+  if (_in_action) {
+    _completed_in_action = true;
+    _result_in_action = result;
+    return;
+  }
+
+  runState(transition(result));
+}
+
+void ModeExecutorStateMachine::stateTimedOut(uint32_t generation)
+{
+  if (generation != _generation || !running() || _in_action || !_states[_current_state].cancel) {
+    actionCompleted(generation, Result::Timeout);
+    return;
+  }
+
+  // Cancel the still running action, so the next state can start a new one (e.g. schedule a mode).
+  // The cancelled action completes with an outdated generation, which is ignored.
+  const uint32_t cancel_generation = ++_generation;
+  _states[_current_state].cancel();
+
+  if (cancel_generation != _generation || !running()) {
+    // Restarted or stopped from within the cancellation
+    return;
+  }
+
+  runState(transition(Result::Timeout));
+}
+
+ModeExecutorStateMachine::StateId ModeExecutorStateMachine::transition(Result result)
+{
+  _timer_wheel->cancel(_state_timeout);
+  const StateId from = _current_state;
+  const StateId to = transitionTarget(from, result);
+  // Invalidate completions of the previous state, before calling out to the user
+  const uint32_t generation = ++_generation;
+
+  RCLCPP_DEBUG(
+    _node.get_logger(), "State '%s' completed (%s) -> '%s'", stateName(from).c_str(),
+    resultToString(result), stateName(to).c_str());
+
+  if (_on_transition) {
+    _on_transition(from, to, result);
+
+    if (generation != _generation) {
+      // Stopped or restarted from within the callback
+      return kStateStop;
+    }
+  }
+
+  if (to == kStateStop) {
+    _current_state = kStateStop;
+
+    if (_on_finished) {
+      const FinishedCallback on_finished(std::move(_on_finished));
+      on_finished(from, result);             // Call after, as it might restart the state machine
+    }
+  }
+
+  return to;
+}
+
+} // namespace px4_ros2
@@ -5,8 +5,6 @@
 
 #include "px4_ros2/components/overrides.hpp"
 
-#include <cassert>
-
 namespace px4_ros2
 {
 
@@ -43,12 +41,13 @@ void ConfigOverrides::update()
 
 void ConfigOverrides::setup(uint8_t type, uint8_t id)
 {
-  assert(!_is_setup);
+  // Setting up again happens after re-registration, in which case the FMU needs the current overrides
+  const bool was_setup = _is_setup;
   _current_overrides.source_type = type;
   _current_overrides.source_id = id;
   _is_setup = true;
 
-  if (_require_update_after_setup) {
+  if (_require_update_after_setup || was_setup) {
     update();
     _require_update_after_setup = false;
   }
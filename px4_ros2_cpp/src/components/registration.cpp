@@ -4,24 +4,35 @@
  ****************************************************************************/
 
 #include "registration.hpp"
+#include "../utils/content_filter.hpp"
+#include "../utils/wait_for_graph_change.hpp"
 
 #include <cassert>
 #include <random>
-#include <unistd.h>
+#include <utility>
 
 static constexpr uint16_t kLatestPX4ROS2ApiVersion = 1;
 
 using namespace std::chrono_literals;
 
+static constexpr auto kDiscoveryTimeout = 10s;
+static constexpr int kMaxRetries = 5;
+static constexpr auto kReplyTimeout = 1000ms; // CI simulation tests require this to be quite high
+
 Registration::Registration(rclcpp::Node & node, const std::string & topic_namespace_prefix)
 : _node(node)
 {
+  // The request id is chosen upfront, so the filter is in place by the time the reply arrives
+  _next_request_id = newRequestId();
+  // Replies are only taken from the callback by requestRegistration(), doRegister() uses a wait set
   _register_ext_component_reply_sub =
     node.create_subscription<px4_msgs::msg::RegisterExtComponentReply>(
     topic_namespace_prefix + "fmu/out/register_ext_component_reply",
     rclcpp::QoS(1).best_effort(),
-    [](px4_msgs::msg::RegisterExtComponentReply::UniquePtr msg) {
-    });
+    [this](px4_msgs::msg::RegisterExtComponentReply::UniquePtr msg) {
+      registrationReplyReceived(*msg);
+    },
+    px4_ros2::contentFilterOptions("request_id = %0", {std::to_string(_next_request_id)}));
 
   _register_ext_component_request_pub =
     node.create_publisher<px4_msgs::msg::RegisterExtComponentRequest>(
@@ -33,11 +44,10 @@ Registration::Registration(rclcpp::Node & node, const std::string & topic_namesp
   _unregister_ext_component.mode_id = px4_ros2::ModeBase::kModeIDInvalid;
 }
 
-bool Registration::doRegister(const RegistrationSettings & settings)
+bool Registration::fillRequest(
+  const RegistrationSettings & settings,
+  px4_msgs::msg::RegisterExtComponentRequest & request) const
 {
-  assert(!_registered);
-  px4_msgs::msg::RegisterExtComponentRequest request{};
-
   if (settings.name.length() >= request.name.size() ||
     settings.name.length() >= _unregister_ext_component.name.size())
   {
@@ -61,19 +71,74 @@ bool Registration::doRegister(const RegistrationSettings & settings)
   request.activate_mode_immediately = settings.activate_mode_immediately;
   request.px4_ros2_api_version = kLatestPX4ROS2ApiVersion;
 
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<uint64_t> distrib{};
-  request.request_id = distrib(gen);
+  request.request_id = _next_request_id;
+  return true;
+}
 
-  // wait for subscription, it might take a while initially...
-  for (int i = 0; i < 100; ++i) {
-    if (_register_ext_component_request_pub->get_subscription_count() > 0) {
-      RCLCPP_DEBUG(_node.get_logger(), "Subscriber found, continuing");
-      break;
+bool Registration::handleReply(
+  px4_msgs::msg::RegisterExtComponentReply & reply,
+  const px4_msgs::msg::RegisterExtComponentRequest & request)
+{
+  reply.name.back() = '\0';
+
+  if (strcmp(
+      reinterpret_cast<const char *>(reply.name.data()),
+      reinterpret_cast<const char *>(request.name.data())) != 0 ||
+    request.request_id != reply.request_id)
+  {
+    return false;
+  }
+
+  RCLCPP_DEBUG(_node.get_logger(), "Got RegisterExtComponentReply");
+
+  if (reply.success) {
+    if (reply.px4_ros2_api_version == kLatestPX4ROS2ApiVersion) {
+      _unregister_ext_component.arming_check_id = reply.arming_check_id;
+      _unregister_ext_component.mode_id = reply.mode_id;
+      _unregister_ext_component.mode_executor_id = reply.mode_executor_id;
+      strcpy(
+        reinterpret_cast<char *>(_unregister_ext_component.name.data()),
+        reinterpret_cast<const char *>(request.name.data()));
+      _registered = true;
+    } else {
+      RCLCPP_FATAL(
+        _node.get_logger(), "Incompatible ROS2 library API version: got %i, expected %i",
+        reply.px4_ros2_api_version, kLatestPX4ROS2ApiVersion);
     }
 
-    usleep(100000);
+  } else {
+    RCLCPP_ERROR(_node.get_logger(), "Registration failed");
+  }
+
+  return true;
+}
+
+void Registration::prepareNextRequest()
+{
+  // Prepare for the next registration (e.g. after the FMU got lost)
+  _next_request_id = newRequestId();
+  px4_ros2::updateContentFilter(
+    *_register_ext_component_reply_sub, "request_id = %0",
+    {std::to_string(_next_request_id)});
+}
+
+bool Registration::doRegister(const RegistrationSettings & settings)
+{
+  assert(!_registered);
+  assert(!registrationRequestPending());
+  px4_msgs::msg::RegisterExtComponentRequest request{};
+
+  if (!fillRequest(settings, request)) {
+    return false;
+  }
+
+  // wait for subscription, it might take a while initially...
+  if (px4_ros2::waitForGraphCondition(
+      _node, [this]() {
+        return _register_ext_component_request_pub->get_subscription_count() > 0;
+      }, kDiscoveryTimeout))
+  {
+    RCLCPP_DEBUG(_node.get_logger(), "Subscriber found, continuing");
   }
 
   // send request and wait for response
@@ -82,67 +147,36 @@ bool Registration::doRegister(const RegistrationSettings & settings)
 
   bool got_reply = false;
 
-  for (int retries = 0; retries < 5 && !got_reply; ++retries) {
+  for (int retries = 0; retries < kMaxRetries && !got_reply; ++retries) {
     request.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
     _register_ext_component_request_pub->publish(request);
 
     // wait for publisher, it might take a while initially...
-    for (int i = 0; i < 100 && retries == 0; ++i) {
-      if (_register_ext_component_reply_sub->get_publisher_count() > 0) {
-        RCLCPP_DEBUG(_node.get_logger(), "Publisher found, continuing");
-        break;
-      }
-
-      usleep(100000);
+    if (retries == 0 && px4_ros2::waitForGraphCondition(
+        _node, [this]() {
+          return _register_ext_component_reply_sub->get_publisher_count() > 0;
+        }, kDiscoveryTimeout))
+    {
+      RCLCPP_DEBUG(_node.get_logger(), "Publisher found, continuing");
     }
 
     const auto start_time = std::chrono::steady_clock::now();
-    const auto timeout = 1000ms; // CI simulation tests require this to be quite high
 
     while (!got_reply) {
       auto now = std::chrono::steady_clock::now();
 
-      if (now >= start_time + timeout) {
+      if (now >= start_time + kReplyTimeout) {
         break;
       }
 
-      auto wait_ret = wait_set.wait(timeout - (now - start_time));
+      auto wait_ret = wait_set.wait(kReplyTimeout - (now - start_time));
 
       if (wait_ret.kind() == rclcpp::WaitResultKind::Ready) {
         px4_msgs::msg::RegisterExtComponentReply reply;
         rclcpp::MessageInfo info;
 
         if (_register_ext_component_reply_sub->take(reply, info)) {
-          reply.name.back() = '\0';
-
-          if (strcmp(
-              reinterpret_cast<const char *>(reply.name.data()),
-              settings.name.c_str()) == 0 &&
-            request.request_id == reply.request_id)
-          {
-            RCLCPP_DEBUG(_node.get_logger(), "Got RegisterExtComponentReply");
-
-            if (reply.success) {
-              if (reply.px4_ros2_api_version == kLatestPX4ROS2ApiVersion) {
-                _unregister_ext_component.arming_check_id = reply.arming_check_id;
-                _unregister_ext_component.mode_id = reply.mode_id;
-                _unregister_ext_component.mode_executor_id = reply.mode_executor_id;
-                strcpy(
-                  reinterpret_cast<char *>(_unregister_ext_component.name.data()),
-                  settings.name.c_str());
-                _registered = true;
-              } else {
-                RCLCPP_FATAL(
-                  _node.get_logger(), "Incompatible ROS2 library API version: got %i, expected %i",
-                  reply.px4_ros2_api_version, kLatestPX4ROS2ApiVersion);
-              }
-
-            } else {
-              RCLCPP_ERROR(_node.get_logger(), "Registration failed");
-            }
-
-            got_reply = true;
-          }
+          got_reply = handleReply(reply, request);
 
         } else {
           RCLCPP_INFO(_node.get_logger(), "no RegisterExtComponentReply message received");
@@ -156,9 +190,84 @@ bool Registration::doRegister(const RegistrationSettings & settings)
 
   wait_set.remove_subscription(_register_ext_component_reply_sub);
 
+  prepareNextRequest();
+
   return _registered;
 }
 
+void Registration::requestRegistration(
+  const RegistrationSettings & settings,
+  const RegisterCallback & on_completed)
+{
+  assert(!_registered);
+  assert(!registrationRequestPending());
+  _pending_request = px4_msgs::msg::RegisterExtComponentRequest{};
+
+  if (!fillRequest(settings, _pending_request)) {
+    on_completed(false);
+    return;
+  }
+
+  _on_registration_completed = on_completed;
+  _registration_retries = 0;
+  _pending_request.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+  _register_ext_component_request_pub->publish(_pending_request);
+
+  if (_registration_retry_timer) {
+    _registration_retry_timer->reset();
+
+  } else {
+    _registration_retry_timer = _node.create_wall_timer(
+      kReplyTimeout, [this]() {registrationRetryTimerUpdate();});
+  }
+}
+
+void Registration::cancelRegistrationRequest()
+{
+  if (registrationRequestPending()) {
+    _registration_retry_timer->cancel();
+    _on_registration_completed = nullptr;
+    prepareNextRequest();
+  }
+}
+
+void Registration::registrationReplyReceived(px4_msgs::msg::RegisterExtComponentReply & reply)
+{
+  if (registrationRequestPending() && handleReply(reply, _pending_request)) {
+    completeRegistrationRequest();
+  }
+}
+
+void Registration::registrationRetryTimerUpdate()
+{
+  if (++_registration_retries >= kMaxRetries) {
+    RCLCPP_INFO(_node.get_logger(), "timeout while registering external component");
+    completeRegistrationRequest();
+    return;
+  }
+
+  _pending_request.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+  _register_ext_component_request_pub->publish(_pending_request);
+}
+
+void Registration::completeRegistrationRequest()
+{
+  _registration_retry_timer->cancel();
+  prepareNextRequest();
+  const RegisterCallback on_completed = std::move(_on_registration_completed);
+  _on_registration_completed = nullptr;
+  // Call after, as it might trigger new requests
+  on_completed(_registered);
+}
+
+uint64_t Registration::newRequestId()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<uint64_t> distrib{};
+  return distrib(gen);
+}
+
 void Registration::doUnregister()
 {
   if (_registered) {
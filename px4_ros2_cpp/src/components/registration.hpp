@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <string>
 
 #include <rclcpp/rclcpp.hpp>
@@ -30,6 +31,8 @@ struct RegistrationSettings
 class Registration
 {
 public:
+  using RegisterCallback = std::function<void (bool registered)>;
+
   explicit Registration(rclcpp::Node & node, const std::string & topic_namespace_prefix = "");
   virtual ~Registration()
   {
@@ -39,8 +42,24 @@ public:
   virtual bool doRegister(const RegistrationSettings & settings);
   virtual void doUnregister();
 
+  /**
+   * Non-blocking version of doRegister(): the reply is handled by the subscription callback, and
+   * the request is repeated by a timer until the retries are exhausted.
+   * @param on_completed called once with the result, unless cancelled before
+   */
+  virtual void requestRegistration(
+    const RegistrationSettings & settings,
+    const RegisterCallback & on_completed);
+  void cancelRegistrationRequest();
+  bool registrationRequestPending() const {return static_cast<bool>(_on_registration_completed);}
+
   bool registered() const {return _registered;}
 
+  /**
+   * Mark as unregistered without notifying the FMU, e.g. after the FMU got lost
+   */
+  void invalidate() {_registered = false;}
+
   int armingCheckId() const {return _unregister_ext_component.arming_check_id;}
   px4_ros2::ModeBase::ModeID modeId() const {return _unregister_ext_component.mode_id;}
   int modeExecutorId() const {return _unregister_ext_component.mode_executor_id;}
@@ -56,6 +75,23 @@ protected:
     int mode_executor_id);
 
 private:
+  static uint64_t newRequestId();
+
+  bool fillRequest(
+    const RegistrationSettings & settings,
+    px4_msgs::msg::RegisterExtComponentRequest & request) const;
+  /**
+   * @return true if the reply belongs to the request
+   */
+  bool handleReply(
+    px4_msgs::msg::RegisterExtComponentReply & reply,
+    const px4_msgs::msg::RegisterExtComponentRequest & request);
+  void prepareNextRequest();
+
+  void registrationReplyReceived(px4_msgs::msg::RegisterExtComponentReply & reply);
+  void registrationRetryTimerUpdate();
+  void completeRegistrationRequest();
+
   rclcpp::Subscription<px4_msgs::msg::RegisterExtComponentReply>::SharedPtr
     _register_ext_component_reply_sub;
   rclcpp::Publisher<px4_msgs::msg::RegisterExtComponentRequest>::SharedPtr
@@ -63,6 +99,13 @@ private:
   rclcpp::Publisher<px4_msgs::msg::UnregisterExtComponent>::SharedPtr _unregister_ext_component_pub;
 
   bool _registered{false};
+  uint64_t _next_request_id{0};
   px4_msgs::msg::UnregisterExtComponent _unregister_ext_component{};
   rclcpp::Node & _node;
+
+  // State of requestRegistration()
+  px4_msgs::msg::RegisterExtComponentRequest _pending_request{};
+  RegisterCallback _on_registration_completed;
+  int _registration_retries{0};
+  rclcpp::TimerBase::SharedPtr _registration_retry_timer;
 };
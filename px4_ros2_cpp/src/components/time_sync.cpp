@@ -0,0 +1,173 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include "px4_ros2/components/time_sync.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace px4_ros2
+{
+
+static double median(std::vector<double> & values)
+{
+  const auto middle = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+  std::nth_element(values.begin(), middle, values.end());
+  return *middle;
+}
+
+ClockOffsetEstimator::ClockOffsetEstimator(
+  std::chrono::microseconds bucket_duration,
+  size_t num_buckets)
+: _bucket_duration(bucket_duration.count()), _buckets(num_buckets)
+{
+  if (_bucket_duration <= 0 || num_buckets < 2) {
+    throw std::runtime_error("Invalid clock offset estimator window");
+  }
+
+  _scratch.reserve(num_buckets * (num_buckets - 1) / 2);
+}
+
+void ClockOffsetEstimator::reset()
+{
+  _next = 0;
+  _num_buckets = 0;
+  _has_current_bucket = false;
+  _valid = false;
+  _offset = 0.;
+  _drift = 0.;
+}
+
+void ClockOffsetEstimator::addSample(uint64_t remote_us, int64_t local_us)
+{
+  const Point point{static_cast<int64_t>(remote_us), local_us - static_cast<int64_t>(remote_us)};
+  const int64_t bucket_index = point.remote / _bucket_duration;
+
+  if (_has_current_bucket && bucket_index < _current_bucket_index - 1) {
+    // Remote time jumped back (more than message reordering would explain): the remote rebooted
+    reset();
+  }
+
+  if (_has_current_bucket && bucket_index > _current_bucket_index) {
+    completeBucket();
+  }
+
+  if (!_has_current_bucket) {
+    _has_current_bucket = true;
+    _current_bucket_index = bucket_index;
+    _current_bucket_min = point;
+
+  } else if (point.difference < _current_bucket_min.difference) {
+    _current_bucket_min = point;
+  }
+
+  if (_num_buckets == 0) {
+    // No completed bucket yet: provide an offset-only estimate from the current one
+    _valid = true;
+    _reference_remote = _current_bucket_min.remote;
+    _offset = static_cast<double>(_current_bucket_min.difference);
+    _drift = 0.;
+  }
+}
+
+void ClockOffsetEstimator::completeBucket()
+{
+  _buckets[_next] = _current_bucket_min;
+  _next = (_next + 1) % _buckets.size();
+  _num_buckets = std::min(_num_buckets + 1, _buckets.size());
+  _has_current_bucket = false;
+  fit();
+}
+
+void ClockOffsetEstimator::fit()
+{
+  const size_t newest = (_next + _buckets.size() - 1) % _buckets.size();
+  _reference_remote = _buckets[newest].remote;
+
+  // Slope: median of the pairwise slopes
+  _scratch.clear();
+
+  for (size_t i = 0; i < _num_buckets; ++i) {
+    for (size_t j = i + 1; j < _num_buckets; ++j) {
+      const Point & a = _buckets[i];
+      const Point & b = _buckets[j];
+
+      if (a.remote != b.remote) {
+        _scratch.push_back(
+          static_cast<double>(b.difference - a.difference) /
+          static_cast<double>(b.remote - a.remote));
+      }
+    }
+  }
+
+  _drift = _scratch.empty() ? 0. : std::min(std::max(median(_scratch), -kMaxDrift), kMaxDrift);
+
+  // Intercept: median of the residuals at the reference
+  _scratch.clear();
+
+  for (size_t i = 0; i < _num_buckets; ++i) {
+    const Point & point = _buckets[i];
+    _scratch.push_back(
+      static_cast<double>(point.difference) -
+      _drift * static_cast<double>(point.remote - _reference_remote));
+  }
+
+  _offset = median(_scratch);
+  _valid = true;
+}
+
+int64_t ClockOffsetEstimator::remoteToLocal(uint64_t remote_us) const
+{
+  const auto remote = static_cast<int64_t>(remote_us);
+  return remote +
+         std::llround(_offset + _drift * static_cast<double>(remote - _reference_remote));
+}
+
+uint64_t ClockOffsetEstimator::localToRemote(int64_t local_us) const
+{
+  const int64_t remote = _reference_remote +
+    std::llround((static_cast<double>(local_us - _reference_remote) - _offset) / (1. + _drift));
+  return remote > 0 ? static_cast<uint64_t>(remote) : 0;
+}
+
+TimeSync::TimeSync(Context & context)
+: _node(context.node())
+{
+}
+
+TimeSync::TimeSync(
+  Context & context, std::chrono::microseconds bucket_duration,
+  size_t num_buckets)
+: _node(context.node()), _estimator(bucket_duration, num_buckets)
+{
+}
+
+void TimeSync::addSample(uint64_t fmu_timestamp_us, const rclcpp::Time & receive_time)
+{
+  if (fmu_timestamp_us == 0) {
+    return;
+  }
+
+  _estimator.addSample(fmu_timestamp_us, receive_time.nanoseconds() / 1000);
+}
+
+rclcpp::Time TimeSync::fmuToRos(uint64_t fmu_timestamp_us) const
+{
+  const int64_t local_us = _estimator.remoteToLocal(fmu_timestamp_us) - _transport_delay_us;
+  return rclcpp::Time(local_us * 1000, _node.get_clock()->get_clock_type());
+}
+
+uint64_t TimeSync::rosToFmu(const rclcpp::Time & time) const
+{
+  return _estimator.localToRemote(time.nanoseconds() / 1000 + _transport_delay_us);
+}
+
+uint64_t TimeSync::fmuNow() const
+{
+  return rosToFmu(_node.get_clock()->now());
+}
+
+} // namespace px4_ros2
@@ -0,0 +1,201 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include "px4_ros2/components/wait_condition.hpp"
+
+#include <limits>
+#include <stdexcept>
+
+namespace px4_ros2
+{
+
+ConditionWaiter::ConditionWaiter(rclcpp::Node & node)
+: _timer_wheel(NodeTimerWheel::forNode(node)),
+  _self(std::make_shared<ConditionWaiter *>(this))
+{
+}
+
+ConditionWaiter::~ConditionWaiter()
+{
+  for (auto & wait : _waits) {
+    _timer_wheel->cancel(wait.second.timeout);
+  }
+}
+
+void ConditionWaiter::compile(const std::shared_ptr<const ConditionNode> & node, Wait & wait)
+{
+  if (node->type == WaitCondition::Type::Leaf) {
+    if (wait.leaves.size() >= std::numeric_limits<uint16_t>::max()) {
+      throw std::runtime_error("Too many conditions");
+    }
+
+    wait.program.push_back({node->type, static_cast<uint16_t>(wait.leaves.size())});
+    wait.leaves.push_back(node);
+    return;
+  }
+
+  compile(node->lhs, wait);
+  compile(node->rhs, wait);
+  wait.program.push_back({node->type, 0});
+}
+
+bool ConditionWaiter::evaluate(const Wait & wait)
+{
+  // Conditions are shallow, so a fixed-size stack is plenty
+  static constexpr int kMaxDepth = 64;
+  bool stack[kMaxDepth];
+  int size = 0;
+
+  for (const Instruction & instruction : wait.program) {
+    switch (instruction.type) {
+      case WaitCondition::Type::Leaf:
+        if (size >= kMaxDepth) {
+          throw std::runtime_error("Condition too deep");
+        }
+
+        stack[size++] = wait.leaf_values[instruction.leaf];
+        break;
+
+      case WaitCondition::Type::And:
+        --size;
+        stack[size - 1] = stack[size - 1] && stack[size];
+        break;
+
+      case WaitCondition::Type::Or:
+        --size;
+        stack[size - 1] = stack[size - 1] || stack[size];
+        break;
+    }
+  }
+
+  return size == 1 && stack[0];
+}
+
+ConditionWaiter::WaitId ConditionWaiter::waitUntil(
+  const WaitCondition & condition,
+  const CompletedCallback & on_completed, std::chrono::milliseconds timeout)
+{
+  const WaitId id = _next_wait_id++;
+  Wait wait;
+  compile(condition._node, wait);
+  wait.leaf_values.resize(wait.leaves.size());
+
+  for (size_t i = 0; i < wait.leaves.size(); ++i) {
+    wait.leaf_values[i] = wait.leaves[i]->evaluate();
+  }
+
+  if (evaluate(wait)) {
+    on_completed(Result::Success);
+    return id;
+  }
+
+  for (size_t i = 0; i < wait.leaves.size(); ++i) {
+    const ConditionNode & leaf = *wait.leaves[i];
+    auto source_iter = _sources.find(leaf.source);
+
+    if (source_iter == _sources.end()) {
+      // First time we see this subscription: register a single callback, shared by all waits
+      source_iter = _sources.emplace(leaf.source, Source{}).first;
+      const std::weak_ptr<ConditionWaiter *> weak_self = _self;
+      const void * source = leaf.source;
+      leaf.subscribe(
+        [weak_self, source]() {
+          if (const auto self = weak_self.lock()) {
+            (*self)->sourceUpdated(source);
+          }
+        });
+    }
+
+    source_iter->second.listeners.push_back({id, static_cast<uint16_t>(i)});
+  }
+
+  wait.on_completed = on_completed;
+
+  if (timeout.count() > 0) {
+    wait.timeout = _timer_wheel->schedule(timeout, [this, id]() {complete(id, Result::Timeout);});
+  }
+
+  _waits.emplace(id, std::move(wait));
+  return id;
+}
+
+void ConditionWaiter::sourceUpdated(const void * source)
+{
+  auto & listeners = _sources[source].listeners;
+  std::vector<WaitId> updated_waits;
+  size_t num_kept = 0;
+
+  for (size_t i = 0; i < listeners.size(); ++i) {
+    const auto wait_iter = _waits.find(listeners[i].wait_id);
+
+    if (wait_iter == _waits.end()) {
+      continue;
+    }
+
+    listeners[num_kept++] = listeners[i];
+    Wait & wait = wait_iter->second;
+    wait.leaf_values[listeners[i].leaf] = wait.leaves[listeners[i].leaf]->evaluate();
+
+    // Listeners of the same wait are adjacent
+    if (updated_waits.empty() || updated_waits.back() != wait_iter->first) {
+      updated_waits.push_back(wait_iter->first);
+    }
+  }
+
+  listeners.resize(num_kept);
+
+  std::vector<WaitId> completed_waits;
+
+  for (const WaitId id : updated_waits) {
+    if (evaluate(_waits[id])) {
+      completed_waits.push_back(id);
+    }
+  }
+
+  // Call after, as callbacks might start new waits
+  for (const WaitId id : completed_waits) {
+    complete(id, Result::Success);
+  }
+}
+
+void ConditionWaiter::complete(WaitId id, Result result)
+{
+  const auto wait_iter = _waits.find(id);
+
+  if (wait_iter == _waits.end()) {
+    return;
+  }
+
+  _timer_wheel->cancel(wait_iter->second.timeout);
+  const CompletedCallback on_completed(std::move(wait_iter->second.on_completed));
+  _waits.erase(wait_iter);
+  on_completed(result);             // Call after, as it might trigger new requests
+}
+
+bool ConditionWaiter::cancel(WaitId id, Result result)
+{
+  if (_waits.find(id) == _waits.end()) {
+    return false;
+  }
+
+  complete(id, result);
+  return true;
+}
+
+void ConditionWaiter::cancelAll(Result result)
+{
+  std::vector<WaitId> ids;
+  ids.reserve(_waits.size());
+
+  for (const auto & wait : _waits) {
+    ids.push_back(wait.first);
+  }
+
+  for (const WaitId id : ids) {
+    complete(id, result);
+  }
+}
+
+} // namespace px4_ros2
@@ -0,0 +1,137 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <px4_ros2/control/control_allocator.hpp>
+
+#include <Eigen/SVD>
+
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+
+namespace px4_ros2
+{
+
+ControlAllocator::ControlAllocator(const EffectivenessMatrix & effectiveness, int num_actuators)
+: ControlAllocator(effectiveness, num_actuators, Settings{}) {}
+
+ControlAllocator::ControlAllocator(
+  const EffectivenessMatrix & effectiveness, int num_actuators,
+  const Settings & settings)
+: _num_actuators(num_actuators), _settings(settings), _effectiveness(effectiveness)
+{
+  if (num_actuators < 1 || num_actuators > kMaxNumActuators) {
+    throw std::runtime_error("Invalid number of actuators");
+  }
+
+  if ((settings.weights.head(num_actuators).array() <= 0.f).any()) {
+    throw std::runtime_error("Actuator weights must be positive");
+  }
+
+  _effectiveness.rightCols(kMaxNumActuators - num_actuators).setZero();
+
+  // Weighted pseudo-inverse W^-1 B^T (B W^-1 B^T)^-1, computed as W^-1/2 (B W^-1/2)^+
+  ActuatorVector inverse_sqrt_weights = ActuatorVector::Zero();
+  inverse_sqrt_weights.head(num_actuators) =
+    settings.weights.head(num_actuators).cwiseInverse().cwiseSqrt();
+  const EffectivenessMatrix scaled = _effectiveness * inverse_sqrt_weights.asDiagonal();
+
+  // Rank-deficient matrices are common (e.g. no lateral thrust for multicopters)
+  const Eigen::JacobiSVD<EffectivenessMatrix> svd(
+    scaled, Eigen::ComputeFullU | Eigen::ComputeFullV);
+  const auto & singular_values = svd.singularValues();
+  const float tolerance = 1e-5f * std::max(singular_values(0), 1.f);
+  ControlVector inverse_singular_values = ControlVector::Zero();
+
+  for (int i = 0; i < singular_values.size(); ++i) {
+    if (singular_values(i) > tolerance) {
+      inverse_singular_values(i) = 1.f / singular_values(i);
+    }
+  }
+
+  _mix = inverse_sqrt_weights.asDiagonal() * svd.matrixV().leftCols<kNumControls>() *
+    inverse_singular_values.asDiagonal() * svd.matrixU().transpose();
+}
+
+ControlAllocator::ActuatorVector ControlAllocator::allocate(
+  const Eigen::Vector3f & thrust_frd,
+  const Eigen::Vector3f & torque_frd)
+{
+  ControlVector control;
+  control << torque_frd, thrust_frd;
+
+  // Mix without yaw first
+  ActuatorVector actuator_sp = _mix * control - _mix.col(2) * control(2);
+
+  // Only reduce thrust, then reduce roll and pitch if still saturating
+  desaturate(actuator_sp, _mix.col(5), _settings.actuator_max, true);
+  desaturate(actuator_sp, _mix.col(0), _settings.actuator_max);
+  desaturate(actuator_sp, _mix.col(1), _settings.actuator_max);
+
+  // Add yaw, reducing it if needed without changing roll and pitch. Allow some yaw response at
+  // maximum thrust by then reducing the thrust.
+  actuator_sp += _mix.col(2) * control(2);
+  const ActuatorVector extended_max = _settings.actuator_max +
+    (_settings.actuator_max - _settings.actuator_min) * 0.15f;
+  desaturate(actuator_sp, _mix.col(2), extended_max);
+  desaturate(actuator_sp, _mix.col(5), _settings.actuator_max, true);
+
+  actuator_sp = actuator_sp.cwiseMax(_settings.actuator_min).cwiseMin(_settings.actuator_max);
+  actuator_sp.tail(kMaxNumActuators - _num_actuators).setZero();
+  _allocated_control = _effectiveness * actuator_sp;
+  actuator_sp.tail(kMaxNumActuators - _num_actuators).setConstant(NAN);
+  return actuator_sp;
+}
+
+float ControlAllocator::desaturationGain(
+  const ActuatorVector & desaturation_vector,
+  const ActuatorVector & actuator_sp, const ActuatorVector & actuator_max) const
+{
+  float k_min = 0.f;
+  float k_max = 0.f;
+
+  for (int i = 0; i < _num_actuators; ++i) {
+    // Avoid division by zero. If desaturation_vector(i) is zero, there's nothing we can do to
+    // unsaturate anyway
+    if (std::abs(desaturation_vector(i)) < FLT_EPSILON) {
+      continue;
+    }
+
+    float k = 0.f;
+
+    if (actuator_sp(i) < _settings.actuator_min(i)) {
+      k = (_settings.actuator_min(i) - actuator_sp(i)) / desaturation_vector(i);
+
+    } else if (actuator_sp(i) > actuator_max(i)) {
+      k = (actuator_max(i) - actuator_sp(i)) / desaturation_vector(i);
+    }
+
+    k_min = std::min(k, k_min);
+    k_max = std::max(k, k_max);
+  }
+
+  // Reduce the saturation as much as possible
+  return k_min + k_max;
+}
+
+void ControlAllocator::desaturate(
+  ActuatorVector & actuator_sp, const ActuatorVector & desaturation_vector,
+  const ActuatorVector & actuator_max, bool increase_only) const
+{
+  float gain = desaturationGain(desaturation_vector, actuator_sp, actuator_max);
+
+  // Only increase the control along the vector (e.g. only reduce the thrust, which is negative)
+  if (increase_only && gain < 0.f) {
+    return;
+  }
+
+  actuator_sp += gain * desaturation_vector;
+
+  // Redo the process once more, to get better results when saturating in both directions
+  gain = desaturationGain(desaturation_vector, actuator_sp, actuator_max);
+  actuator_sp += 0.5f * gain * desaturation_vector;
+}
+
+} // namespace px4_ros2
@@ -0,0 +1,115 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <px4_ros2/control/geometric_controller.hpp>
+#include <px4_ros2/utils/geometry.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace px4_ros2
+{
+
+GeometricPositionController::Output GeometricPositionController::update(
+  const State & state,
+  const TrajectorySample & reference, float dt_s)
+{
+  static constexpr float kMaxDt = 0.1f; ///< [s] Longer intervals do not integrate
+
+  const Eigen::Vector3f position_error = state.position_ned_m - reference.position_ned_m;
+  const Eigen::Vector3f velocity_error = state.velocity_ned_m_s - reference.velocity_ned_m_s;
+
+  // Desired specific force (thrust per mass) in NED: feedback + feed-forward - gravity
+  Eigen::Vector3f force = -_gains.position.cwiseProduct(position_error) -
+    _gains.velocity.cwiseProduct(velocity_error) - _integral + reference.acceleration_ned_m_s2;
+  force.z() -= kGravity;
+
+  // Keep a minimum upwards component, then limit the tilt by reducing the horizontal component
+  const float thrust_scale = kGravity / _settings.hover_thrust; ///< [m/s^2] at full thrust
+  force.z() = std::min(force.z(), -_settings.min_thrust * thrust_scale);
+  const float max_horizontal = -force.z() * std::tan(_settings.max_tilt_rad);
+  const float horizontal = force.head<2>().norm();
+
+  if (horizontal > max_horizontal) {
+    force.head<2>() *= max_horizontal / horizontal;
+  }
+
+  // Body z-axis (down) opposite to the force. The x-axis stays in the vertical plane of the
+  // heading, so the yaw of the setpoint matches the reference exactly (same as PX4).
+  const Eigen::Vector3f body_z = -force.normalized();
+  const float yaw = std::isfinite(reference.yaw_ned_rad) ? reference.yaw_ned_rad :
+    quaternionToYaw(state.attitude);
+  const Eigen::Vector3f heading_y{-std::sin(yaw), std::cos(yaw), 0.f};
+  const Eigen::Vector3f body_x = heading_y.cross(body_z).normalized();
+  Eigen::Matrix3f rotation;
+  rotation << body_x, body_z.cross(body_x), body_z;
+
+  // Collective thrust along the current body z-axis, so the vehicle does not accelerate in the
+  // wrong direction while rotating
+  const Eigen::Vector3f current_body_z = state.attitude * Eigen::Vector3f::UnitZ();
+  const float thrust = std::clamp(
+    -force.dot(current_body_z) / thrust_scale, _settings.min_thrust,
+    _settings.max_thrust);
+
+  if (dt_s > 0.f && dt_s < kMaxDt) {
+    _integral = (_integral + _gains.integral.cwiseProduct(position_error) * dt_s)
+      .cwiseMax(-_gains.integrator_limit).cwiseMin(_gains.integrator_limit);
+  }
+
+  Output output;
+  output.attitude = Eigen::Quaternionf{rotation};
+  output.thrust_frd = Eigen::Vector3f{0.f, 0.f, -thrust};
+  output.yaw_rate_rad_s = std::isfinite(reference.yaw_rate_ned_rad_s) ?
+    reference.yaw_rate_ned_rad_s : 0.f;
+  return output;
+}
+
+GeometricTrackingController::GeometricTrackingController(
+  Context & context,
+  std::shared_ptr<AttitudeSetpointType> attitude_setpoint)
+: GeometricTrackingController(context, std::move(attitude_setpoint),
+    GeometricPositionController::Gains{}, GeometricPositionController::Settings{}) {}
+
+GeometricTrackingController::GeometricTrackingController(
+  Context & context, std::shared_ptr<AttitudeSetpointType> attitude_setpoint,
+  const GeometricPositionController::Gains & gains,
+  const GeometricPositionController::Settings & settings)
+: _node(context.node()), _attitude_setpoint(std::move(attitude_setpoint)),
+  _local_position(context), _attitude(context), _controller(gains, settings)
+{
+}
+
+bool GeometricTrackingController::update(const TrajectorySample & reference)
+{
+  if (!_local_position.positionXYValid() || !_local_position.positionZValid() ||
+    !_local_position.velocityXYValid() || !_local_position.velocityZValid() ||
+    !_attitude.lastValid())
+  {
+    return false;
+  }
+
+  const rclcpp::Time now = _node.get_clock()->now();
+  const float dt_s = _last_update_ns == 0 ? 0.f :
+    static_cast<float>(now.nanoseconds() - _last_update_ns) * 1e-9f;
+  _last_update_ns = now.nanoseconds();
+
+  GeometricPositionController::State state;
+  state.position_ned_m = _local_position.predictedPositionNed(now);
+  state.velocity_ned_m_s = _local_position.predictedVelocityNed(now);
+  state.attitude = _attitude.attitude();
+
+  const GeometricPositionController::Output output = _controller.update(state, reference, dt_s);
+  _attitude_setpoint->update(output.attitude, output.thrust_frd, output.yaw_rate_rad_s);
+  return true;
+}
+
+void GeometricTrackingController::reset()
+{
+  _controller.reset();
+  _last_update_ns = 0;
+}
+
+} // namespace px4_ros2
@@ -0,0 +1,159 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <px4_ros2/control/rate_controller.hpp>
+#include <px4_ros2/utils/geometry.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace px4_ros2
+{
+
+void RateController::reset()
+{
+  _integral.setZero();
+  _rate_derivative.setZero();
+  _has_previous_rate = false;
+  _saturation_positive.setConstant(false);
+  _saturation_negative.setConstant(false);
+}
+
+void RateController::setSaturation(
+  const Eigen::Matrix<bool, 3, 1> & positive,
+  const Eigen::Matrix<bool, 3, 1> & negative)
+{
+  _saturation_positive = positive;
+  _saturation_negative = negative;
+}
+
+Eigen::Vector3f RateController::update(
+  const Eigen::Vector3f & rate_setpoint_frd,
+  const Eigen::Vector3f & rate_frd, float dt_s)
+{
+  const bool dt_valid = dt_s > 0.f && dt_s < kMaxDt;
+  const Eigen::Vector3f error = rate_setpoint_frd - rate_frd;
+
+  // Derivative on the measurement (avoids spikes on setpoint changes), with a first order low-pass
+  if (dt_valid && _has_previous_rate) {
+    const float time_constant =
+      1.f / (2.f * static_cast<float>(M_PI) * _gains.derivative_cutoff_hz);
+    const float alpha = dt_s / (dt_s + time_constant);
+    _rate_derivative += alpha * ((rate_frd - _previous_rate) / dt_s - _rate_derivative);
+
+  } else if (!dt_valid) {
+    _rate_derivative.setZero();
+  }
+
+  _previous_rate = rate_frd;
+  _has_previous_rate = true;
+
+  const Eigen::Vector3f torque = _gains.p.cwiseProduct(error) + _integral -
+    _gains.d.cwiseProduct(_rate_derivative) + _gains.feed_forward.cwiseProduct(rate_setpoint_frd);
+
+  if (dt_valid) {
+    for (int i = 0; i < 3; ++i) {
+      float axis_error = error(i);
+
+      // Anti-windup: do not integrate further into the saturation
+      if ((_saturation_positive(i) && axis_error > 0.f) ||
+        (_saturation_negative(i) && axis_error < 0.f))
+      {
+        axis_error = 0.f;
+      }
+
+      // Reduce the integration for large errors, e.g. during flips (zero at 400 deg/s)
+      const float error_ratio = axis_error / degToRad(400.f);
+      const float integration_factor = std::max(0.f, 1.f - error_ratio * error_ratio);
+
+      _integral(i) = std::clamp(
+        _integral(i) + integration_factor * _gains.i(i) * axis_error * dt_s,
+        -_gains.integrator_limit(i), _gains.integrator_limit(i));
+    }
+  }
+
+  return torque;
+}
+
+BodyRateController::BodyRateController(
+  Context & context,
+  std::shared_ptr<ThrustTorqueSetpointType> thrust_torque_setpoint,
+  const RateController::Gains & gains)
+: _angular_velocity(context), _thrust_torque_setpoint(std::move(thrust_torque_setpoint)),
+  _controller(gains)
+{
+  _angular_velocity.onUpdate(
+    [this](const px4_msgs::msg::VehicleAngularVelocity & angular_velocity) {
+      onAngularVelocity(angular_velocity);
+    });
+}
+
+BodyRateController::BodyRateController(
+  Context & context,
+  std::shared_ptr<DirectActuatorsSetpointType> direct_actuators_setpoint,
+  std::shared_ptr<ControlAllocator> allocator, const RateController::Gains & gains)
+: _angular_velocity(context), _direct_actuators_setpoint(std::move(direct_actuators_setpoint)),
+  _allocator(std::move(allocator)), _controller(gains)
+{
+  _angular_velocity.onUpdate(
+    [this](const px4_msgs::msg::VehicleAngularVelocity & angular_velocity) {
+      onAngularVelocity(angular_velocity);
+    });
+}
+
+void BodyRateController::setSetpoint(
+  const Eigen::Vector3f & rates_frd,
+  const Eigen::Vector3f & thrust_frd)
+{
+  _rates_setpoint = rates_frd;
+  _thrust_setpoint = thrust_frd;
+}
+
+void BodyRateController::setEnabled(bool enabled)
+{
+  if (enabled && !_enabled) {
+    _controller.reset();
+    _last_timestamp_sample = 0;
+  }
+
+  _enabled = enabled;
+}
+
+void BodyRateController::onAngularVelocity(
+  const px4_msgs::msg::VehicleAngularVelocity & angular_velocity)
+{
+  if (!_enabled) {
+    return;
+  }
+
+  const float dt_s = _last_timestamp_sample == 0 ? 0.f :
+    static_cast<float>(static_cast<int64_t>(angular_velocity.timestamp_sample -
+    _last_timestamp_sample)) * 1e-6f;
+  _last_timestamp_sample = angular_velocity.timestamp_sample;
+
+  const Eigen::Vector3f rate{angular_velocity.xyz[0], angular_velocity.xyz[1],
+    angular_velocity.xyz[2]};
+  _last_torque = _controller.update(_rates_setpoint, rate, dt_s);
+
+  Eigen::Vector3f achieved_torque;
+
+  if (_allocator) {
+    _direct_actuators_setpoint->updateMotors(_allocator->allocate(_thrust_setpoint, _last_torque));
+    achieved_torque = _allocator->allocatedControl().head<3>();
+
+  } else {
+    achieved_torque = _last_torque.cwiseMax(-1.f).cwiseMin(1.f);
+    _thrust_torque_setpoint->update(_thrust_setpoint, achieved_torque);
+  }
+
+  static constexpr float kSaturationTolerance = 1e-4f;
+  const Eigen::Vector3f torque_error = _last_torque - achieved_torque;
+  _controller.setSaturation(
+    (torque_error.array() > kSaturationTolerance).matrix(),
+    (torque_error.array() < -kSaturationTolerance).matrix());
+}
+
+} // namespace px4_ros2
@@ -5,6 +5,7 @@
 
 #include <px4_ros2/control/setpoint_types/direct_actuators.hpp>
 
+#include "../../utils/loaned_publish.hpp"
 
 namespace px4_ros2
 {
@@ -24,12 +25,13 @@ void DirectActuatorsSetpointType::updateMotors(
 {
   onUpdate();
 
-  px4_msgs::msg::ActuatorMotors sp_motors{};
-  for (int i = 0; i < kMaxNumMotors; ++i) {
-    sp_motors.control[i] = motor_commands(i);
-  }
-  sp_motors.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
-  _actuator_motors_pub->publish(sp_motors);
+  publishLoaned(
+    *_actuator_motors_pub, [&](px4_msgs::msg::ActuatorMotors & sp_motors) {
+      for (int i = 0; i < kMaxNumMotors; ++i) {
+        sp_motors.control[i] = motor_commands(i);
+      }
+      sp_motors.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+    });
 }
 
 void DirectActuatorsSetpointType::updateServos(
@@ -38,12 +40,13 @@ void DirectActuatorsSetpointType::updateServos(
 {
   onUpdate();
 
-  px4_msgs::msg::ActuatorServos sp_servos{};
-  for (int i = 0; i < kMaxNumServos; ++i) {
-    sp_servos.control[i] = servo_commands(i);
-  }
-  sp_servos.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
-  _actuator_servos_pub->publish(sp_servos);
+  publishLoaned(
+    *_actuator_servos_pub, [&](px4_msgs::msg::ActuatorServos & sp_servos) {
+      for (int i = 0; i < kMaxNumServos; ++i) {
+        sp_servos.control[i] = servo_commands(i);
+      }
+      sp_servos.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+    });
 }
 
 SetpointBase::Configuration DirectActuatorsSetpointType::getConfiguration()
@@ -6,6 +6,8 @@
 #include <px4_ros2/control/setpoint_types/experimental/attitude.hpp>
 #include <px4_ros2/utils/geometry.hpp>
 
+#include "../../../utils/loaned_publish.hpp"
+
 
 namespace px4_ros2
 {
@@ -16,6 +18,22 @@ AttitudeSetpointType::AttitudeSetpointType(Context & context)
   _vehicle_attitude_setpoint_pub =
     context.node().create_publisher<px4_msgs::msg::VehicleAttitudeSetpoint>(
     context.topicNamespacePrefix() + "fmu/in/vehicle_attitude_setpoint", 1);
+
+  // Patch a pre-serialized message, unless loaning or intra-process communication is used
+  if (canUseSerializedTemplate(_node, *_vehicle_attitude_setpoint_pub)) {
+    try {
+      _serialized_setpoint =
+        std::make_unique<SerializedMessageTemplate<px4_msgs::msg::VehicleAttitudeSetpoint>>();
+      _serialized_setpoint->addField(&px4_msgs::msg::VehicleAttitudeSetpoint::timestamp);
+      _serialized_setpoint->addField(&px4_msgs::msg::VehicleAttitudeSetpoint::q_d);
+      _serialized_setpoint->addField(&px4_msgs::msg::VehicleAttitudeSetpoint::thrust_body);
+      _serialized_setpoint->addField(&px4_msgs::msg::VehicleAttitudeSetpoint::yaw_sp_move_rate);
+
+    } catch (const std::runtime_error & error) {
+      RCLCPP_DEBUG(_node.get_logger(), "Not using a serialized setpoint template: %s", error.what());
+      _serialized_setpoint.reset();
+    }
+  }
 }
 
 void AttitudeSetpointType::update(
@@ -25,17 +43,19 @@ void AttitudeSetpointType::update(
 {
   onUpdate();
 
-  px4_msgs::msg::VehicleAttitudeSetpoint sp{};
-  sp.q_d[0] = attitude_setpoint.w();
-  sp.q_d[1] = attitude_setpoint.x();
-  sp.q_d[2] = attitude_setpoint.y();
-  sp.q_d[3] = attitude_setpoint.z();
-  sp.thrust_body[0] = thrust_setpoint_frd(0);
-  sp.thrust_body[1] = thrust_setpoint_frd(1);
-  sp.thrust_body[2] = thrust_setpoint_frd(2);
-  sp.yaw_sp_move_rate = yaw_sp_move_rate_rad_s;
-  sp.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
-  _vehicle_attitude_setpoint_pub->publish(sp);
+  publishLoaned(
+    *_vehicle_attitude_setpoint_pub, _serialized_setpoint.get(),
+    [&](px4_msgs::msg::VehicleAttitudeSetpoint & sp) {
+      sp.q_d[0] = attitude_setpoint.w();
+      sp.q_d[1] = attitude_setpoint.x();
+      sp.q_d[2] = attitude_setpoint.y();
+      sp.q_d[3] = attitude_setpoint.z();
+      sp.thrust_body[0] = thrust_setpoint_frd(0);
+      sp.thrust_body[1] = thrust_setpoint_frd(1);
+      sp.thrust_body[2] = thrust_setpoint_frd(2);
+      sp.yaw_sp_move_rate = yaw_sp_move_rate_rad_s;
+      sp.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+    });
 }
 
 void AttitudeSetpointType::update(
@@ -45,27 +65,9 @@ void AttitudeSetpointType::update(
   const Eigen::Vector3f & thrust_setpoint_body,
   const float yaw_sp_move_rate_rad_s)
 {
-  onUpdate();
-
-  px4_msgs::msg::VehicleAttitudeSetpoint sp{};
-  sp.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
-
-  sp.yaw_sp_move_rate = yaw_sp_move_rate_rad_s;
-
-  Eigen::Quaternionf att_setpoint_q{px4_ros2::eulerRpyToQuaternion(
-      Eigen::Vector3f{roll, pitch,
-        yaw})};
-
-  sp.q_d[0] = att_setpoint_q.w();
-  sp.q_d[1] = att_setpoint_q.x();
-  sp.q_d[2] = att_setpoint_q.y();
-  sp.q_d[3] = att_setpoint_q.z();
-
-  sp.thrust_body[0] = thrust_setpoint_body(0);
-  sp.thrust_body[1] = thrust_setpoint_body(1);
-  sp.thrust_body[2] = thrust_setpoint_body(2);
-
-  _vehicle_attitude_setpoint_pub->publish(sp);
+  const Eigen::Quaternionf att_setpoint_q{px4_ros2::eulerRpyToQuaternion(
+      Eigen::Vector3f{roll, pitch, yaw})};
+  update(att_setpoint_q, thrust_setpoint_body, yaw_sp_move_rate_rad_s);
 }
 
 SetpointBase::Configuration AttitudeSetpointType::getConfiguration()
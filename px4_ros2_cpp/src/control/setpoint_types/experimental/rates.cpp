@@ -5,6 +5,7 @@
 
 #include <px4_ros2/control/setpoint_types/experimental/rates.hpp>
 
+#include "../../../utils/loaned_publish.hpp"
 
 namespace px4_ros2
 {
@@ -23,15 +24,16 @@ void RatesSetpointType::update(
 {
   onUpdate();
 
-  px4_msgs::msg::VehicleRatesSetpoint sp{};
-  sp.roll = rate_setpoints_ned_rad(0);
-  sp.pitch = rate_setpoints_ned_rad(1);
-  sp.yaw = rate_setpoints_ned_rad(2);
-  sp.thrust_body[0] = thrust_setpoint_frd(0);
-  sp.thrust_body[1] = thrust_setpoint_frd(1);
-  sp.thrust_body[2] = thrust_setpoint_frd(2);
-  sp.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
-  _vehicle_rates_setpoint_pub->publish(sp);
+  publishLoaned(
+    *_vehicle_rates_setpoint_pub, [&](px4_msgs::msg::VehicleRatesSetpoint & sp) {
+      sp.roll = rate_setpoints_ned_rad(0);
+      sp.pitch = rate_setpoints_ned_rad(1);
+      sp.yaw = rate_setpoints_ned_rad(2);
+      sp.thrust_body[0] = thrust_setpoint_frd(0);
+      sp.thrust_body[1] = thrust_setpoint_frd(1);
+      sp.thrust_body[2] = thrust_setpoint_frd(2);
+      sp.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+    });
 }
 
 SetpointBase::Configuration RatesSetpointType::getConfiguration()
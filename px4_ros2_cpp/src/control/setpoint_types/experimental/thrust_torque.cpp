@@ -0,0 +1,65 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <px4_ros2/control/setpoint_types/experimental/thrust_torque.hpp>
+
+#include "../../../utils/loaned_publish.hpp"
+
+namespace px4_ros2
+{
+
+ThrustTorqueSetpointType::ThrustTorqueSetpointType(Context & context)
+: SetpointBase(context), _node(context.node())
+{
+  _vehicle_thrust_setpoint_pub =
+    context.node().create_publisher<px4_msgs::msg::VehicleThrustSetpoint>(
+    context.topicNamespacePrefix() + "fmu/in/vehicle_thrust_setpoint", 1);
+  _vehicle_torque_setpoint_pub =
+    context.node().create_publisher<px4_msgs::msg::VehicleTorqueSetpoint>(
+    context.topicNamespacePrefix() + "fmu/in/vehicle_torque_setpoint", 1);
+}
+
+void ThrustTorqueSetpointType::update(
+  const Eigen::Vector3f & thrust_setpoint_frd,
+  const Eigen::Vector3f & torque_setpoint_frd)
+{
+  onUpdate();
+
+  // Both setpoints use the same timestamp, so the allocation can match them
+  const uint64_t timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+
+  publishLoaned(
+    *_vehicle_thrust_setpoint_pub, [&](px4_msgs::msg::VehicleThrustSetpoint & sp) {
+      sp.timestamp = timestamp;
+      sp.timestamp_sample = timestamp;
+      sp.xyz[0] = thrust_setpoint_frd(0);
+      sp.xyz[1] = thrust_setpoint_frd(1);
+      sp.xyz[2] = thrust_setpoint_frd(2);
+    });
+
+  publishLoaned(
+    *_vehicle_torque_setpoint_pub, [&](px4_msgs::msg::VehicleTorqueSetpoint & sp) {
+      sp.timestamp = timestamp;
+      sp.timestamp_sample = timestamp;
+      sp.xyz[0] = torque_setpoint_frd(0);
+      sp.xyz[1] = torque_setpoint_frd(1);
+      sp.xyz[2] = torque_setpoint_frd(2);
+    });
+}
+
+SetpointBase::Configuration ThrustTorqueSetpointType::getConfiguration()
+{
+  Configuration config{};
+  config.control_allocation_enabled = true;
+  config.rates_enabled = false;
+  config.attitude_enabled = false;
+  config.altitude_enabled = false;
+  config.climb_rate_enabled = false;
+  config.acceleration_enabled = false;
+  config.velocity_enabled = false;
+  config.position_enabled = false;
+  return config;
+}
+} // namespace px4_ros2
@@ -5,6 +5,9 @@
 
 #include <px4_ros2/control/setpoint_types/experimental/trajectory.hpp>
 
+#include <utility>
+
+#include "../../../utils/loaned_publish.hpp"
 
 namespace px4_ros2
 {
@@ -14,6 +17,24 @@ TrajectorySetpointType::TrajectorySetpointType(Context & context)
 {
   _trajectory_setpoint_pub = context.node().create_publisher<px4_msgs::msg::TrajectorySetpoint>(
     context.topicNamespacePrefix() + "fmu/in/trajectory_setpoint", 1);
+
+  // Patch a pre-serialized message, unless loaning or intra-process communication is used
+  if (canUseSerializedTemplate(_node, *_trajectory_setpoint_pub)) {
+    try {
+      _serialized_setpoint =
+        std::make_unique<SerializedMessageTemplate<px4_msgs::msg::TrajectorySetpoint>>();
+      _serialized_setpoint->addField(&px4_msgs::msg::TrajectorySetpoint::timestamp);
+      _serialized_setpoint->addField(&px4_msgs::msg::TrajectorySetpoint::position);
+      _serialized_setpoint->addField(&px4_msgs::msg::TrajectorySetpoint::velocity);
+      _serialized_setpoint->addField(&px4_msgs::msg::TrajectorySetpoint::acceleration);
+      _serialized_setpoint->addField(&px4_msgs::msg::TrajectorySetpoint::yaw);
+      _serialized_setpoint->addField(&px4_msgs::msg::TrajectorySetpoint::yawspeed);
+
+    } catch (const std::runtime_error & error) {
+      RCLCPP_DEBUG(_node.get_logger(), "Not using a serialized setpoint template: %s", error.what());
+      _serialized_setpoint.reset();
+    }
+  }
 }
 
 void TrajectorySetpointType::update(
@@ -24,21 +45,24 @@ void TrajectorySetpointType::update(
 {
   onUpdate();
 
-  px4_msgs::msg::TrajectorySetpoint sp{};
-  sp.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
-
-  sp.position[0] = sp.position[1] = sp.position[2] = NAN;
-  sp.velocity[0] = velocity_ned_m_s.x();
-  sp.velocity[1] = velocity_ned_m_s.y();
-  sp.velocity[2] = velocity_ned_m_s.z();
-  Eigen::Vector3f acceleration = acceleration_ned_m_s2.value_or(Eigen::Vector3f{NAN, NAN, NAN});
-  sp.acceleration[0] = acceleration.x();
-  sp.acceleration[1] = acceleration.y();
-  sp.acceleration[2] = acceleration.z();
-  sp.yaw = yaw_ned_rad.value_or(NAN);
-  sp.yawspeed = yaw_rate_ned_rad_s.value_or(NAN);
-
-  _trajectory_setpoint_pub->publish(sp);
+  const Eigen::Vector3f acceleration =
+    acceleration_ned_m_s2.value_or(Eigen::Vector3f{NAN, NAN, NAN});
+
+  publishLoaned(
+    *_trajectory_setpoint_pub, _serialized_setpoint.get(),
+    [&](px4_msgs::msg::TrajectorySetpoint & sp) {
+      sp.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+
+      sp.position[0] = sp.position[1] = sp.position[2] = NAN;
+      sp.velocity[0] = velocity_ned_m_s.x();
+      sp.velocity[1] = velocity_ned_m_s.y();
+      sp.velocity[2] = velocity_ned_m_s.z();
+      sp.acceleration[0] = acceleration.x();
+      sp.acceleration[1] = acceleration.y();
+      sp.acceleration[2] = acceleration.z();
+      sp.yaw = yaw_ned_rad.value_or(NAN);
+      sp.yawspeed = yaw_rate_ned_rad_s.value_or(NAN);
+    });
 }
 
 void TrajectorySetpointType::updatePosition(
@@ -46,18 +70,71 @@ void TrajectorySetpointType::updatePosition(
 {
   onUpdate();
 
-  px4_msgs::msg::TrajectorySetpoint sp{};
-  sp.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+  publishLoaned(
+    *_trajectory_setpoint_pub, _serialized_setpoint.get(),
+    [&](px4_msgs::msg::TrajectorySetpoint & sp) {
+      sp.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+
+      sp.position[0] = position_ned_m.x();
+      sp.position[1] = position_ned_m.y();
+      sp.position[2] = position_ned_m.z();
+      sp.velocity[0] = sp.velocity[1] = sp.velocity[2] = NAN;
+      sp.acceleration[0] = sp.acceleration[1] = sp.acceleration[2] = NAN;
+      sp.yaw = NAN;
+      sp.yawspeed = NAN;
+    });
+}
+
+void TrajectorySetpointType::update(const TrajectorySample & sample)
+{
+  onUpdate();
+
+  publishLoaned(
+    *_trajectory_setpoint_pub, _serialized_setpoint.get(),
+    [&](px4_msgs::msg::TrajectorySetpoint & sp) {
+      sp.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
 
-  sp.position[0] = position_ned_m.x();
-  sp.position[1] = position_ned_m.y();
-  sp.position[2] = position_ned_m.z();
-  sp.velocity[0] = sp.velocity[1] = sp.velocity[2] = NAN;
-  sp.acceleration[0] = sp.acceleration[1] = sp.acceleration[2] = NAN;
-  sp.yaw = NAN;
-  sp.yawspeed = NAN;
+      sp.position[0] = sample.position_ned_m.x();
+      sp.position[1] = sample.position_ned_m.y();
+      sp.position[2] = sample.position_ned_m.z();
+      sp.velocity[0] = sample.velocity_ned_m_s.x();
+      sp.velocity[1] = sample.velocity_ned_m_s.y();
+      sp.velocity[2] = sample.velocity_ned_m_s.z();
+      sp.acceleration[0] = sample.acceleration_ned_m_s2.x();
+      sp.acceleration[1] = sample.acceleration_ned_m_s2.y();
+      sp.acceleration[2] = sample.acceleration_ned_m_s2.z();
+      sp.yaw = sample.yaw_ned_rad;
+      sp.yawspeed = sample.yaw_rate_ned_rad_s;
+    });
+}
+
+void TrajectorySetpointType::setTrajectory(
+  std::shared_ptr<const PolynomialTrajectory> trajectory,
+  const rclcpp::Time & start_time)
+{
+  _trajectory = std::move(trajectory);
+  _trajectory_start_time = start_time;
+}
+
+bool TrajectorySetpointType::updateFromTrajectory()
+{
+  if (!_trajectory || _trajectory->empty()) {
+    return false;
+  }
+
+  const rclcpp::Time now = _node.get_clock()->now();
+  update(_trajectory->sample((now - _trajectory_start_time).seconds()));
+  return true;
+}
+
+bool TrajectorySetpointType::trajectoryFinished() const
+{
+  if (!_trajectory) {
+    return true;
+  }
 
-  _trajectory_setpoint_pub->publish(sp);
+  const rclcpp::Time now = _node.get_clock()->now();
+  return (now - _trajectory_start_time).seconds() >= _trajectory->duration();
 }
 
 SetpointBase::Configuration TrajectorySetpointType::getConfiguration()
@@ -5,6 +5,7 @@
 
 #include <px4_ros2/control/setpoint_types/goto.hpp>
 
+#include "../../utils/loaned_publish.hpp"
 
 namespace px4_ros2
 {
@@ -26,29 +27,30 @@ void GotoSetpointType::update(
 {
   onUpdate();
 
-  px4_msgs::msg::GotoSetpoint sp{};
+  publishLoaned(
+    *_goto_setpoint_pub, [&](px4_msgs::msg::GotoSetpoint & sp) {
 
-  // setpoints
-  sp.position[0] = position(0);
-  sp.position[1] = position(1);
-  sp.position[2] = position(2);
-  sp.heading = heading.value_or(0.f);
+      // setpoints
+      sp.position[0] = position(0);
+      sp.position[1] = position(1);
+      sp.position[2] = position(2);
+      sp.heading = heading.value_or(0.f);
 
-  // setpoint flags
-  sp.flag_control_heading = heading.has_value();
+      // setpoint flags
+      sp.flag_control_heading = heading.has_value();
 
-  // constraints
-  sp.max_horizontal_speed = max_horizontal_speed.value_or(0.f);
-  sp.max_vertical_speed = max_vertical_speed.value_or(0.f);
-  sp.max_heading_rate = max_heading_rate.value_or(0.f);
+      // constraints
+      sp.max_horizontal_speed = max_horizontal_speed.value_or(0.f);
+      sp.max_vertical_speed = max_vertical_speed.value_or(0.f);
+      sp.max_heading_rate = max_heading_rate.value_or(0.f);
 
-  // constraint flags
-  sp.flag_set_max_horizontal_speed = max_horizontal_speed.has_value();
-  sp.flag_set_max_vertical_speed = max_vertical_speed.has_value();
-  sp.flag_set_max_heading_rate = max_heading_rate.has_value();
+      // constraint flags
+      sp.flag_set_max_horizontal_speed = max_horizontal_speed.has_value();
+      sp.flag_set_max_vertical_speed = max_vertical_speed.has_value();
+      sp.flag_set_max_heading_rate = max_heading_rate.has_value();
 
-  sp.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
-  _goto_setpoint_pub->publish(sp);
+      sp.timestamp = _node.get_clock()->now().nanoseconds() / 1000;
+    });
 }
 
 SetpointBase::Configuration GotoSetpointType::getConfiguration()
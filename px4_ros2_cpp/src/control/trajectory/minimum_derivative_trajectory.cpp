@@ -0,0 +1,301 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <px4_ros2/control/trajectory/minimum_derivative_trajectory.hpp>
+#include <px4_ros2/utils/geometry.hpp>
+
+#include <Eigen/LU>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace px4_ros2
+{
+
+namespace
+{
+/**
+ * k! / (k - j)!, the factor of the j-th derivative of t^k
+ */
+double fallingFactorial(int k, int j)
+{
+  double result = 1.;
+
+  for (int i = k - j + 1; i <= k; ++i) {
+    result *= i;
+  }
+
+  return result;
+}
+
+float finiteOrZero(float value)
+{
+  return std::isfinite(value) ? value : 0.f;
+}
+} // namespace
+
+template<int Derivative>
+MinimumDerivativeTrajectoryGenerator<Derivative>::MinimumDerivativeTrajectoryGenerator()
+: MinimumDerivativeTrajectoryGenerator(Settings{}) {}
+
+template<int Derivative>
+MinimumDerivativeTrajectoryGenerator<Derivative>::MinimumDerivativeTrajectoryGenerator(
+  const Settings & settings)
+: _settings(settings)
+{
+  // Boundary derivatives 0..Derivative-1 at t=0 and t=1 of a polynomial on the unit interval
+  Eigen::Matrix<double, 2 * Derivative, 2 * Derivative> coefficients_to_boundary =
+    Eigen::Matrix<double, 2 * Derivative, 2 * Derivative>::Zero();
+
+  for (int j = 0; j < Derivative; ++j) {
+    coefficients_to_boundary(j, j) = fallingFactorial(j, j);
+
+    for (int k = j; k < 2 * Derivative; ++k) {
+      coefficients_to_boundary(Derivative + j, k) = fallingFactorial(k, j);
+    }
+  }
+
+  _boundary_to_coefficients = coefficients_to_boundary.inverse();
+
+  // Higher derivatives, which need to be continuous at the waypoints
+  ContinuityRows at_start = ContinuityRows::Zero();
+  ContinuityRows at_end = ContinuityRows::Zero();
+
+  for (int i = 0; i < kNumFree; ++i) {
+    const int derivative = Derivative + i;
+    at_start(i, derivative) = fallingFactorial(derivative, derivative);
+
+    for (int k = derivative; k < 2 * Derivative; ++k) {
+      at_end(i, k) = fallingFactorial(k, derivative);
+    }
+  }
+
+  _start_continuity = at_start * _boundary_to_coefficients;
+  _end_continuity = at_end * _boundary_to_coefficients;
+}
+
+template<int Derivative>
+void MinimumDerivativeTrajectoryGenerator<Derivative>::generate(
+  const std::vector<Waypoint> & waypoints, PolynomialTrajectory & trajectory)
+{
+  if (waypoints.size() < 2 || waypoints.size() > kMaxNumWaypoints) {
+    throw std::runtime_error("Invalid number of waypoints");
+  }
+
+  _yaw_enabled = std::all_of(
+    waypoints.begin(), waypoints.end(), [](const Waypoint & waypoint) {
+      return std::isfinite(waypoint.yaw_ned_rad);
+    });
+  _num_points = 0;
+
+  for (const Waypoint & waypoint : waypoints) {
+    addPoint(waypoint.position_ned_m, waypoint.yaw_ned_rad);
+
+    if (_num_points > 1) {
+      addSegmentDuration(waypoint.duration_s);
+    }
+  }
+
+  solve(trajectory);
+}
+
+template<int Derivative>
+void MinimumDerivativeTrajectoryGenerator<Derivative>::generate(
+  const TrajectorySample & start, const std::vector<Waypoint> & waypoints,
+  PolynomialTrajectory & trajectory)
+{
+  if (waypoints.empty() || waypoints.size() > kMaxNumWaypoints - 1) {
+    throw std::runtime_error("Invalid number of waypoints");
+  }
+
+  _yaw_enabled = std::isfinite(start.yaw_ned_rad) && std::all_of(
+    waypoints.begin(), waypoints.end(), [](const Waypoint & waypoint) {
+      return std::isfinite(waypoint.yaw_ned_rad);
+    });
+  _num_points = 0;
+  addPoint(start.position_ned_m, start.yaw_ned_rad);
+
+  State & start_state = _states[0];
+
+  for (int axis = 0; axis < 3; ++axis) {
+    start_state(1, axis) = finiteOrZero(start.velocity_ned_m_s(axis));
+
+    if constexpr (Derivative >= 3) {
+      start_state(2, axis) = finiteOrZero(start.acceleration_ned_m_s2(axis));
+    }
+  }
+
+  if (_yaw_enabled) {
+    start_state(1, 3) = finiteOrZero(start.yaw_rate_ned_rad_s);
+  }
+
+  for (const Waypoint & waypoint : waypoints) {
+    addPoint(waypoint.position_ned_m, waypoint.yaw_ned_rad);
+    addSegmentDuration(waypoint.duration_s);
+  }
+
+  solve(trajectory);
+}
+
+template<int Derivative>
+void MinimumDerivativeTrajectoryGenerator<Derivative>::addPoint(
+  const Eigen::Vector3f & position_ned_m, float yaw_ned_rad)
+{
+  State & state = _states[_num_points];
+  state.setZero();
+  state.template block<1, 3>(0, 0) = position_ned_m.cast<double>().transpose();
+
+  if (_yaw_enabled) {
+    // Take the shortest way to the next yaw
+    state(0, 3) = _num_points == 0 ? yaw_ned_rad : _states[_num_points - 1](0, 3) +
+      wrapPi(static_cast<double>(yaw_ned_rad) - _states[_num_points - 1](0, 3));
+  }
+
+  ++_num_points;
+}
+
+template<int Derivative>
+void MinimumDerivativeTrajectoryGenerator<Derivative>::addSegmentDuration(float duration_s)
+{
+  double & duration = _durations[_num_points - 2];
+
+  if (std::isfinite(duration_s) && duration_s > 0.f) {
+    duration = duration_s;
+    return;
+  }
+
+  // Rest-to-rest time with a trapezoidal velocity profile
+  const State & from = _states[_num_points - 2];
+  const State & to = _states[_num_points - 1];
+  const double distance = (to.template block<1, 3>(0, 0) - from.template block<1, 3>(0, 0)).norm();
+  const double max_velocity = _settings.max_velocity_m_s;
+  const double max_acceleration = _settings.max_acceleration_m_s2;
+
+  if (distance < max_velocity * max_velocity / max_acceleration) {
+    duration = 2. * std::sqrt(distance / max_acceleration);
+
+  } else {
+    duration = distance / max_velocity + max_velocity / max_acceleration;
+  }
+
+  duration = std::max(duration, std::abs(to(0, 3) - from(0, 3)) / _settings.max_yaw_rate_rad_s);
+  duration = std::max(duration, static_cast<double>(_settings.min_segment_duration_s));
+}
+
+template<int Derivative>
+typename MinimumDerivativeTrajectoryGenerator<Derivative>::ContinuityRows
+MinimumDerivativeTrajectoryGenerator<Derivative>::scaledContinuity(
+  const ContinuityRows & unit_continuity, double duration) const
+{
+  // With t = tau * T, the i-th derivative scales with T^-i
+  ContinuityRows continuity = unit_continuity;
+  double scale = std::pow(duration, -Derivative);
+
+  for (int i = 0; i < kNumFree; ++i) {
+    continuity.row(i) *= scale;
+    scale /= duration;
+  }
+
+  scale = 1.;
+
+  for (int j = 0; j < Derivative; ++j) {
+    continuity.col(j) *= scale;
+    continuity.col(Derivative + j) *= scale;
+    scale *= duration;
+  }
+
+  return continuity;
+}
+
+template<int Derivative>
+void MinimumDerivativeTrajectoryGenerator<Derivative>::solve(PolynomialTrajectory & trajectory)
+{
+  const int last = _num_points - 1;
+
+  auto free_state = [this](int point) {
+      return _states[point].template bottomRows<kNumFree>();
+    };
+
+  // Forward elimination. The equations for interior point k require the derivatives
+  // Derivative..2*Derivative-2 at the end of segment k-1 to equal the ones at the start of segment k.
+  for (int k = 1; k < last; ++k) {
+    const ContinuityRows end = scaledContinuity(_end_continuity, _durations[k - 1]);
+    const ContinuityRows start = scaledContinuity(_start_continuity, _durations[k]);
+
+    const Block lower = end.template block<kNumFree, kNumFree>(0, 1);
+    Block diagonal = end.template block<kNumFree, kNumFree>(0, Derivative + 1) -
+      start.template block<kNumFree, kNumFree>(0, 1);
+    const Block upper = -start.template block<kNumFree, kNumFree>(0, Derivative + 1);
+    FreeState rhs = -(end.col(0) * _states[k - 1].row(0) +
+      (end.col(Derivative) - start.col(0)) * _states[k].row(0) -
+      start.col(Derivative) * _states[k + 1].row(0));
+
+    if (k == 1) {
+      rhs -= lower * free_state(0);
+
+    } else {
+      const Block factor = lower * _diagonal_inverse[k - 1];
+      diagonal -= factor * _upper[k - 1];
+      rhs -= factor * _rhs[k - 1];
+    }
+
+    if (k == last - 1) {
+      rhs -= upper * free_state(last);
+    }
+
+    _diagonal_inverse[k] = diagonal.inverse();
+    _upper[k] = upper;
+    _rhs[k] = rhs;
+  }
+
+  // Back substitution
+  for (int k = last - 1; k >= 1; --k) {
+    FreeState rhs = _rhs[k];
+
+    if (k < last - 1) {
+      rhs -= _upper[k] * free_state(k + 1);
+    }
+
+    free_state(k) = _diagonal_inverse[k] * rhs;
+  }
+
+  trajectory.clear();
+  trajectory.reserve(kMaxNumWaypoints - 1);
+  trajectory.setYawEnabled(_yaw_enabled);
+
+  for (int i = 0; i < last; ++i) {
+    const double duration = _durations[i];
+    Eigen::Matrix<double, 2 * Derivative, kNumAxes> boundary;
+    boundary.template topRows<Derivative>() = _states[i];
+    boundary.template bottomRows<Derivative>() = _states[i + 1];
+
+    double scale = 1.;
+
+    for (int j = 0; j < Derivative; ++j) {
+      boundary.row(j) *= scale;
+      boundary.row(Derivative + j) *= scale;
+      scale *= duration;
+    }
+
+    Eigen::Matrix<double, 2 * Derivative, kNumAxes> unit_coefficients =
+      _boundary_to_coefficients * boundary;
+    scale = 1.;
+
+    for (int k = 0; k < 2 * Derivative; ++k) {
+      unit_coefficients.row(k) *= scale;
+      scale /= duration;
+    }
+
+    PolynomialTrajectory::Coefficients coefficients = PolynomialTrajectory::Coefficients::Zero();
+    coefficients.template leftCols<2 * Derivative>() = unit_coefficients.transpose();
+    trajectory.addSegment(duration, coefficients);
+  }
+}
+
+template class MinimumDerivativeTrajectoryGenerator<2>;
+template class MinimumDerivativeTrajectoryGenerator<3>;
+template class MinimumDerivativeTrajectoryGenerator<4>;
+
+} // namespace px4_ros2
@@ -0,0 +1,95 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <px4_ros2/control/trajectory/polynomial_trajectory.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace px4_ros2
+{
+
+void PolynomialTrajectory::clear()
+{
+  _segments.clear();
+  _last_segment = 0;
+}
+
+void PolynomialTrajectory::addSegment(double duration_s, const Coefficients & coefficients)
+{
+  if (!(duration_s > 0.)) {
+    throw std::runtime_error("Segment duration must be positive");
+  }
+
+  _segments.push_back(Segment{duration(), duration_s, coefficients});
+}
+
+double PolynomialTrajectory::duration() const
+{
+  return _segments.empty() ? 0. : _segments.back().start_time + _segments.back().duration;
+}
+
+size_t PolynomialTrajectory::findSegment(double time_s) const
+{
+  // Typically sampled with increasing time: check the last and next segment first
+  for (size_t i = _last_segment; i < std::min(_last_segment + 2, _segments.size()); ++i) {
+    if (time_s >= _segments[i].start_time &&
+      time_s < _segments[i].start_time + _segments[i].duration)
+    {
+      _last_segment = i;
+      return i;
+    }
+  }
+
+  const auto iter = std::upper_bound(
+    _segments.begin(), _segments.end(), time_s, [](double time, const Segment & segment) {
+      return time < segment.start_time;
+    });
+  _last_segment = iter == _segments.begin() ? 0 : static_cast<size_t>(iter - _segments.begin()) - 1;
+  return _last_segment;
+}
+
+TrajectorySample PolynomialTrajectory::sample(double time_s) const
+{
+  TrajectorySample sample;
+
+  if (_segments.empty()) {
+    return sample;
+  }
+
+  const bool after_end = time_s >= duration();
+  const size_t index = after_end ? _segments.size() - 1 : findSegment(std::max(time_s, 0.));
+  const Segment & segment = _segments[index];
+  const double t = after_end ? segment.duration : std::max(time_s - segment.start_time, 0.);
+
+  // Basis for the value, first and second derivative: t^k, k t^(k-1), k (k-1) t^(k-2)
+  Eigen::Matrix<double, kNumCoefficients, 3> basis;
+  basis.row(0) << 1., 0., 0.;
+  basis.row(1) << t, 1., 0.;
+
+  for (int k = 2; k < kNumCoefficients; ++k) {
+    basis(k, 0) = basis(k - 1, 0) * t;
+    basis(k, 1) = k * basis(k - 1, 0);
+    basis(k, 2) = k * (k - 1) * basis(k - 2, 0);
+  }
+
+  const Eigen::Matrix<double, kNumAxes, 3> values = segment.coefficients * basis;
+
+  sample.position_ned_m = values.block<3, 1>(0, 0).cast<float>();
+
+  if (!after_end) {
+    sample.velocity_ned_m_s = values.block<3, 1>(0, 1).cast<float>();
+    sample.acceleration_ned_m_s2 = values.block<3, 1>(0, 2).cast<float>();
+  }
+
+  if (_yaw_enabled) {
+    sample.yaw_ned_rad = static_cast<float>(values(3, 0));
+    sample.yaw_rate_ned_rad_s = after_end ? 0.f : static_cast<float>(values(3, 1));
+  }
+
+  return sample;
+}
+
+} // namespace px4_ros2
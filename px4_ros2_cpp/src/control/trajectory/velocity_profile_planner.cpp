@@ -0,0 +1,329 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <px4_ros2/control/trajectory/velocity_profile_planner.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace px4_ros2
+{
+
+VelocityProfilePlanner::VelocityProfilePlanner()
+: VelocityProfilePlanner(Settings{}) {}
+
+VelocityProfilePlanner::VelocityProfilePlanner(const Settings & settings)
+: _settings(settings)
+{
+}
+
+void VelocityProfilePlanner::plan(
+  const std::vector<Eigen::Vector3f> & path_ned_m,
+  float start_speed_m_s)
+{
+  _vertices.clear();
+
+  for (const Eigen::Vector3f & point : path_ned_m) {
+    if (_vertices.empty() || (point - _vertices.back()).norm() > 1e-3f) {
+      _vertices.push_back(point);
+    }
+  }
+
+  if (_vertices.size() < 2) {
+    throw std::runtime_error("Path requires at least 2 distinct waypoints");
+  }
+
+  const size_t num_edges = _vertices.size() - 1;
+  const double infinity = std::numeric_limits<double>::infinity();
+
+  // Corners are rounded with an arc tangential to both edges, starting at the acceptance radius
+  // before the vertex (at most half of each edge). The lateral acceleration on the arc limits the
+  // speed through the whole corner.
+  _corner_tangent_length.assign(_vertices.size(), 0.);
+  std::vector<double> corner_speed_limit(_vertices.size(), infinity);
+
+  for (size_t vertex = 1; vertex < num_edges; ++vertex) {
+    const double cos_angle =
+      std::clamp<double>(edgeDirection(vertex - 1).dot(edgeDirection(vertex)), -1., 1.);
+    const double half_angle = std::acos(cos_angle) / 2.;
+
+    if (half_angle <= 1e-6) {
+      continue;
+    }
+
+    const double tangent_length = std::min<double>(
+      {_settings.corner_acceptance_radius_m, 0.5 * edgeLength(vertex - 1),
+        0.5 * edgeLength(vertex)});
+    const double turn_radius = tangent_length / std::tan(half_angle);
+    const double speed_limit = std::sqrt(_settings.max_acceleration_m_s2 * turn_radius);
+
+    if (speed_limit >= kMinCornerSpeed) {
+      _corner_tangent_length[vertex] = tangent_length;
+      corner_speed_limit[vertex] = speed_limit;
+
+    } else {
+      // Too sharp (e.g. a reversal), stop at the vertex instead
+      corner_speed_limit[vertex] = 0.;
+    }
+  }
+
+  _vertex_arc_length.assign(1, 0.);
+  _arc_length.assign(1, 0.);
+  _speed.assign(1, infinity); // Initialized with the speed limits
+  _edge.clear();
+  _corner.clear();
+  _goto_edge = 0;
+
+  for (size_t edge = 0; edge < num_edges; ++edge) {
+    const double edge_length = edgeLength(edge);
+    const Eigen::Vector3f direction = edgeDirection(edge);
+
+    // Direction-dependent speed limit
+    const double horizontal = direction.head<2>().norm();
+    const double vertical = std::abs(direction.z());
+    const double edge_speed_limit = std::min(
+      horizontal > 1e-6 ? _settings.max_horizontal_speed_m_s / horizontal : infinity,
+      vertical > 1e-6 ? _settings.max_vertical_speed_m_s / vertical : infinity);
+
+    // Parts of the edge: end of the corner at the start vertex, straight part, start of the corner
+    // at the end vertex. Discretizing them separately puts a point at both ends of each arc.
+    const std::array<double, 3> part_end{
+      _corner_tangent_length[edge], edge_length - _corner_tangent_length[edge + 1], edge_length};
+    const std::array<size_t, 3> part_corner{edge, 0, edge + 1};
+    const std::array<double, 3> part_speed_limit{
+      std::min(edge_speed_limit, corner_speed_limit[edge]), edge_speed_limit,
+      std::min(edge_speed_limit, corner_speed_limit[edge + 1])};
+    double part_start = 0.;
+
+    for (size_t part = 0; part < part_end.size(); ++part) {
+      const double part_length = part_end[part] - part_start;
+
+      if (part_length > 1e-6) {
+        const int num_steps =
+          std::max(1, static_cast<int>(std::ceil(part_length / _settings.resolution_m)));
+        // The start point belongs to both parts
+        _speed.back() = std::min(_speed.back(), part_speed_limit[part]);
+
+        for (int step = 1; step <= num_steps; ++step) {
+          const double along =
+            step == num_steps ? part_end[part] : part_start + part_length * step / num_steps;
+          _arc_length.push_back(_vertex_arc_length.back() + along);
+          _speed.push_back(part_speed_limit[part]);
+          _edge.push_back(edge);
+          _corner.push_back(part_corner[part]);
+        }
+      }
+
+      part_start = part_end[part];
+    }
+
+    _vertex_arc_length.push_back(_vertex_arc_length.back() + edge_length);
+    _speed.back() = std::min(_speed.back(), corner_speed_limit[edge + 1]);
+  }
+
+  _edge.push_back(num_edges - 1);
+  _corner.push_back(0);
+
+  const size_t num_points = _arc_length.size();
+  _speed.front() = std::min<double>(_speed.front(), std::max(start_speed_m_s, 0.f));
+  _speed.back() = 0.;
+
+  // Backward pass: ensure the vehicle can slow down for all upcoming limits
+  double acceleration = 0.;
+
+  for (size_t i = num_points - 1; i-- > 0; ) {
+    const double distance = _arc_length[i + 1] - _arc_length[i];
+    _speed[i] = std::min(_speed[i], reachableSpeed(_speed[i + 1], acceleration, distance));
+    acceleration = -stepAcceleration(i);
+  }
+
+  // Forward pass: accelerate as fast as possible
+  acceleration = 0.;
+
+  for (size_t i = 0; i + 1 < num_points; ++i) {
+    const double distance = _arc_length[i + 1] - _arc_length[i];
+    _speed[i + 1] = std::min(_speed[i + 1], reachableSpeed(_speed[i], acceleration, distance));
+    acceleration = stepAcceleration(i);
+  }
+
+  _time.assign(num_points, 0.);
+
+  for (size_t i = 0; i + 1 < num_points; ++i) {
+    const double distance = _arc_length[i + 1] - _arc_length[i];
+    _time[i + 1] = _time[i] + 2. * distance / std::max(_speed[i] + _speed[i + 1], 1e-6);
+  }
+}
+
+double VelocityProfilePlanner::reachableSpeed(
+  double speed, double previous_acceleration,
+  double distance) const
+{
+  const double max_acceleration = _settings.max_acceleration_m_s2;
+  double acceleration = max_acceleration;
+  double next_speed = speed;
+
+  // The step duration depends on the resulting speed, a few iterations are sufficient
+  for (int i = 0; i < 3; ++i) {
+    next_speed = std::sqrt(speed * speed + 2. * acceleration * distance);
+    const double step_duration = 2. * distance / (speed + next_speed);
+    acceleration = std::clamp(
+      previous_acceleration + _settings.max_jerk_m_s3 * step_duration, 0.,
+      max_acceleration);
+  }
+
+  return std::sqrt(speed * speed + 2. * acceleration * distance);
+}
+
+double VelocityProfilePlanner::stepAcceleration(size_t index) const
+{
+  const double distance = _arc_length[index + 1] - _arc_length[index];
+  return (_speed[index + 1] * _speed[index + 1] - _speed[index] * _speed[index]) / (2. * distance);
+}
+
+Eigen::Vector3f VelocityProfilePlanner::edgeDirection(size_t edge) const
+{
+  return (_vertices[edge + 1] - _vertices[edge]).normalized();
+}
+
+float VelocityProfilePlanner::speedAt(double arc_length_m) const
+{
+  if (_arc_length.empty() || arc_length_m >= _arc_length.back()) {
+    return 0.f;
+  }
+
+  if (arc_length_m <= 0.) {
+    return static_cast<float>(_speed.front());
+  }
+
+  // Constant acceleration within a step, i.e. the squared speed is linear in the arc length
+  const size_t index = std::upper_bound(_arc_length.begin(), _arc_length.end(), arc_length_m) -
+    _arc_length.begin() - 1;
+  const double ratio = (arc_length_m - _arc_length[index]) /
+    (_arc_length[index + 1] - _arc_length[index]);
+  const double squared_speed = _speed[index] * _speed[index] * (1. - ratio) +
+    _speed[index + 1] * _speed[index + 1] * ratio;
+  return static_cast<float>(std::sqrt(squared_speed));
+}
+
+void VelocityProfilePlanner::toTrajectory(PolynomialTrajectory & trajectory) const
+{
+  trajectory.clear();
+  trajectory.setYawEnabled(false);
+
+  if (_arc_length.size() < 2) {
+    return;
+  }
+
+  trajectory.reserve(_arc_length.size() - 1);
+
+  for (size_t i = 0; i + 1 < _arc_length.size(); ++i) {
+    const size_t edge = _edge[i];
+    PolynomialTrajectory::Coefficients coefficients = PolynomialTrajectory::Coefficients::Zero();
+
+    if (_corner[i] == 0) {
+      const Eigen::Vector3d direction = edgeDirection(edge).cast<double>();
+      const Eigen::Vector3d start = _vertices[edge].cast<double>() +
+        direction * (_arc_length[i] - _vertex_arc_length[edge]);
+
+      coefficients.block<3, 1>(0, 0) = start;
+      coefficients.block<3, 1>(0, 1) = direction * _speed[i];
+      coefficients.block<3, 1>(0, 2) = direction * (0.5 * stepAcceleration(i));
+      trajectory.addSegment(_time[i + 1] - _time[i], coefficients);
+      continue;
+    }
+
+    // On the arc, the step is a cubic through both end points with the planned velocities, so the
+    // velocity is continuous. The arc is shorter than the corner it replaces, so is the duration.
+    Eigen::Vector3d start;
+    Eigen::Vector3d start_tangent;
+    Eigen::Vector3d end;
+    Eigen::Vector3d end_tangent;
+    const double start_arc = cornerPoint(_corner[i], _arc_length[i], start, start_tangent);
+    const double end_arc = cornerPoint(_corner[i], _arc_length[i + 1], end, end_tangent);
+    const double duration = 2. * (end_arc - start_arc) / std::max(_speed[i] + _speed[i + 1], 1e-6);
+    const Eigen::Vector3d start_velocity = start_tangent * _speed[i];
+    const Eigen::Vector3d end_velocity = end_tangent * _speed[i + 1];
+
+    coefficients.block<3, 1>(0, 0) = start;
+    coefficients.block<3, 1>(0, 1) = start_velocity;
+    coefficients.block<3, 1>(0, 2) =
+      (3. * (end - start) / duration - 2. * start_velocity - end_velocity) / duration;
+    coefficients.block<3, 1>(0, 3) =
+      (2. * (start - end) / duration + start_velocity + end_velocity) / (duration * duration);
+    trajectory.addSegment(duration, coefficients);
+  }
+}
+
+double VelocityProfilePlanner::cornerPoint(
+  size_t vertex, double arc_length, Eigen::Vector3d & position,
+  Eigen::Vector3d & tangent) const
+{
+  const Eigen::Vector3d incoming = edgeDirection(vertex - 1).cast<double>();
+  const Eigen::Vector3d outgoing = edgeDirection(vertex).cast<double>();
+  const double turn_angle = std::acos(std::clamp(incoming.dot(outgoing), -1., 1.));
+  const double tangent_length = _corner_tangent_length[vertex];
+  const double turn_radius = tangent_length / std::tan(turn_angle / 2.);
+
+  // The arc is in the plane of both edges, the normal points to the center
+  const Eigen::Vector3d normal = (outgoing - incoming.dot(outgoing) * incoming).normalized();
+  const Eigen::Vector3d arc_start = _vertices[vertex].cast<double>() - incoming * tangent_length;
+  const Eigen::Vector3d center = arc_start + normal * turn_radius;
+
+  // Map the polyline corner linearly onto the arc
+  const double ratio = std::clamp(
+    (arc_length - _vertex_arc_length[vertex] + tangent_length) / (2. * tangent_length), 0., 1.);
+  const double angle = ratio * turn_angle;
+  position = center + turn_radius * (std::sin(angle) * incoming - std::cos(angle) * normal);
+  tangent = std::cos(angle) * incoming + std::sin(angle) * normal;
+  return angle * turn_radius;
+}
+
+double VelocityProfilePlanner::edgeLength(size_t edge) const
+{
+  return (_vertices[edge + 1] - _vertices[edge]).norm();
+}
+
+VelocityProfilePlanner::GotoConstraints VelocityProfilePlanner::gotoConstraints(
+  const Eigen::Vector3f & vehicle_position_ned_m)
+{
+  if (_vertices.size() < 2) {
+    throw std::runtime_error("No path planned");
+  }
+
+  // Project onto the current or next edge, whichever is closer
+  double arc_length = 0.;
+  float min_distance = std::numeric_limits<float>::infinity();
+  const size_t num_edges = _vertices.size() - 1;
+  const size_t search_start = _goto_edge;
+
+  for (size_t edge = search_start; edge < std::min(search_start + 2, num_edges); ++edge) {
+    const Eigen::Vector3f direction = edgeDirection(edge);
+    const float edge_length =
+      static_cast<float>(_vertex_arc_length[edge + 1] - _vertex_arc_length[edge]);
+    const float along = std::clamp(
+      (vehicle_position_ned_m - _vertices[edge]).dot(direction), 0.f,
+      edge_length);
+    const float distance = (_vertices[edge] + direction * along - vehicle_position_ned_m).norm();
+
+    if (distance <= min_distance) {
+      min_distance = distance;
+      arc_length = _vertex_arc_length[edge] + along;
+      _goto_edge = edge;
+    }
+  }
+
+  const Eigen::Vector3f direction = edgeDirection(_goto_edge);
+  const float speed = speedAt(arc_length);
+  GotoConstraints constraints;
+  constraints.position_ned_m = _vertices[_goto_edge + 1];
+  constraints.max_horizontal_speed_m_s = std::max(speed * direction.head<2>().norm(), kMinGotoSpeed);
+  constraints.max_vertical_speed_m_s = std::max(speed * std::abs(direction.z()), kMinGotoSpeed);
+  return constraints;
+}
+
+} // namespace px4_ros2
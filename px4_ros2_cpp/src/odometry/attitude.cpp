@@ -5,6 +5,8 @@
 
 #include <px4_ros2/odometry/attitude.hpp>
 
+#include <algorithm>
+
 namespace px4_ros2
 {
 
@@ -16,4 +18,37 @@ OdometryAttitude::OdometryAttitude(Context & context)
   context.setRequirement(requirements);
 }
 
+rclcpp::Time OdometryAttitude::sampleTime() const
+{
+  const px4_msgs::msg::VehicleAttitude & att = last();
+
+  if (_time_sync && _time_sync->valid()) {
+    return _time_sync->fmuToRos(att.timestamp_sample);
+  }
+
+  // Only account for the delay on the FMU side
+  return lastTime() - rclcpp::Duration::from_nanoseconds(
+    static_cast<int64_t>(att.timestamp - att.timestamp_sample) * 1000);
+}
+
+Eigen::Quaternionf OdometryAttitude::predictedAttitude(
+  const Eigen::Vector3f & angular_velocity_frd,
+  const rclcpp::Time & time) const
+{
+  const float max_horizon = std::chrono::duration<float>(kMaxPredictionHorizon).count();
+  const float dt =
+    std::min(std::max(static_cast<float>((time - sampleTime()).seconds()), 0.f), max_horizon);
+
+  // Integrate the body rotation over dt
+  const Eigen::Vector3f rotation = angular_velocity_frd * dt;
+  const float angle = rotation.norm();
+
+  if (angle < 1e-6f) {
+    return attitude();
+  }
+
+  const Eigen::Quaternionf delta(Eigen::AngleAxisf(angle, rotation / angle));
+  return (attitude() * delta).normalized();
+}
+
 } // namespace px4_ros2
@@ -5,6 +5,8 @@
 
 #include <px4_ros2/odometry/local_position.hpp>
 
+#include <algorithm>
+
 namespace px4_ros2
 {
 
@@ -17,4 +19,36 @@ OdometryLocalPosition::OdometryLocalPosition(Context & context)
   context.setRequirement(requirements);
 }
 
+rclcpp::Time OdometryLocalPosition::sampleTime() const
+{
+  const px4_msgs::msg::VehicleLocalPosition & pos = last();
+
+  if (_time_sync && _time_sync->valid()) {
+    return _time_sync->fmuToRos(pos.timestamp_sample);
+  }
+
+  // Only account for the delay on the FMU side
+  return lastTime() - rclcpp::Duration::from_nanoseconds(
+    static_cast<int64_t>(pos.timestamp - pos.timestamp_sample) * 1000);
+}
+
+static float predictionHorizon(const rclcpp::Time & sample_time, const rclcpp::Time & time)
+{
+  const float max_horizon =
+    std::chrono::duration<float>(OdometryLocalPosition::kMaxPredictionHorizon).count();
+  return std::min(std::max(static_cast<float>((time - sample_time).seconds()), 0.f), max_horizon);
+}
+
+Eigen::Vector3f OdometryLocalPosition::predictedPositionNed(const rclcpp::Time & time) const
+{
+  const float dt = predictionHorizon(sampleTime(), time);
+  return positionNed() + velocityNed() * dt + 0.5f * accelerationNed() * dt * dt;
+}
+
+Eigen::Vector3f OdometryLocalPosition::predictedVelocityNed(const rclcpp::Time & time) const
+{
+  const float dt = predictionHorizon(sampleTime(), time);
+  return velocityNed() + accelerationNed() * dt;
+}
+
 } // namespace px4_ros2
@@ -0,0 +1,76 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <rclcpp/rclcpp.hpp>
+#if __has_include(<rclcpp/version.h>)
+#include <rclcpp/version.h>
+#endif
+
+// Content filtered topics are available since Humble
+#if defined(RCLCPP_VERSION_MAJOR) && RCLCPP_VERSION_MAJOR >= 16
+#define PX4_ROS2_CONTENT_FILTER_SUPPORTED
+#endif
+
+namespace px4_ros2
+{
+
+/**
+ * Subscription options with a content filter (DDS SQL subset, parameters referenced as %0, %1, ...).
+ *
+ * If the middleware supports content filtering, non-matching messages are dropped before they get
+ * delivered (with DDS typically already on the publisher side). Otherwise all messages are delivered,
+ * so subscribers must still check the content themselves.
+ */
+inline rclcpp::SubscriptionOptions contentFilterOptions(
+  const std::string & expression,
+  const std::vector<std::string> & parameters)
+{
+  rclcpp::SubscriptionOptions options;
+#ifdef PX4_ROS2_CONTENT_FILTER_SUPPORTED
+  options.content_filter_options.filter_expression = expression;
+  options.content_filter_options.expression_parameters = parameters;
+#endif
+  return options;
+}
+
+/**
+ * Change the filter of a subscription created with contentFilterOptions().
+ *
+ * The change reaches the publishers asynchronously, so for a short while messages might still get
+ * filtered with the previous filter. Changes should therefore only narrow the filter, or happen before
+ * messages matching only the new filter are expected.
+ * @return true if the middleware applies the filter
+ */
+inline bool updateContentFilter(
+  rclcpp::SubscriptionBase & subscription, const std::string & expression,
+  const std::vector<std::string> & parameters)
+{
+#ifdef PX4_ROS2_CONTENT_FILTER_SUPPORTED
+
+  if (!subscription.is_cft_enabled()) {
+    return false;
+  }
+
+  try {
+    subscription.set_content_filter(expression, parameters);
+    return true;
+
+  } catch (const std::exception &) {
+    // Not applied, keep relying on the subscriber's own checks
+    return false;
+  }
+
+#else
+  return false;
+#endif
+}
+
+} // namespace px4_ros2
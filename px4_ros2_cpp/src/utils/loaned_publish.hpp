@@ -0,0 +1,79 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <rclcpp/rclcpp.hpp>
+#include <px4_ros2/utils/serialized_message_template.hpp>
+
+namespace px4_ros2
+{
+
+/**
+ * Publish a message that is filled in by a callback.
+ *
+ * If the middleware supports loaning (e.g. with shared memory transport), the message is filled directly
+ * in middleware memory, which avoids copying it on publish. Otherwise it is constructed on the stack.
+ * Either way, the callback gets a value-initialized message.
+ */
+template<typename MessageT, typename FillT>
+void publishLoaned(rclcpp::Publisher<MessageT> & publisher, const FillT & fill)
+{
+  if (publisher.can_loan_messages()) {
+    auto loaned_message = publisher.borrow_loaned_message();
+
+    if (loaned_message.is_valid()) {
+      // The loaned memory is not constructed. As px4_msgs types are trivially destructible, nothing
+      // needs to be destroyed.
+      static_assert(std::is_trivially_destructible_v<MessageT>, "Unsupported message type");
+      MessageT & message = *new (&loaned_message.get()) MessageT{};
+      fill(message);
+      publisher.publish(std::move(loaned_message));
+      return;
+    }
+  }
+
+  MessageT message{};
+  fill(message);
+  publisher.publish(message);
+}
+
+/**
+ * Check if publishing through a SerializedMessageTemplate is possible and useful.
+ *
+ * Loaning avoids the serialization already, and rclcpp does not support publishing serialized
+ * messages on nodes with intra-process communication enabled.
+ */
+template<typename MessageT>
+bool canUseSerializedTemplate(rclcpp::Node & node, const rclcpp::Publisher<MessageT> & publisher)
+{
+  return !publisher.can_loan_messages() &&
+         !node.get_node_options().use_intra_process_comms();
+}
+
+/**
+ * Publish a message through a serialized template if there is one, otherwise like publishLoaned()
+ */
+template<typename MessageT, typename FillT>
+void publishLoaned(
+  rclcpp::Publisher<MessageT> & publisher,
+  SerializedMessageTemplate<MessageT> * serialized_template, const FillT & fill)
+{
+  if (serialized_template) {
+    MessageT message{};
+    fill(message);
+    serialized_template->patch(message);
+    publisher.publish(serialized_template->message());
+    return;
+  }
+
+  publishLoaned(publisher, fill);
+}
+
+} // namespace px4_ros2
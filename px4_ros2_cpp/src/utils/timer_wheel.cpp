@@ -0,0 +1,242 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include "px4_ros2/utils/timer_wheel.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace px4_ros2
+{
+
+TimerWheel::TimerWheel(Clock::duration resolution, Clock::time_point start)
+: _resolution(resolution), _start(start)
+{
+  _slots.fill(kInvalidIndex);
+}
+
+uint64_t TimerWheel::toTick(Clock::time_point time) const
+{
+  if (time <= _start) {
+    return 0;
+  }
+
+  return static_cast<uint64_t>((time - _start) / _resolution);
+}
+
+TimerWheel::Handle TimerWheel::schedule(Clock::time_point deadline, Callback callback)
+{
+  uint32_t index;
+
+  if (_free_list != kInvalidIndex) {
+    index = _free_list;
+    _free_list = _entries[index].next;
+
+  } else {
+    index = static_cast<uint32_t>(_entries.size());
+    _entries.emplace_back();
+  }
+
+  Entry & entry = _entries[index];
+  entry.callback = std::move(callback);
+  // Round up, so a timeout never fires early
+  uint64_t expiry_tick = toTick(deadline);
+
+  if (_start + _resolution * expiry_tick < deadline) {
+    ++expiry_tick;
+  }
+
+  entry.expiry_tick =
+    std::clamp(expiry_tick, _current_tick + 1, _current_tick + kMaxTicks);
+  entry.scheduled = true;
+  insert(index);
+  ++_num_scheduled;
+  return Handle{index, entry.generation};
+}
+
+bool TimerWheel::cancel(Handle & handle)
+{
+  const uint32_t index = handle.index;
+  const uint32_t generation = handle.generation;
+  handle = Handle{};
+
+  if (index >= _entries.size() || _entries[index].generation != generation ||
+    !_entries[index].scheduled)
+  {
+    return false;
+  }
+
+  unlink(index);
+  release(index);
+  return true;
+}
+
+void TimerWheel::insert(uint32_t index)
+{
+  Entry & entry = _entries[index];
+  const uint64_t delta = entry.expiry_tick - _current_tick;
+  int level = 0;
+
+  while (level < kNumLevels - 1 && delta >= (uint64_t{1} << (kSlotBits * (level + 1)))) {
+    ++level;
+  }
+
+  const auto slot_index = static_cast<uint16_t>((entry.expiry_tick >> (kSlotBits * level)) &
+    (kNumSlots - 1));
+  entry.slot = static_cast<uint16_t>(level * kNumSlots + slot_index);
+  entry.prev = kInvalidIndex;
+  entry.next = _slots[entry.slot];
+
+  if (entry.next != kInvalidIndex) {
+    _entries[entry.next].prev = index;
+  }
+
+  _slots[entry.slot] = index;
+}
+
+void TimerWheel::unlink(uint32_t index)
+{
+  Entry & entry = _entries[index];
+
+  if (entry.prev != kInvalidIndex) {
+    _entries[entry.prev].next = entry.next;
+
+  } else {
+    _slots[entry.slot] = entry.next;
+  }
+
+  if (entry.next != kInvalidIndex) {
+    _entries[entry.next].prev = entry.prev;
+  }
+}
+
+void TimerWheel::release(uint32_t index)
+{
+  Entry & entry = _entries[index];
+  entry.callback = nullptr;
+  entry.scheduled = false;
+  ++entry.generation;
+  entry.next = _free_list;
+  _free_list = index;
+  --_num_scheduled;
+}
+
+void TimerWheel::cascade(int level)
+{
+  const auto slot = static_cast<uint16_t>(level * kNumSlots +
+    ((_current_tick >> (kSlotBits * level)) & (kNumSlots - 1)));
+  uint32_t index = _slots[slot];
+  _slots[slot] = kInvalidIndex;
+
+  // Re-insert relative to the current tick, which moves the entries to a lower level
+  while (index != kInvalidIndex) {
+    const uint32_t next = _entries[index].next;
+    insert(index);
+    index = next;
+  }
+}
+
+void TimerWheel::expireSlot(uint16_t slot)
+{
+  // New timeouts scheduled from callbacks expire on a later tick, so they never end up in this slot
+  while (_slots[slot] != kInvalidIndex) {
+    const uint32_t index = _slots[slot];
+    unlink(index);
+    const Callback callback(std::move(_entries[index].callback));
+    release(index);
+    callback();
+  }
+}
+
+void TimerWheel::advance(Clock::time_point now)
+{
+  const uint64_t target_tick = toTick(now);
+
+  while (_current_tick < target_tick) {
+    if (_num_scheduled == 0) {
+      _current_tick = target_tick;
+      break;
+    }
+
+    ++_current_tick;
+
+    // Cascade from the highest level whose lower levels all wrapped around
+    int level = 0;
+
+    while (level < kNumLevels - 1 &&
+      ((_current_tick >> (kSlotBits * (level + 1))) << (kSlotBits * (level + 1))) == _current_tick)
+    {
+      ++level;
+    }
+
+    for (; level > 0; --level) {
+      cascade(level);
+    }
+
+    expireSlot(static_cast<uint16_t>(_current_tick & (kNumSlots - 1)));
+  }
+}
+
+std::shared_ptr<NodeTimerWheel> NodeTimerWheel::forNode(rclcpp::Node & node)
+{
+  static std::mutex mutex;
+  static std::unordered_map<const rclcpp::Node *, std::weak_ptr<NodeTimerWheel>> wheels;
+
+  const std::lock_guard<std::mutex> lock(mutex);
+
+  for (auto iter = wheels.begin(); iter != wheels.end(); ) {
+    if (iter->second.expired()) {
+      iter = wheels.erase(iter);
+
+    } else {
+      ++iter;
+    }
+  }
+
+  std::shared_ptr<NodeTimerWheel> wheel = wheels[&node].lock();
+
+  if (!wheel) {
+    wheel = std::make_shared<NodeTimerWheel>(node);
+    wheels[&node] = wheel;
+  }
+
+  return wheel;
+}
+
+NodeTimerWheel::NodeTimerWheel(rclcpp::Node & node)
+{
+  _timer = node.create_wall_timer(_wheel.resolution(), [this]() {tick();});
+  _timer->cancel();
+}
+
+TimerWheel::Handle NodeTimerWheel::schedule(
+  std::chrono::nanoseconds timeout,
+  TimerWheel::Callback callback)
+{
+  const TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
+
+  if (!_timer_running) {
+    // Catch up on the time the timer was stopped, to avoid firing everything at once on the next tick
+    _wheel.advance(now);
+    _timer->reset();
+    _timer_running = true;
+  }
+
+  return _wheel.schedule(now + timeout, std::move(callback));
+}
+
+void NodeTimerWheel::tick()
+{
+  _wheel.advance(TimerWheel::Clock::now());
+
+  if (_wheel.empty()) {
+    _timer->cancel();
+    _timer_running = false;
+  }
+}
+
+} // namespace px4_ros2
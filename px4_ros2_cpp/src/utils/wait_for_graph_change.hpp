@@ -0,0 +1,51 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+#include <rclcpp/rclcpp.hpp>
+
+namespace px4_ros2
+{
+
+/**
+ * Wait until a condition on the ROS graph (e.g. a matching subscriber or publisher) becomes true.
+ *
+ * This blocks on the node's graph guard condition, so it returns as soon as discovery reports a
+ * change. Endpoint matching can complete after the last graph event, so the condition is also
+ * re-evaluated at least every 100ms.
+ * @param condition callable returning true once the wait is over
+ * @return true if the condition was met before the timeout
+ */
+template<typename ConditionT>
+bool waitForGraphCondition(
+  rclcpp::Node & node, const ConditionT & condition,
+  std::chrono::nanoseconds timeout)
+{
+  static constexpr std::chrono::nanoseconds kMaxWaitSlice = std::chrono::milliseconds(100);
+
+  // Get the event before checking the condition, so we cannot miss a change in between
+  const rclcpp::Event::SharedPtr graph_event = node.get_graph_event();
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+  while (!condition()) {
+    const auto now = std::chrono::steady_clock::now();
+
+    if (now >= deadline || !rclcpp::ok()) {
+      return false;
+    }
+
+    node.wait_for_graph_change(
+      graph_event, std::min<std::chrono::nanoseconds>(deadline - now, kMaxWaitSlice));
+    graph_event->check_and_clear();
+  }
+
+  return true;
+}
+
+} // namespace px4_ros2
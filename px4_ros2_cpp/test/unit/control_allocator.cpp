@@ -0,0 +1,114 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <px4_ros2/control/control_allocator.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+using px4_ros2::ControlAllocator;
+using EffectivenessMatrix = ControlAllocator::EffectivenessMatrix;
+
+namespace
+{
+/**
+ * Quadrotor in X configuration, motors front right, rear left, front left, rear right
+ */
+EffectivenessMatrix quadrotorEffectiveness()
+{
+  static constexpr float kArm = 0.5f;
+  static constexpr float kMomentRatio = 0.05f;
+  const float positions[4][2] = {{kArm, kArm}, {-kArm, -kArm}, {kArm, -kArm}, {-kArm, kArm}};
+  const float directions[4] = {1.f, 1.f, -1.f, -1.f}; // 1: counter-clockwise
+
+  EffectivenessMatrix effectiveness = EffectivenessMatrix::Zero();
+
+  for (int i = 0; i < 4; ++i) {
+    // Torque r x F with F = (0, 0, -1)
+    effectiveness(0, i) = -positions[i][1];
+    effectiveness(1, i) = positions[i][0];
+    effectiveness(2, i) = directions[i] * kMomentRatio;
+    effectiveness(5, i) = -1.f;
+  }
+
+  return effectiveness;
+}
+} // namespace
+
+TEST(ControlAllocator, unsaturated)
+{
+  ControlAllocator allocator(quadrotorEffectiveness(), 4);
+
+  const Eigen::Vector3f thrust{0.f, 0.f, -2.f};
+  const Eigen::Vector3f torque{0.1f, -0.05f, 0.02f};
+  const auto motors = allocator.allocate(thrust, torque);
+
+  for (int i = 0; i < ControlAllocator::kMaxNumActuators; ++i) {
+    if (i < 4) {
+      EXPECT_GE(motors(i), 0.f);
+      EXPECT_LE(motors(i), 1.f);
+
+    } else {
+      EXPECT_TRUE(std::isnan(motors(i)));
+    }
+  }
+
+  // Exactly achieved
+  EXPECT_NEAR((allocator.allocatedControl().head<3>() - torque).norm(), 0.f, 1e-5f);
+  EXPECT_NEAR((allocator.allocatedControl().tail<3>() - thrust).norm(), 0.f, 1e-5f);
+
+  // Hover: all motors equal
+  const auto hover = allocator.allocate(thrust, Eigen::Vector3f::Zero());
+  EXPECT_NEAR((hover.head<4>().array() - 0.5f).matrix().norm(), 0.f, 1e-5f);
+}
+
+TEST(ControlAllocator, yawHasLowestPriority)
+{
+  ControlAllocator allocator(quadrotorEffectiveness(), 4);
+
+  // Roll and yaw cannot both be achieved: roll is kept, yaw reduced
+  const Eigen::Vector3f thrust{0.f, 0.f, -2.f};
+  const Eigen::Vector3f torque{0.4f, 0.f, 0.2f};
+  const auto motors = allocator.allocate(thrust, torque);
+
+  EXPECT_GE(motors.head<4>().minCoeff(), 0.f);
+  EXPECT_LE(motors.head<4>().maxCoeff(), 1.f);
+  EXPECT_NEAR(allocator.allocatedControl()(0), 0.4f, 1e-4f);
+  EXPECT_NEAR(allocator.allocatedControl()(1), 0.f, 1e-4f);
+  EXPECT_LT(allocator.allocatedControl()(2), 0.2f);
+  EXPECT_GT(allocator.allocatedControl()(2), 0.f);
+}
+
+TEST(ControlAllocator, thrustReducedAtSaturation)
+{
+  ControlAllocator allocator(quadrotorEffectiveness(), 4);
+
+  // Full thrust with a roll torque: thrust is reduced to keep the roll torque
+  const auto motors = allocator.allocate({0.f, 0.f, -4.f}, {0.3f, 0.f, 0.f});
+  EXPECT_LE(motors.head<4>().maxCoeff(), 1.f);
+  EXPECT_NEAR(allocator.allocatedControl()(0), 0.3f, 1e-4f);
+  EXPECT_GT(allocator.allocatedControl()(5), -4.f);
+}
+
+TEST(ControlAllocator, weights)
+{
+  // A hexarotor-like redundant setup: two identical motors at the same position share the load
+  // according to their weights
+  EffectivenessMatrix effectiveness = EffectivenessMatrix::Zero();
+  effectiveness(5, 0) = -1.f;
+  effectiveness(5, 1) = -1.f;
+
+  ControlAllocator::Settings settings;
+  settings.weights(1) = 3.f;
+  ControlAllocator allocator(effectiveness, 2, settings);
+  const auto motors = allocator.allocate({0.f, 0.f, -1.f}, Eigen::Vector3f::Zero());
+  EXPECT_NEAR(motors(0), 0.75f, 1e-5f);
+  EXPECT_NEAR(motors(1), 0.25f, 1e-5f);
+
+  settings.weights(1) = 0.f;
+  EXPECT_THROW(ControlAllocator(effectiveness, 2, settings), std::runtime_error);
+  EXPECT_THROW(ControlAllocator(effectiveness, 0), std::runtime_error);
+}
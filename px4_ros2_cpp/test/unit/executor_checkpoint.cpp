@@ -0,0 +1,100 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <px4_ros2/components/executor_checkpoint.hpp>
+
+#include <cstdio>
+#include <fstream>
+
+using px4_ros2::ExecutorCheckpoint;
+
+class ExecutorCheckpointTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    _file_path = testing::TempDir() + "executor_checkpoint_test.bin";
+    std::remove(_file_path.c_str());
+  }
+
+  void TearDown() override
+  {
+    std::remove(_file_path.c_str());
+  }
+
+  std::string _file_path;
+};
+
+TEST_F(ExecutorCheckpointTest, commitAndLoad)
+{
+  ExecutorCheckpoint checkpoint(_file_path, 64);
+  EXPECT_FALSE(checkpoint.load());
+
+  const std::vector<uint8_t> state1{1, 2, 3};
+  const std::vector<uint8_t> state2{4, 5, 6, 7};
+  EXPECT_TRUE(checkpoint.commit(state1.data(), state1.size(), 3));
+  EXPECT_TRUE(checkpoint.commit(state2.data(), state2.size(), 5));
+
+  auto loaded = checkpoint.load();
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->data, state2);
+  EXPECT_EQ(loaded->scheduled_mode_id, 5);
+
+  // Too large
+  const std::vector<uint8_t> large(65);
+  EXPECT_FALSE(checkpoint.commit(large.data(), large.size(), 0));
+  EXPECT_EQ(checkpoint.load()->data, state2);
+
+  checkpoint.clear();
+  EXPECT_FALSE(checkpoint.load());
+}
+
+TEST_F(ExecutorCheckpointTest, persistence)
+{
+  const std::vector<uint8_t> state{42, 43};
+  {
+    ExecutorCheckpoint checkpoint(_file_path, 16);
+    EXPECT_TRUE(checkpoint.commit(state.data(), state.size(), 7));
+  }
+
+  {
+    ExecutorCheckpoint checkpoint(_file_path, 16);
+    auto loaded = checkpoint.load();
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->data, state);
+    EXPECT_EQ(loaded->scheduled_mode_id, 7);
+  }
+
+  // Different capacity: the layout changed, so the checkpoint is discarded
+  ExecutorCheckpoint checkpoint(_file_path, 32);
+  EXPECT_FALSE(checkpoint.load());
+}
+
+TEST_F(ExecutorCheckpointTest, tornWriteFallsBack)
+{
+  const std::vector<uint8_t> state1{1, 1, 1, 1};
+  const std::vector<uint8_t> state2{2, 2, 2, 2};
+  {
+    ExecutorCheckpoint checkpoint(_file_path, 16);
+    EXPECT_TRUE(checkpoint.commit(state1.data(), state1.size(), 1));
+    EXPECT_TRUE(checkpoint.commit(state2.data(), state2.size(), 2));
+  }
+
+  // Corrupt the data of the latest checkpoint (in the second slot)
+  {
+    std::fstream file(_file_path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(0, std::ios::end);
+    const auto size = static_cast<std::streamoff>(file.tellg());
+    file.seekp(size - 16);
+    file.put(static_cast<char>(0xff));
+  }
+
+  ExecutorCheckpoint checkpoint(_file_path, 16);
+  auto loaded = checkpoint.load();
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(loaded->data, state1);
+  EXPECT_EQ(loaded->scheduled_mode_id, 1);
+}
@@ -20,6 +20,12 @@ public:
     setRegistrationDetails(_arming_check_id, _mode_id, _mode_executor_id);
     return true;
   }
+  void requestRegistration(
+    const RegistrationSettings & settings,
+    const RegisterCallback & on_completed) override
+  {
+    on_completed(doRegister(settings));
+  }
   void doUnregister() override {}
 
 private:
@@ -0,0 +1,140 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <px4_ros2/control/geometric_controller.hpp>
+#include <px4_ros2/utils/geometry.hpp>
+
+#include <cmath>
+
+using px4_ros2::GeometricPositionController;
+using px4_ros2::TrajectorySample;
+
+namespace
+{
+GeometricPositionController::State hovering()
+{
+  GeometricPositionController::State state;
+  state.position_ned_m = {1.f, 2.f, -5.f};
+  state.velocity_ned_m_s.setZero();
+  state.attitude.setIdentity();
+  return state;
+}
+
+TrajectorySample reference(const Eigen::Vector3f & position, float yaw)
+{
+  TrajectorySample sample;
+  sample.position_ned_m = position;
+  sample.velocity_ned_m_s.setZero();
+  sample.yaw_ned_rad = yaw;
+  return sample;
+}
+} // namespace
+
+TEST(GeometricPositionController, hover)
+{
+  GeometricPositionController::Settings settings;
+  settings.hover_thrust = 0.4f;
+  GeometricPositionController controller({}, settings);
+  const auto state = hovering();
+  const auto output = controller.update(state, reference(state.position_ned_m, 0.f), 0.01f);
+
+  EXPECT_NEAR(output.attitude.angularDistance(Eigen::Quaternionf::Identity()), 0.f, 1e-5f);
+  EXPECT_NEAR(output.thrust_frd.z(), -0.4f, 1e-5f);
+  EXPECT_FLOAT_EQ(output.thrust_frd.x(), 0.f);
+  EXPECT_FLOAT_EQ(output.thrust_frd.y(), 0.f);
+}
+
+TEST(GeometricPositionController, tiltsTowardsReference)
+{
+  GeometricPositionController controller;
+  const auto state = hovering();
+  const Eigen::Vector3f target = state.position_ned_m + Eigen::Vector3f{0.f, 2.f, 0.f};
+  const auto output = controller.update(state, reference(target, 0.f), 0.01f);
+
+  // The thrust points up and towards east
+  const Eigen::Vector3f thrust_ned = output.attitude * Eigen::Vector3f{0.f, 0.f, -1.f};
+  EXPECT_GT(thrust_ned.y(), 0.1f);
+  EXPECT_NEAR(thrust_ned.x(), 0.f, 1e-5f);
+  EXPECT_LT(thrust_ned.z(), 0.f);
+  EXPECT_NEAR(px4_ros2::quaternionToYaw(output.attitude), 0.f, 1e-5f);
+
+  // Tilting does not change the heading
+  const float yaw = 2.f;
+  const auto rotated = controller.update(state, reference(target, yaw), 0.01f);
+  EXPECT_NEAR(px4_ros2::quaternionToYaw(rotated.attitude), yaw, 1e-4f);
+  const Eigen::Vector3f rotated_thrust_ned = rotated.attitude * Eigen::Vector3f{0.f, 0.f, -1.f};
+  EXPECT_GT(rotated_thrust_ned.y(), 0.1f);
+  EXPECT_NEAR(rotated_thrust_ned.x(), 0.f, 1e-5f);
+}
+
+TEST(GeometricPositionController, feedForward)
+{
+  GeometricPositionController controller;
+  const auto state = hovering();
+  auto sample = reference(state.position_ned_m, 0.f);
+  sample.acceleration_ned_m_s2 = {GeometricPositionController::kGravity * 0.5f, 0.f, 0.f};
+  sample.yaw_rate_ned_rad_s = 0.3f;
+  const auto output = controller.update(state, sample, 0.01f);
+
+  const Eigen::Vector3f thrust_ned = output.attitude * Eigen::Vector3f{0.f, 0.f, -1.f};
+  EXPECT_NEAR(std::atan2(thrust_ned.x(), -thrust_ned.z()), std::atan(0.5f), 1e-4f);
+  EXPECT_FLOAT_EQ(output.yaw_rate_rad_s, 0.3f);
+}
+
+TEST(GeometricPositionController, tiltLimit)
+{
+  GeometricPositionController::Settings settings;
+  settings.max_tilt_rad = 0.3f;
+  GeometricPositionController controller({}, settings);
+  const auto state = hovering();
+  const Eigen::Vector3f target = state.position_ned_m + Eigen::Vector3f{-50.f, 50.f, 0.f};
+  const auto output = controller.update(state, reference(target, NAN), 0.01f);
+
+  const Eigen::Vector3f body_z = output.attitude * Eigen::Vector3f::UnitZ();
+  EXPECT_NEAR(std::acos(body_z.z()), 0.3f, 1e-4f);
+  EXPECT_NEAR(body_z.x(), body_z.y() * -1.f, 1e-5f);
+}
+
+TEST(GeometricPositionController, thrustProjection)
+{
+  GeometricPositionController controller;
+  auto state = hovering();
+  state.attitude = px4_ros2::eulerRpyToQuaternion(0.5f, 0.f, 0.f);
+  const auto output = controller.update(state, reference(state.position_ned_m, 0.f), 0.01f);
+
+  // Level setpoint, but the thrust only accounts for the current body z-axis
+  EXPECT_NEAR(output.attitude.angularDistance(Eigen::Quaternionf::Identity()), 0.f, 1e-5f);
+  EXPECT_NEAR(output.thrust_frd.z(), -0.5f * std::cos(0.5f), 1e-5f);
+}
+
+TEST(GeometricPositionController, integrator)
+{
+  GeometricPositionController::Gains gains;
+  gains.integral = {1.f, 1.f, 1.f};
+  gains.integrator_limit = {0.5f, 0.5f, 0.5f};
+  GeometricPositionController controller(gains, {});
+  const auto state = hovering();
+  const auto sample = reference(state.position_ned_m + Eigen::Vector3f{0.f, 0.f, -1.f}, 0.f);
+
+  const float initial_thrust = -controller.update(state, sample, 0.01f).thrust_frd.z();
+  EXPECT_NEAR(controller.integral().z(), 0.01f, 1e-6f);
+
+  float thrust = initial_thrust;
+
+  for (int i = 0; i < 100; ++i) {
+    thrust = -controller.update(state, sample, 0.01f).thrust_frd.z();
+  }
+
+  EXPECT_GT(thrust, initial_thrust);
+  EXPECT_FLOAT_EQ(controller.integral().z(), 0.5f);
+
+  // Invalid time steps are ignored
+  controller.update(state, sample, 1.f);
+  EXPECT_FLOAT_EQ(controller.integral().z(), 0.5f);
+
+  controller.reset();
+  EXPECT_TRUE(controller.integral().isZero());
+}
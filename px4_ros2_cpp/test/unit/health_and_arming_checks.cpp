@@ -0,0 +1,222 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <rclcpp/rclcpp.hpp>
+#include <px4_msgs/msg/register_ext_component_reply.hpp>
+#include <px4_msgs/msg/register_ext_component_request.hpp>
+#include <px4_msgs/msg/unregister_ext_component.hpp>
+#include <px4_msgs/msg/vehicle_status.hpp>
+#include <px4_ros2/components/mode.hpp>
+#include <px4_ros2/control/setpoint_types/experimental/rates.hpp>
+#include <src/components/registration.hpp>
+#include "spin_util.hpp"
+
+#include <cstring>
+#include <vector>
+
+using px4_msgs::msg::RegisterExtComponentReply;
+using px4_msgs::msg::RegisterExtComponentRequest;
+using px4_msgs::msg::VehicleStatus;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr uint8_t kInitialModeId = 100;
+constexpr uint8_t kReregisteredModeId = 101;
+
+/**
+ * The initial registration blocks without spinning, so it cannot be answered by the fake FMU below.
+ * Registering again after a loss of the FMU goes through the real requests.
+ */
+class InitiallyFakeRegistration : public Registration
+{
+public:
+  explicit InitiallyFakeRegistration(rclcpp::Node & node)
+  : Registration(node)
+  {}
+
+  bool doRegister(const RegistrationSettings & settings) override
+  {
+    setRegistrationDetails(1, kInitialModeId, -1);
+    return true;
+  }
+};
+
+class TestMode : public px4_ros2::ModeBase
+{
+public:
+  explicit TestMode(rclcpp::Node & node)
+  : ModeBase(node, std::string("test"))
+  {
+    _rates_setpoint = std::make_shared<px4_ros2::RatesSetpointType>(*this);
+    setSkipMessageCompatibilityCheck();
+    overrideRegistration(std::make_shared<InitiallyFakeRegistration>(node));
+    px4_ros2::HealthAndArmingChecks::FmuLossSettings fmu_loss_settings{};
+    fmu_loss_settings.timeout = 200ms;
+    setFmuLossSettings(fmu_loss_settings);
+  }
+
+  void onActivate() override {++num_activations;}
+  void onDeactivate() override {++num_deactivations;}
+
+  int num_activations{0};
+  int num_deactivations{0};
+
+private:
+  std::shared_ptr<px4_ros2::RatesSetpointType> _rates_setpoint;
+};
+
+} // namespace
+
+class FmuLossTest : public testing::Test
+{
+protected:
+  FmuLossTest()
+  : _node("test_node"), _mode(_node)
+  {
+    _vehicle_status_pub = _node.create_publisher<VehicleStatus>("fmu/out/vehicle_status", 1);
+    _register_reply_pub = _node.create_publisher<RegisterExtComponentReply>(
+      "fmu/out/register_ext_component_reply", 1);
+    _register_request_sub = _node.create_subscription<RegisterExtComponentRequest>(
+      "fmu/in/register_ext_component_request", rclcpp::QoS(10),
+      [this](RegisterExtComponentRequest::UniquePtr msg) {
+        _register_requests.push_back(*msg);
+
+        if (_reply_to_requests) {
+          reply(*msg);
+        }
+      });
+    _unregister_sub = _node.create_subscription<px4_msgs::msg::UnregisterExtComponent>(
+      "fmu/in/unregister_ext_component", rclcpp::QoS(10),
+      [this](px4_msgs::msg::UnregisterExtComponent::UniquePtr msg) {++_num_unregistered;});
+  }
+
+  void reply(const RegisterExtComponentRequest & request)
+  {
+    RegisterExtComponentReply reply{};
+    reply.request_id = request.request_id;
+    std::memcpy(reply.name.data(), request.name.data(), reply.name.size());
+    reply.px4_ros2_api_version = request.px4_ros2_api_version;
+    reply.success = true;
+    reply.arming_check_id = 2;
+    reply.mode_id = kReregisteredModeId;
+    reply.mode_executor_id = -1;
+    _register_reply_pub->publish(reply);
+  }
+
+  void publishVehicleStatus(uint8_t nav_state)
+  {
+    VehicleStatus status{};
+    status.nav_state = nav_state;
+    status.arming_state = VehicleStatus::ARMING_STATE_ARMED;
+    _vehicle_status_pub->publish(status);
+  }
+
+  /**
+   * Spin while the FMU keeps publishing
+   */
+  void spinWithFmu(uint8_t nav_state, std::chrono::milliseconds duration)
+  {
+    const auto end = std::chrono::steady_clock::now() + duration;
+
+    while (std::chrono::steady_clock::now() < end) {
+      publishVehicleStatus(nav_state);
+      spinFor(_node, 20ms);
+    }
+  }
+
+  void registerAndLoseFmu()
+  {
+    ASSERT_TRUE(_mode.doRegister());
+    spinWithFmu(kInitialModeId, 100ms);
+    ASSERT_EQ(_mode.num_activations, 1);
+    ASSERT_TRUE(spinUntil(_node, [this]() {return _mode.fmuLost();}, 1s));
+  }
+
+  rclcpp::Node _node;
+  TestMode _mode;
+  rclcpp::Publisher<VehicleStatus>::SharedPtr _vehicle_status_pub;
+  rclcpp::Publisher<RegisterExtComponentReply>::SharedPtr _register_reply_pub;
+  rclcpp::Subscription<RegisterExtComponentRequest>::SharedPtr _register_request_sub;
+  rclcpp::Subscription<px4_msgs::msg::UnregisterExtComponent>::SharedPtr _unregister_sub;
+  std::vector<RegisterExtComponentRequest> _register_requests;
+  bool _reply_to_requests{true};
+  int _num_unregistered{0};
+};
+
+TEST_F(FmuLossTest, lossDetected)
+{
+  ASSERT_TRUE(_mode.doRegister());
+
+  // Regular messages keep the registration alive, for longer than the timeout
+  spinWithFmu(kInitialModeId, 400ms);
+  EXPECT_FALSE(_mode.fmuLost());
+  EXPECT_TRUE(_mode.isActive());
+
+  ASSERT_TRUE(spinUntil(_node, [this]() {return _mode.fmuLost();}, 1s));
+  EXPECT_FALSE(_mode.isActive());
+  EXPECT_EQ(_mode.num_deactivations, 1);
+
+  // The FMU forgot about the registration, and nothing is sent until it is back
+  spinFor(_node, 100ms);
+  EXPECT_EQ(_num_unregistered, 0);
+  EXPECT_TRUE(_register_requests.empty());
+}
+
+TEST_F(FmuLossTest, reregistration)
+{
+  registerAndLoseFmu();
+
+  publishVehicleStatus(kInitialModeId);
+  ASSERT_TRUE(spinUntil(_node, [this]() {return !_mode.fmuLost();}));
+  ASSERT_EQ(_register_requests.size(), 1u);
+  EXPECT_STREQ(reinterpret_cast<const char *>(_register_requests[0].name.data()), "test");
+  EXPECT_TRUE(_register_requests[0].register_arming_check);
+  EXPECT_TRUE(_register_requests[0].register_mode);
+  EXPECT_FALSE(_register_requests[0].register_mode_executor);
+
+  // The FMU might assign a different id after a reboot
+  EXPECT_EQ(_mode.id(), kReregisteredModeId);
+  EXPECT_FALSE(_mode.isActive());
+  spinWithFmu(kReregisteredModeId, 100ms);
+  EXPECT_TRUE(_mode.isActive());
+  EXPECT_EQ(_mode.num_activations, 2);
+
+  // Detected again
+  ASSERT_TRUE(spinUntil(_node, [this]() {return _mode.fmuLost();}, 1s));
+  EXPECT_FALSE(_mode.isActive());
+}
+
+TEST_F(FmuLossTest, reregistrationDoesNotBlock)
+{
+  registerAndLoseFmu();
+  _reply_to_requests = false;
+
+  int num_vehicle_status = 0;
+  auto vehicle_status_sub = _node.create_subscription<VehicleStatus>(
+    "fmu/out/vehicle_status", rclcpp::QoS(1),
+    [&num_vehicle_status](VehicleStatus::UniquePtr msg) {++num_vehicle_status;});
+
+  publishVehicleStatus(kInitialModeId);
+  ASSERT_TRUE(spinUntil(_node, [this]() {return !_register_requests.empty();}));
+
+  // Other callbacks keep running while waiting for the reply
+  const int num_vehicle_status_before = num_vehicle_status;
+  publishVehicleStatus(kInitialModeId);
+  ASSERT_TRUE(
+    spinUntil(
+      _node, [&]() {return num_vehicle_status > num_vehicle_status_before;}, 200ms));
+  EXPECT_TRUE(_mode.fmuLost());
+  EXPECT_EQ(_register_requests.size(), 1u);
+
+  // The unanswered request is repeated, with the same id
+  _reply_to_requests = true;
+  ASSERT_TRUE(spinUntil(_node, [this]() {return !_mode.fmuLost();}, 3s));
+  ASSERT_EQ(_register_requests.size(), 2u);
+  EXPECT_EQ(_register_requests[0].request_id, _register_requests[1].request_id);
+  EXPECT_EQ(_mode.id(), kReregisteredModeId);
+}
@@ -0,0 +1,164 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <rclcpp/rclcpp.hpp>
+#include <px4_ros2/components/link_latency_probe.hpp>
+#include "spin_util.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using px4_msgs::msg::MessageFormatRequest;
+using px4_msgs::msg::MessageFormatResponse;
+using px4_ros2::LatencyWindow;
+using px4_ros2::LinkLatencyProbe;
+using std::chrono::microseconds;
+using namespace std::chrono_literals;
+
+TEST(LatencyWindow, percentiles)
+{
+  LatencyWindow window(100);
+  EXPECT_EQ(window.percentile(50.f), microseconds{0});
+  EXPECT_EQ(window.lossRate(), 0.f);
+
+  // Add in reverse order: 100, 99, ..., 1
+  for (int i = 100; i >= 1; --i) {
+    window.addSample(microseconds{i});
+  }
+
+  EXPECT_EQ(window.numSamples(), 100u);
+  EXPECT_EQ(window.min(), microseconds{1});
+  EXPECT_EQ(window.max(), microseconds{100});
+  EXPECT_EQ(window.percentile(50.f), microseconds{50});
+  EXPECT_EQ(window.percentile(90.f), microseconds{90});
+  EXPECT_EQ(window.percentile(99.f), microseconds{99});
+  EXPECT_EQ(window.percentile(99.5f), microseconds{100});
+}
+
+TEST(LatencyWindow, slidingWithLosses)
+{
+  LatencyWindow window(4);
+  window.addSample(microseconds{1000});
+  window.addLoss();
+  window.addSample(microseconds{10});
+  window.addSample(microseconds{20});
+  EXPECT_EQ(window.numSamples(), 3u);
+  EXPECT_FLOAT_EQ(window.lossRate(), 0.25f);
+  EXPECT_EQ(window.max(), microseconds{1000});
+
+  // Pushes out the 1000us sample
+  window.addSample(microseconds{30});
+  EXPECT_EQ(window.numSamples(), 3u);
+  EXPECT_EQ(window.max(), microseconds{30});
+  EXPECT_EQ(window.percentile(50.f), microseconds{20});
+
+  // Pushes out the loss
+  window.addSample(microseconds{40});
+  EXPECT_EQ(window.numSamples(), 4u);
+  EXPECT_FLOAT_EQ(window.lossRate(), 0.f);
+
+  window.clear();
+  EXPECT_EQ(window.numSamples(), 0u);
+  EXPECT_EQ(window.max(), microseconds{0});
+}
+
+class LinkLatencyProbeTest : public testing::Test
+{
+protected:
+  LinkLatencyProbeTest()
+  : _node("test_node"), _context(_node)
+  {
+    _request_sub = _node.create_subscription<MessageFormatRequest>(
+      "fmu/in/message_format_request", rclcpp::QoS(10),
+      [this](MessageFormatRequest::UniquePtr msg) {
+        _requests.push_back(*msg);
+
+        if (_respond_immediately) {
+          respond(msg->topic_name);
+        }
+      });
+    _response_pub = _node.create_publisher<MessageFormatResponse>(
+      "fmu/out/message_format_response", 10);
+  }
+
+  template<typename TopicNameT>
+  void respond(const TopicNameT & topic_name)
+  {
+    MessageFormatResponse response{};
+    response.timestamp = kFmuTimestamp;
+    response.protocol_version = MessageFormatRequest::LATEST_PROTOCOL_VERSION;
+    std::copy(topic_name.begin(), topic_name.end(), response.topic_name.begin());
+    _response_pub->publish(response);
+  }
+
+  void respond(const std::string & topic_name)
+  {
+    respond(std::vector<uint8_t>(topic_name.begin(), topic_name.end()));
+  }
+
+  static constexpr uint64_t kFmuTimestamp = 123456789;
+
+  rclcpp::Node _node;
+  px4_ros2::Context _context;
+  rclcpp::Subscription<MessageFormatRequest>::SharedPtr _request_sub;
+  rclcpp::Publisher<MessageFormatResponse>::SharedPtr _response_pub;
+  std::vector<MessageFormatRequest> _requests;
+  bool _respond_immediately{false};
+};
+
+TEST_F(LinkLatencyProbeTest, roundTrips)
+{
+  _respond_immediately = true;
+  LinkLatencyProbe::Settings settings;
+  settings.interval = 20ms;
+  LinkLatencyProbe probe(_context, settings);
+  int num_updates = 0;
+  probe.onUpdate([&num_updates](const LinkLatencyProbe::Statistics &) {++num_updates;});
+
+  ASSERT_TRUE(spinUntil(_node, [&]() {return probe.statistics().num_samples >= 3;}));
+  EXPECT_EQ(probe.statistics().loss_rate, 0.f);
+  EXPECT_EQ(num_updates, static_cast<int>(probe.statistics().num_samples));
+  EXPECT_EQ(probe.lastResponseFmuTimestamp(), kFmuTimestamp);
+  EXPECT_LE(probe.lastRtt(), probe.statistics().rtt_max);
+
+  // Each probe uses a new topic name
+  ASSERT_GE(_requests.size(), 2u);
+  EXPECT_NE(_requests[0].topic_name, _requests[1].topic_name);
+  EXPECT_EQ(_requests[0].protocol_version, MessageFormatRequest::LATEST_PROTOCOL_VERSION);
+}
+
+TEST_F(LinkLatencyProbeTest, onlyMatchingResponsesCount)
+{
+  LinkLatencyProbe::Settings settings;
+  settings.interval = 100ms;
+  LinkLatencyProbe probe(_context, settings);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return _requests.size() == 1u;}));
+
+  // Response to a request of the message compatibility check
+  respond(std::string("fmu/out/vehicle_status"));
+  spinFor(_node, 10ms);
+  EXPECT_EQ(probe.statistics().num_samples, 0u);
+
+  // Not answered until the next probe: lost
+  ASSERT_TRUE(spinUntil(_node, [&]() {return _requests.size() == 2u;}));
+  EXPECT_EQ(probe.statistics().num_samples, 0u);
+  EXPECT_FLOAT_EQ(probe.statistics().loss_rate, 1.f);
+
+  // A late response to the lost probe is not taken for the current one
+  respond(_requests[0].topic_name);
+  spinFor(_node, 10ms);
+  EXPECT_EQ(probe.statistics().num_samples, 0u);
+
+  respond(_requests[1].topic_name);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return probe.statistics().num_samples == 1u;}));
+  EXPECT_FLOAT_EQ(probe.statistics().loss_rate, 0.5f);
+
+  // Only counted once
+  respond(_requests[1].topic_name);
+  spinFor(_node, 10ms);
+  EXPECT_EQ(probe.statistics().num_samples, 1u);
+}
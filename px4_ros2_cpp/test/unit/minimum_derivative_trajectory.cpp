@@ -0,0 +1,180 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <px4_ros2/control/trajectory/minimum_derivative_trajectory.hpp>
+#include <px4_ros2/utils/geometry.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace px4_ros2;
+
+namespace
+{
+/**
+ * Evaluate the derivative of an axis of a segment at local time t
+ */
+double evaluate(
+  const PolynomialTrajectory & trajectory, size_t segment, int axis, int derivative,
+  double t)
+{
+  const auto & coefficients = trajectory.coefficients(segment);
+  double value = 0.;
+
+  for (int k = derivative; k < PolynomialTrajectory::kNumCoefficients; ++k) {
+    double factor = 1.;
+
+    for (int i = k - derivative + 1; i <= k; ++i) {
+      factor *= i;
+    }
+
+    value += coefficients(axis, k) * factor * std::pow(t, k - derivative);
+  }
+
+  return value;
+}
+
+template<typename Generator>
+std::vector<typename Generator::Waypoint> randomWaypoints(int num_waypoints)
+{
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<float> distribution(-20.f, 20.f);
+  std::vector<typename Generator::Waypoint> waypoints(num_waypoints);
+
+  for (auto & waypoint : waypoints) {
+    waypoint.position_ned_m = {distribution(rng), distribution(rng), distribution(rng)};
+    waypoint.yaw_ned_rad = distribution(rng);
+  }
+
+  return waypoints;
+}
+
+template<int Derivative>
+void checkContinuity(const PolynomialTrajectory & trajectory)
+{
+  for (size_t segment = 0; segment + 1 < trajectory.numSegments(); ++segment) {
+    const double duration = trajectory.segmentDuration(segment);
+
+    for (int axis = 0; axis < PolynomialTrajectory::kNumAxes; ++axis) {
+      for (int derivative = 0; derivative <= 2 * Derivative - 2; ++derivative) {
+        const double end = evaluate(trajectory, segment, axis, derivative, duration);
+        const double start = evaluate(trajectory, segment + 1, axis, derivative, 0.);
+        EXPECT_NEAR(end, start, 1e-6 * std::max(1., std::abs(start))) << "segment " << segment <<
+          " axis " << axis << " derivative " << derivative;
+      }
+    }
+  }
+}
+} // namespace
+
+TEST(MinimumDerivativeTrajectory, singleSegmentMinimumJerk)
+{
+  MinimumJerkTrajectoryGenerator generator;
+  PolynomialTrajectory trajectory;
+  std::vector<MinimumJerkTrajectoryGenerator::Waypoint> waypoints(2);
+  waypoints[1].position_ned_m = {10.f, 0.f, 0.f};
+  waypoints[1].duration_s = 2.f;
+  generator.generate(waypoints, trajectory);
+
+  ASSERT_EQ(trajectory.numSegments(), 1u);
+  EXPECT_FALSE(trajectory.yawEnabled());
+
+  // Closed form: 10 * (10 tau^3 - 15 tau^4 + 6 tau^5)
+  for (const double t : {0., 0.3, 1., 1.7, 2.}) {
+    const double tau = t / 2.;
+    const double expected = 10. * (10. * std::pow(tau, 3) - 15. * std::pow(tau, 4) +
+      6. * std::pow(tau, 5));
+    EXPECT_NEAR(evaluate(trajectory, 0, 0, 0, t), expected, 1e-9);
+  }
+}
+
+TEST(MinimumDerivativeTrajectory, throughWaypoints)
+{
+  MinimumSnapTrajectoryGenerator generator;
+  PolynomialTrajectory trajectory;
+  const auto waypoints = randomWaypoints<MinimumSnapTrajectoryGenerator>(20);
+  generator.generate(waypoints, trajectory);
+
+  ASSERT_EQ(trajectory.numSegments(), waypoints.size() - 1);
+  EXPECT_TRUE(trajectory.yawEnabled());
+  checkContinuity<4>(trajectory);
+
+  double time = 0.;
+
+  for (size_t i = 0; i < waypoints.size(); ++i) {
+    const auto sample = trajectory.sample(time);
+    EXPECT_NEAR((sample.position_ned_m - waypoints[i].position_ned_m).norm(), 0.f, 1e-3f);
+    EXPECT_NEAR(wrapPi(sample.yaw_ned_rad - waypoints[i].yaw_ned_rad), 0.f, 1e-3f);
+
+    if (i + 1 < waypoints.size()) {
+      time += trajectory.segmentDuration(i);
+    }
+  }
+
+  // Starts and ends at rest
+  EXPECT_NEAR(trajectory.sample(0.).velocity_ned_m_s.norm(), 0.f, 1e-4f);
+  EXPECT_NEAR(trajectory.sample(0.).acceleration_ned_m_s2.norm(), 0.f, 1e-4f);
+  EXPECT_NEAR(trajectory.sample(time - 1e-9).velocity_ned_m_s.norm(), 0.f, 1e-3f);
+}
+
+TEST(MinimumDerivativeTrajectory, symmetry)
+{
+  MinimumJerkTrajectoryGenerator generator;
+  PolynomialTrajectory trajectory;
+  std::vector<MinimumJerkTrajectoryGenerator::Waypoint> waypoints(5);
+
+  for (size_t i = 0; i < waypoints.size(); ++i) {
+    waypoints[i].position_ned_m = {static_cast<float>(i), 0.f, 0.f};
+    waypoints[i].duration_s = 1.f;
+  }
+
+  generator.generate(waypoints, trajectory);
+  checkContinuity<3>(trajectory);
+
+  for (const double t : {0.3, 1.2, 1.9}) {
+    const auto sample = trajectory.sample(t);
+    const auto mirrored = trajectory.sample(4. - t);
+    EXPECT_NEAR(sample.position_ned_m.x(), 4.f - mirrored.position_ned_m.x(), 1e-4f);
+    EXPECT_NEAR(sample.velocity_ned_m_s.x(), mirrored.velocity_ned_m_s.x(), 1e-4f);
+  }
+}
+
+TEST(MinimumDerivativeTrajectory, replanFromState)
+{
+  MinimumSnapTrajectoryGenerator generator;
+  PolynomialTrajectory trajectory;
+  auto waypoints = randomWaypoints<MinimumSnapTrajectoryGenerator>(10);
+  generator.generate(waypoints, trajectory);
+
+  // Replan from a sampled state through the remaining waypoints
+  const auto state = trajectory.sample(trajectory.segmentDuration(0) * 0.5);
+  waypoints.erase(waypoints.begin());
+  PolynomialTrajectory replanned;
+  generator.generate(state, waypoints, replanned);
+
+  ASSERT_EQ(replanned.numSegments(), waypoints.size());
+  checkContinuity<4>(replanned);
+  const auto start = replanned.sample(0.);
+  EXPECT_NEAR((start.position_ned_m - state.position_ned_m).norm(), 0.f, 1e-4f);
+  EXPECT_NEAR((start.velocity_ned_m_s - state.velocity_ned_m_s).norm(), 0.f, 1e-4f);
+  EXPECT_NEAR((start.acceleration_ned_m_s2 - state.acceleration_ned_m_s2).norm(), 0.f, 1e-3f);
+  EXPECT_NEAR(start.yaw_ned_rad, state.yaw_ned_rad, 1e-4f);
+  EXPECT_NEAR(start.yaw_rate_ned_rad_s, state.yaw_rate_ned_rad_s, 1e-4f);
+}
+
+TEST(MinimumDerivativeTrajectory, invalidInput)
+{
+  MinimumSnapTrajectoryGenerator generator;
+  PolynomialTrajectory trajectory;
+  EXPECT_THROW(
+    generator.generate(randomWaypoints<MinimumSnapTrajectoryGenerator>(1), trajectory),
+    std::runtime_error);
+  EXPECT_THROW(
+    generator.generate(
+      randomWaypoints<MinimumSnapTrajectoryGenerator>(
+        MinimumSnapTrajectoryGenerator::kMaxNumWaypoints + 1), trajectory), std::runtime_error);
+}
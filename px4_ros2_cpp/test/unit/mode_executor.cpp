@@ -0,0 +1,591 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <rclcpp/rclcpp.hpp>
+#include <px4_msgs/msg/mode_completed.hpp>
+#include <px4_msgs/msg/vehicle_command.hpp>
+#include <px4_msgs/msg/vehicle_command_ack.hpp>
+#include <px4_msgs/msg/vehicle_status.hpp>
+#include <px4_ros2/components/executor_checkpoint.hpp>
+#include <px4_ros2/components/mode.hpp>
+#include <px4_ros2/components/mode_executor.hpp>
+#include <px4_ros2/control/setpoint_types/experimental/rates.hpp>
+#include "fake_registration.hpp"
+#include "spin_util.hpp"
+
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+using px4_msgs::msg::VehicleCommand;
+using px4_msgs::msg::VehicleCommandAck;
+using px4_ros2::Result;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr uint32_t kCommand = VehicleCommand::VEHICLE_CMD_DO_SET_MODE;
+constexpr uint32_t kSetNavState = VehicleCommand::VEHICLE_CMD_SET_NAV_STATE;
+
+class TestMode : public px4_ros2::ModeBase
+{
+public:
+  explicit TestMode(rclcpp::Node & node)
+  : ModeBase(node, std::string("test"))
+  {
+    _rates_setpoint = std::make_shared<px4_ros2::RatesSetpointType>(*this);
+  }
+
+  void onActivate() override {}
+  void onDeactivate() override {}
+
+private:
+  std::shared_ptr<px4_ros2::RatesSetpointType> _rates_setpoint;
+};
+
+class TestExecutor : public px4_ros2::ModeExecutorBase
+{
+public:
+  TestExecutor(rclcpp::Node & node, px4_ros2::ModeBase & owned_mode)
+  : ModeExecutorBase(node, Settings{}, owned_mode)
+  {
+    setSkipMessageCompatibilityCheck();
+    overrideRegistration(std::make_shared<FakeRegistration>(node));
+  }
+
+  void onActivate() override {}
+  void onDeactivate(DeactivateReason reason) override {}
+};
+
+constexpr size_t kCheckpointCapacity = 64;
+
+class CheckpointExecutor : public px4_ros2::ModeExecutorBase
+{
+public:
+  CheckpointExecutor(
+    rclcpp::Node & node, px4_ros2::ModeBase & owned_mode,
+    const std::string & checkpoint_file_path)
+  : ModeExecutorBase(node, Settings{}, owned_mode)
+  {
+    setSkipMessageCompatibilityCheck();
+    overrideRegistration(std::make_shared<FakeRegistration>(node));
+    enableCheckpointing(checkpoint_file_path, kCheckpointCapacity);
+  }
+
+  void onActivate() override {++num_activations;}
+  void onDeactivate(DeactivateReason reason) override {}
+
+  bool onResume(
+    const std::vector<uint8_t> & state,
+    px4_ros2::ModeBase::ModeID scheduled_mode_id) override
+  {
+    resumed.emplace_back(state, scheduled_mode_id);
+    return accept_resume;
+  }
+
+  int num_activations{0};
+  std::vector<std::pair<std::vector<uint8_t>, px4_ros2::ModeBase::ModeID>> resumed;
+  bool accept_resume{true};
+};
+
+VehicleCommand command(uint32_t command)
+{
+  VehicleCommand cmd{};
+  cmd.command = command;
+  return cmd;
+}
+
+} // namespace
+
+class ModeExecutorTest : public testing::Test
+{
+protected:
+  ModeExecutorTest()
+  : _node("test_node"), _mode(_node), _executor(_node, _mode)
+  {
+    _command_sub = _node.create_subscription<VehicleCommand>(
+      "fmu/in/vehicle_command_mode_executor", rclcpp::QoS(10),
+      [this](VehicleCommand::UniquePtr msg) {_commands.push_back(*msg);});
+    _ack_pub = _node.create_publisher<VehicleCommandAck>("fmu/out/vehicle_command_ack", 10);
+    _vehicle_status_pub = _node.create_publisher<px4_msgs::msg::VehicleStatus>(
+      "fmu/out/vehicle_status", 1);
+    _mode_completed_pub = _node.create_publisher<px4_msgs::msg::ModeCompleted>(
+      "fmu/out/mode_completed", 1);
+  }
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(_executor.doRegister());
+  }
+
+  void waitForCommands(size_t num_commands)
+  {
+    ASSERT_TRUE(spinUntil(_node, [&]() {return _commands.size() >= num_commands;}));
+  }
+
+  void publishAck(uint32_t command, uint8_t result, uint8_t progress = 0)
+  {
+    VehicleCommandAck ack{};
+    ack.command = command;
+    ack.result = result;
+    ack.result_param1 = progress;
+    ack.target_component = VehicleCommand::COMPONENT_MODE_EXECUTOR_START + _executor.id();
+    _ack_pub->publish(ack);
+  }
+
+  void publishVehicleStatus(
+    bool in_charge,
+    uint8_t failsafe_defer_state = px4_msgs::msg::VehicleStatus::FAILSAFE_DEFER_STATE_DISABLED)
+  {
+    px4_msgs::msg::VehicleStatus status{};
+    status.arming_state = px4_msgs::msg::VehicleStatus::ARMING_STATE_ARMED;
+    status.nav_state = static_cast<uint8_t>(_mode.id());
+    status.executor_in_charge = in_charge ? static_cast<uint8_t>(_executor.id()) : 0;
+    status.failsafe_defer_state = failsafe_defer_state;
+    _vehicle_status_pub->publish(status);
+  }
+
+  void armAndActivate()
+  {
+    publishVehicleStatus(true);
+    ASSERT_TRUE(spinUntil(_node, [&]() {return _executor.isInCharge();}));
+  }
+
+  void publishModeCompleted(px4_ros2::ModeBase::ModeID mode_id, Result result)
+  {
+    px4_msgs::msg::ModeCompleted mode_completed{};
+    mode_completed.nav_state = static_cast<uint8_t>(mode_id);
+    mode_completed.result = static_cast<uint8_t>(result);
+    _mode_completed_pub->publish(mode_completed);
+  }
+
+  rclcpp::Node _node;
+  TestMode _mode;
+  TestExecutor _executor;
+  rclcpp::Subscription<VehicleCommand>::SharedPtr _command_sub;
+  rclcpp::Publisher<VehicleCommandAck>::SharedPtr _ack_pub;
+  rclcpp::Publisher<px4_msgs::msg::VehicleStatus>::SharedPtr _vehicle_status_pub;
+  rclcpp::Publisher<px4_msgs::msg::ModeCompleted>::SharedPtr _mode_completed_pub;
+  std::vector<VehicleCommand> _commands;
+};
+
+TEST_F(ModeExecutorTest, commandInProgressRestartsTimeout)
+{
+  std::optional<Result> result;
+  std::vector<int> progress;
+  px4_ros2::ModeExecutorBase::CommandSettings settings;
+  settings.ack_timeout = 100ms;
+  settings.on_progress = [&](uint8_t percent) {progress.push_back(percent);};
+  _executor.sendCommandAsync(
+    command(kCommand), [&](Result command_result) {result = command_result;}, settings);
+  waitForCommands(1);
+  EXPECT_EQ(
+    _commands[0].source_component,
+    VehicleCommand::COMPONENT_MODE_EXECUTOR_START + _executor.id());
+
+  // Keep the command alive for well beyond the ack timeout
+  for (int i = 1; i <= 4; ++i) {
+    spinFor(_node, 60ms);
+    ASSERT_FALSE(result);
+    publishAck(kCommand, VehicleCommandAck::VEHICLE_CMD_RESULT_IN_PROGRESS, i * 20);
+    ASSERT_TRUE(spinUntil(_node, [&]() {return progress.size() == static_cast<size_t>(i);}));
+  }
+
+  EXPECT_EQ(progress, (std::vector<int>{20, 40, 60, 80}));
+
+  publishAck(kCommand, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return result.has_value();}));
+  EXPECT_EQ(*result, Result::Success);
+}
+
+TEST_F(ModeExecutorTest, commandTimeout)
+{
+  int num_results = 0;
+  std::optional<Result> result;
+  px4_ros2::ModeExecutorBase::CommandSettings settings;
+  settings.ack_timeout = 50ms;
+  const auto start = std::chrono::steady_clock::now();
+  _executor.sendCommandAsync(
+    command(kCommand),
+    [&](Result command_result) {
+      result = command_result;
+      ++num_results;
+    }, settings);
+
+  ASSERT_TRUE(spinUntil(_node, [&]() {return result.has_value();}));
+  EXPECT_EQ(*result, Result::Timeout);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, settings.ack_timeout);
+
+  // A late ack is ignored
+  publishAck(kCommand, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+  spinFor(_node, 20ms);
+  EXPECT_EQ(num_results, 1);
+  EXPECT_EQ(*result, Result::Timeout);
+}
+
+TEST_F(ModeExecutorTest, commandRejected)
+{
+  std::optional<Result> result;
+  _executor.sendCommandAsync(kCommand, [&](Result command_result) {result = command_result;});
+  waitForCommands(1);
+
+  // Acks for other executors are ignored
+  VehicleCommandAck ack{};
+  ack.command = kCommand;
+  ack.target_component = VehicleCommand::COMPONENT_MODE_EXECUTOR_START + _executor.id() + 1;
+  _ack_pub->publish(ack);
+  spinFor(_node, 20ms);
+  EXPECT_FALSE(result);
+
+  publishAck(kCommand, VehicleCommandAck::VEHICLE_CMD_RESULT_DENIED);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return result.has_value();}));
+  EXPECT_EQ(*result, Result::Rejected);
+}
+
+TEST_F(ModeExecutorTest, commandAcksMatchedInOrder)
+{
+  constexpr uint32_t kOtherCommand = VehicleCommand::VEHICLE_CMD_COMPONENT_ARM_DISARM;
+  std::vector<std::pair<int, Result>> results;
+  auto record = [&](int index) {
+      return [&results, index](Result result) {results.emplace_back(index, result);};
+    };
+  _executor.sendCommandAsync(kCommand, record(0));
+  _executor.sendCommandAsync(kCommand, record(1));
+  _executor.sendCommandAsync(kOtherCommand, record(2));
+  waitForCommands(3);
+
+  // Acks of another command do not complete the pending ones of the first
+  publishAck(kOtherCommand, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return results.size() == 1u;}));
+  EXPECT_EQ(results[0], std::make_pair(2, Result::Success));
+
+  publishAck(kCommand, VehicleCommandAck::VEHICLE_CMD_RESULT_DENIED);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return results.size() == 2u;}));
+  EXPECT_EQ(results[1], std::make_pair(0, Result::Rejected));
+
+  publishAck(kCommand, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return results.size() == 3u;}));
+  EXPECT_EQ(results[2], std::make_pair(1, Result::Success));
+}
+
+TEST_F(ModeExecutorTest, commandTimeoutKeepsQueueOrder)
+{
+  std::vector<std::pair<int, Result>> results;
+  px4_ros2::ModeExecutorBase::CommandSettings short_timeout;
+  short_timeout.ack_timeout = 50ms;
+  px4_ros2::ModeExecutorBase::CommandSettings long_timeout;
+  long_timeout.ack_timeout = 1s;
+  _executor.sendCommandAsync(
+    command(kCommand), [&](Result result) {results.emplace_back(0, result);}, long_timeout);
+  _executor.sendCommandAsync(
+    command(kCommand), [&](Result result) {results.emplace_back(1, result);}, short_timeout);
+  _executor.sendCommandAsync(
+    command(kCommand), [&](Result result) {results.emplace_back(2, result);}, long_timeout);
+
+  // The second one times out while the first one is still pending
+  ASSERT_TRUE(spinUntil(_node, [&]() {return results.size() == 1u;}));
+  EXPECT_EQ(results[0], std::make_pair(1, Result::Timeout));
+
+  // The remaining ones still get the acks in order
+  publishAck(kCommand, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+  publishAck(kCommand, VehicleCommandAck::VEHICLE_CMD_RESULT_DENIED);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return results.size() == 3u;}));
+  EXPECT_EQ(results[1], std::make_pair(0, Result::Success));
+  EXPECT_EQ(results[2], std::make_pair(2, Result::Rejected));
+
+  // Nothing left to time out
+  spinFor(_node, 50ms);
+  EXPECT_EQ(results.size(), 3u);
+}
+
+TEST_F(ModeExecutorTest, nestedCommandSync)
+{
+  constexpr uint32_t kOtherCommand = VehicleCommand::VEHICLE_CMD_COMPONENT_ARM_DISARM;
+  std::optional<Result> async_result;
+  std::optional<Result> nested_result;
+  _executor.sendCommandAsync(
+    kOtherCommand, [&](Result result) {
+      async_result = result;
+      nested_result = _executor.sendCommandSync(kCommand);
+    });
+
+  // Queue the acks, so the synchronous calls take them without spinning
+  publishAck(kOtherCommand, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+  publishAck(kCommand, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+  publishAck(kCommand, VehicleCommandAck::VEHICLE_CMD_RESULT_DENIED);
+
+  // The ack of the asynchronous command is taken while blocking, and its callback sends another
+  // command synchronously
+  Result result{Result::Timeout};
+  ASSERT_NO_THROW(result = _executor.sendCommandSync(kCommand));
+  EXPECT_EQ(result, Result::Success);
+  ASSERT_TRUE(async_result);
+  EXPECT_EQ(*async_result, Result::Success);
+  ASSERT_TRUE(nested_result);
+  EXPECT_EQ(*nested_result, Result::Rejected);
+
+  waitForCommands(3);
+  EXPECT_EQ(_commands[0].command, kOtherCommand);
+  EXPECT_EQ(_commands[1].command, kCommand);
+  EXPECT_EQ(_commands[2].command, kCommand);
+}
+
+TEST_F(ModeExecutorTest, modeSequence)
+{
+  armAndActivate();
+  std::optional<Result> result;
+  std::vector<px4_ros2::ModeBase::ModeID> completed_modes;
+  const std::vector<px4_ros2::ModeBase::ModeID> modes{20, 21, 22};
+  _executor.scheduleModeSequence(
+    modes, [&](Result sequence_result) {result = sequence_result;},
+    [&](px4_ros2::ModeBase::ModeID mode_id) {completed_modes.push_back(mode_id);});
+  waitForCommands(1);
+  EXPECT_EQ(_commands[0].command, kSetNavState);
+  EXPECT_FLOAT_EQ(_commands[0].param1, 20.f);
+  publishAck(kSetNavState, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+
+  // Completing a mode directly activates the next one
+  for (size_t i = 0; i + 1 < modes.size(); ++i) {
+    publishModeCompleted(modes[i], Result::Success);
+    waitForCommands(i + 2);
+    EXPECT_FLOAT_EQ(_commands.back().param1, modes[i + 1]);
+    ASSERT_EQ(completed_modes.size(), i + 1);
+    EXPECT_EQ(completed_modes.back(), modes[i]);
+    EXPECT_FALSE(result);
+    publishAck(kSetNavState, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+  }
+
+  // Completion messages of other modes are ignored
+  publishModeCompleted(20, Result::Success);
+  spinFor(_node, 20ms);
+  EXPECT_FALSE(result);
+
+  publishModeCompleted(22, Result::Success);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return result.has_value();}));
+  EXPECT_EQ(*result, Result::Success);
+  EXPECT_EQ(completed_modes, (std::vector<px4_ros2::ModeBase::ModeID>{20, 21}));
+  EXPECT_EQ(_commands.size(), 3u);
+}
+
+TEST_F(ModeExecutorTest, modeSequenceFailure)
+{
+  armAndActivate();
+  std::optional<Result> result;
+  _executor.scheduleModeSequence(
+    {20, 21, 22}, [&](Result sequence_result) {result = sequence_result;});
+  waitForCommands(1);
+  publishAck(kSetNavState, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+  publishModeCompleted(20, Result::Success);
+  waitForCommands(2);
+  publishAck(kSetNavState, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+
+  // A failing mode ends the sequence, the remaining modes are dropped
+  publishModeCompleted(21, Result::ModeFailureOther);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return result.has_value();}));
+  EXPECT_EQ(*result, Result::ModeFailureOther);
+  spinFor(_node, 20ms);
+  EXPECT_EQ(_commands.size(), 2u);
+
+  // A rejected mode command completes the sequence as well
+  result.reset();
+  _executor.scheduleModeSequence(
+    {20, 21}, [&](Result sequence_result) {result = sequence_result;});
+  waitForCommands(3);
+  publishAck(kSetNavState, VehicleCommandAck::VEHICLE_CMD_RESULT_DENIED);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return result.has_value();}));
+  EXPECT_EQ(*result, Result::Rejected);
+  spinFor(_node, 20ms);
+  EXPECT_EQ(_commands.size(), 3u);
+}
+
+TEST_F(ModeExecutorTest, modeSequenceRequiresArming)
+{
+  std::optional<Result> result;
+  _executor.scheduleModeSequence({20, 21}, [&](Result sequence_result) {result = sequence_result;});
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, Result::Rejected);
+
+  result.reset();
+  _executor.scheduleModeSequence({}, [&](Result sequence_result) {result = sequence_result;});
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, Result::Success);
+  spinFor(_node, 20ms);
+  EXPECT_TRUE(_commands.empty());
+}
+
+TEST_F(ModeExecutorTest, deferFailsafesConfirmed)
+{
+  armAndActivate();
+  std::optional<Result> result;
+  _executor.deferFailsafes(true, [&](Result defer_result) {result = defer_result;});
+
+  // Waits for the FMU to confirm
+  publishVehicleStatus(true);
+  spinFor(_node, 20ms);
+  EXPECT_FALSE(result);
+
+  publishVehicleStatus(true, px4_msgs::msg::VehicleStatus::FAILSAFE_DEFER_STATE_ENABLED);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return result.has_value();}));
+  EXPECT_EQ(*result, Result::Success);
+}
+
+TEST_F(ModeExecutorTest, deferFailsafesTimeout)
+{
+  armAndActivate();
+  int num_results = 0;
+  std::optional<Result> result;
+  const auto start = std::chrono::steady_clock::now();
+  _executor.deferFailsafes(
+    true, [&](Result defer_result) {
+      result = defer_result;
+      ++num_results;
+    });
+
+  ASSERT_TRUE(spinUntil(_node, [&]() {return result.has_value();}, 2s));
+  EXPECT_EQ(*result, Result::Timeout);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 1s);
+
+  // A late confirmation is ignored
+  publishVehicleStatus(true, px4_msgs::msg::VehicleStatus::FAILSAFE_DEFER_STATE_ENABLED);
+  spinFor(_node, 20ms);
+  EXPECT_EQ(num_results, 1);
+}
+
+TEST_F(ModeExecutorTest, deferFailsafesInterrupted)
+{
+  armAndActivate();
+  std::optional<Result> first_result;
+  std::optional<Result> second_result;
+  _executor.deferFailsafes(true, [&](Result defer_result) {first_result = defer_result;});
+  _executor.deferFailsafes(true, [&](Result defer_result) {second_result = defer_result;});
+  ASSERT_TRUE(first_result);
+  EXPECT_EQ(*first_result, Result::Interrupted);
+  EXPECT_FALSE(second_result);
+
+  publishVehicleStatus(true, px4_msgs::msg::VehicleStatus::FAILSAFE_DEFER_STATE_ENABLED);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return second_result.has_value();}));
+  EXPECT_EQ(*second_result, Result::Success);
+  EXPECT_EQ(*first_result, Result::Interrupted);
+}
+
+TEST_F(ModeExecutorTest, deferFailsafesDeactivated)
+{
+  armAndActivate();
+  std::optional<Result> result;
+  _executor.deferFailsafes(true, [&](Result defer_result) {result = defer_result;});
+
+  publishVehicleStatus(false);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return result.has_value();}));
+  EXPECT_EQ(*result, Result::Deactivated);
+  EXPECT_FALSE(_executor.isInCharge());
+}
+
+TEST_F(ModeExecutorTest, deferFailsafesImmediateSuccess)
+{
+  // Not in charge
+  std::optional<Result> result;
+  _executor.deferFailsafes(true, [&](Result defer_result) {result = defer_result;});
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, Result::Success);
+
+  // Disabling does not wait for a confirmation
+  armAndActivate();
+  result.reset();
+  _executor.deferFailsafes(false, [&](Result defer_result) {result = defer_result;});
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, Result::Success);
+}
+
+class ModeExecutorCheckpointTest : public testing::Test
+{
+protected:
+  ModeExecutorCheckpointTest()
+  : _node("test_node"), _mode(_node)
+  {
+    _vehicle_status_pub = _node.create_publisher<px4_msgs::msg::VehicleStatus>(
+      "fmu/out/vehicle_status", 1);
+  }
+
+  void SetUp() override
+  {
+    _file_path = testing::TempDir() + "mode_executor_checkpoint_test.bin";
+    std::remove(_file_path.c_str());
+
+    // Left behind by a previous run of the executor
+    px4_ros2::ExecutorCheckpoint checkpoint(_file_path, kCheckpointCapacity);
+    ASSERT_TRUE(checkpoint.commit(_state.data(), _state.size(), kScheduledModeId));
+  }
+
+  void TearDown() override
+  {
+    std::remove(_file_path.c_str());
+  }
+
+  void setInCharge(CheckpointExecutor & executor, bool in_charge)
+  {
+    px4_msgs::msg::VehicleStatus status{};
+    status.arming_state = px4_msgs::msg::VehicleStatus::ARMING_STATE_ARMED;
+    status.nav_state = static_cast<uint8_t>(_mode.id());
+    status.executor_in_charge = in_charge ? static_cast<uint8_t>(executor.id()) : 0;
+    _vehicle_status_pub->publish(status);
+    ASSERT_TRUE(spinUntil(_node, [&]() {return executor.isInCharge() == in_charge;}));
+  }
+
+  static constexpr px4_ros2::ModeBase::ModeID kScheduledModeId = 20;
+  const std::vector<uint8_t> _state{1, 2, 3};
+  rclcpp::Node _node;
+  TestMode _mode;
+  rclcpp::Publisher<px4_msgs::msg::VehicleStatus>::SharedPtr _vehicle_status_pub;
+  std::string _file_path;
+};
+
+TEST_F(ModeExecutorCheckpointTest, resumeOnce)
+{
+  CheckpointExecutor executor(_node, _mode, _file_path);
+  ASSERT_TRUE(executor.doRegister());
+  EXPECT_TRUE(executor.resumed.empty());
+
+  setInCharge(executor, true);
+  ASSERT_EQ(executor.resumed.size(), 1u);
+  EXPECT_EQ(executor.resumed[0].first, _state);
+  EXPECT_EQ(executor.resumed[0].second, kScheduledModeId);
+  EXPECT_EQ(executor.num_activations, 0);
+
+  // Later activations start from scratch
+  setInCharge(executor, false);
+  setInCharge(executor, true);
+  EXPECT_EQ(executor.resumed.size(), 1u);
+  EXPECT_EQ(executor.num_activations, 1);
+}
+
+TEST_F(ModeExecutorCheckpointTest, resumeRejected)
+{
+  CheckpointExecutor executor(_node, _mode, _file_path);
+  executor.accept_resume = false;
+  ASSERT_TRUE(executor.doRegister());
+
+  setInCharge(executor, true);
+  EXPECT_EQ(executor.resumed.size(), 1u);
+  EXPECT_EQ(executor.num_activations, 1);
+}
+
+TEST_F(ModeExecutorCheckpointTest, clearCheckpointBeforeActivation)
+{
+  CheckpointExecutor executor(_node, _mode, _file_path);
+  ASSERT_TRUE(executor.doRegister());
+  executor.clearCheckpoint();
+
+  setInCharge(executor, true);
+  EXPECT_TRUE(executor.resumed.empty());
+  EXPECT_EQ(executor.num_activations, 1);
+
+  // Also removed from the file
+  px4_ros2::ExecutorCheckpoint checkpoint(_file_path, kCheckpointCapacity);
+  EXPECT_FALSE(checkpoint.load());
+}
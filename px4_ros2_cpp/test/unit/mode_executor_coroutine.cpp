@@ -0,0 +1,214 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <rclcpp/rclcpp.hpp>
+#include <px4_msgs/msg/mode_completed.hpp>
+#include <px4_msgs/msg/vehicle_command.hpp>
+#include <px4_msgs/msg/vehicle_command_ack.hpp>
+#include <px4_msgs/msg/vehicle_status.hpp>
+#include <px4_ros2/components/mode.hpp>
+#include <px4_ros2/components/mode_executor_coroutine.hpp>
+#include <px4_ros2/control/setpoint_types/experimental/rates.hpp>
+#include "fake_registration.hpp"
+#include "spin_util.hpp"
+
+#include <optional>
+#include <vector>
+
+using px4_msgs::msg::VehicleCommand;
+using px4_msgs::msg::VehicleCommandAck;
+using px4_ros2::ExecutorTask;
+using px4_ros2::ModeBase;
+using px4_ros2::Result;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+constexpr uint32_t kSetNavState = VehicleCommand::VEHICLE_CMD_SET_NAV_STATE;
+
+class TestMode : public ModeBase
+{
+public:
+  explicit TestMode(rclcpp::Node & node)
+  : ModeBase(node, std::string("test"))
+  {
+    _rates_setpoint = std::make_shared<px4_ros2::RatesSetpointType>(*this);
+  }
+
+  void onActivate() override {}
+  void onDeactivate() override {}
+
+private:
+  std::shared_ptr<px4_ros2::RatesSetpointType> _rates_setpoint;
+};
+
+class TestCoroutineExecutor : public px4_ros2::ModeExecutorCoroutineBase
+{
+public:
+  TestCoroutineExecutor(rclcpp::Node & node, ModeBase & owned_mode)
+  : ModeExecutorCoroutineBase(node, Settings{}, owned_mode)
+  {
+    setSkipMessageCompatibilityCheck();
+    overrideRegistration(std::make_shared<FakeRegistration>(node));
+  }
+
+  ExecutorTask run() override
+  {
+    ++num_runs;
+    results.clear();
+    finished = false;
+    results.push_back(co_await scheduleMode(20));
+    results.push_back(co_await scheduleMode(21));
+    // Nested tasks share the cancellation state
+    co_await subMission();
+    finished = true;
+  }
+
+  void onCancelled(DeactivateReason reason) override {cancel_reason = reason;}
+
+  int num_runs{0};
+  std::vector<Result> results;
+  bool finished{false};
+  std::optional<DeactivateReason> cancel_reason;
+
+private:
+  ExecutorTask subMission()
+  {
+    results.push_back(co_await scheduleMode(22));
+  }
+};
+
+} // namespace
+
+class ModeExecutorCoroutineTest : public testing::Test
+{
+protected:
+  ModeExecutorCoroutineTest()
+  : _node("test_node"), _mode(_node), _executor(_node, _mode)
+  {
+    _command_sub = _node.create_subscription<VehicleCommand>(
+      "fmu/in/vehicle_command_mode_executor", rclcpp::QoS(10),
+      [this](VehicleCommand::UniquePtr msg) {_commands.push_back(*msg);});
+    _ack_pub = _node.create_publisher<VehicleCommandAck>("fmu/out/vehicle_command_ack", 10);
+    _vehicle_status_pub = _node.create_publisher<px4_msgs::msg::VehicleStatus>(
+      "fmu/out/vehicle_status", 1);
+    _mode_completed_pub = _node.create_publisher<px4_msgs::msg::ModeCompleted>(
+      "fmu/out/mode_completed", 1);
+  }
+
+  void SetUp() override
+  {
+    ASSERT_TRUE(_executor.doRegister());
+  }
+
+  void publishVehicleStatus(bool in_charge, bool failsafe = false)
+  {
+    px4_msgs::msg::VehicleStatus status{};
+    status.arming_state = px4_msgs::msg::VehicleStatus::ARMING_STATE_ARMED;
+    status.nav_state = static_cast<uint8_t>(_mode.id());
+    status.executor_in_charge = in_charge ? static_cast<uint8_t>(_executor.id()) : 0;
+    status.failsafe = failsafe;
+    _vehicle_status_pub->publish(status);
+  }
+
+  void armAndActivate()
+  {
+    publishVehicleStatus(true);
+    ASSERT_TRUE(spinUntil(_node, [&]() {return _executor.isInCharge();}));
+  }
+
+  /**
+   * Wait for the mode command, accept it and complete the mode
+   */
+  void runMode(size_t command_index, ModeBase::ModeID mode_id, Result result)
+  {
+    ASSERT_TRUE(spinUntil(_node, [&]() {return _commands.size() > command_index;}));
+    EXPECT_EQ(_commands[command_index].command, kSetNavState);
+    EXPECT_FLOAT_EQ(_commands[command_index].param1, mode_id);
+    publishAck(kSetNavState, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+    spinFor(_node, 10ms);
+    publishModeCompleted(mode_id, result);
+  }
+
+  void publishAck(uint32_t command, uint8_t result)
+  {
+    VehicleCommandAck ack{};
+    ack.command = command;
+    ack.result = result;
+    ack.target_component = VehicleCommand::COMPONENT_MODE_EXECUTOR_START + _executor.id();
+    _ack_pub->publish(ack);
+  }
+
+  void publishModeCompleted(ModeBase::ModeID mode_id, Result result)
+  {
+    px4_msgs::msg::ModeCompleted mode_completed{};
+    mode_completed.nav_state = static_cast<uint8_t>(mode_id);
+    mode_completed.result = static_cast<uint8_t>(result);
+    _mode_completed_pub->publish(mode_completed);
+  }
+
+  rclcpp::Node _node;
+  TestMode _mode;
+  TestCoroutineExecutor _executor;
+  rclcpp::Subscription<VehicleCommand>::SharedPtr _command_sub;
+  rclcpp::Publisher<VehicleCommandAck>::SharedPtr _ack_pub;
+  rclcpp::Publisher<px4_msgs::msg::VehicleStatus>::SharedPtr _vehicle_status_pub;
+  rclcpp::Publisher<px4_msgs::msg::ModeCompleted>::SharedPtr _mode_completed_pub;
+  std::vector<VehicleCommand> _commands;
+};
+
+TEST_F(ModeExecutorCoroutineTest, completion)
+{
+  EXPECT_EQ(_executor.num_runs, 0);
+  armAndActivate();
+  EXPECT_EQ(_executor.num_runs, 1);
+
+  runMode(0, 20, Result::Success);
+  runMode(1, 21, Result::Success);
+  runMode(2, 22, Result::ModeFailureOther);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return _executor.finished;}));
+  EXPECT_EQ(
+    _executor.results,
+    (std::vector<Result>{Result::Success, Result::Success, Result::ModeFailureOther}));
+  EXPECT_FALSE(_executor.cancel_reason);
+
+  spinFor(_node, 20ms);
+  EXPECT_EQ(_commands.size(), 3u);
+}
+
+TEST_F(ModeExecutorCoroutineTest, cancellation)
+{
+  armAndActivate();
+  runMode(0, 20, Result::Success);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return _commands.size() == 2u;}));
+  publishAck(kSetNavState, VehicleCommandAck::VEHICLE_CMD_RESULT_ACCEPTED);
+  spinFor(_node, 10ms);
+
+  // Deactivation completes the awaited mode, and every following operation completes immediately
+  publishVehicleStatus(false, true);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return !_executor.isInCharge();}));
+  ASSERT_TRUE(_executor.cancel_reason);
+  EXPECT_EQ(
+    *_executor.cancel_reason,
+    px4_ros2::ModeExecutorBase::DeactivateReason::FailsafeActivated);
+  EXPECT_TRUE(_executor.finished);
+  EXPECT_EQ(
+    _executor.results,
+    (std::vector<Result>{Result::Success, Result::Deactivated, Result::Deactivated}));
+
+  // The nested task did not start its operation
+  spinFor(_node, 20ms);
+  EXPECT_EQ(_commands.size(), 2u);
+
+  // Activating again restarts the mission from the beginning
+  armAndActivate();
+  EXPECT_EQ(_executor.num_runs, 2);
+  runMode(2, 20, Result::Success);
+  ASSERT_TRUE(spinUntil(_node, [&]() {return _executor.results.size() == 1u;}));
+  EXPECT_EQ(_executor.results[0], Result::Success);
+  EXPECT_FALSE(_executor.finished);
+}
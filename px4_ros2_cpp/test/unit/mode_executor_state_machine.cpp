@@ -0,0 +1,301 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <rclcpp/rclcpp.hpp>
+#include <px4_ros2/components/mode.hpp>
+#include <px4_ros2/components/mode_executor.hpp>
+#include <px4_ros2/components/mode_executor_state_machine.hpp>
+#include "spin_util.hpp"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+using px4_ros2::ModeExecutorStateMachine;
+using px4_ros2::Result;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+class TestMode : public px4_ros2::ModeBase
+{
+public:
+  explicit TestMode(rclcpp::Node & node)
+  : ModeBase(node, std::string("test")) {}
+  void onActivate() override {}
+  void onDeactivate() override {}
+};
+
+class TestExecutor : public px4_ros2::ModeExecutorBase
+{
+public:
+  TestExecutor(rclcpp::Node & node, px4_ros2::ModeBase & mode)
+  : ModeExecutorBase(node, Settings{}, mode) {}
+  void onActivate() override {}
+  void onDeactivate(DeactivateReason reason) override {}
+};
+
+ModeExecutorStateMachine::Action completeWith(Result result)
+{
+  return [result](const ModeExecutorStateMachine::CompletedCallback & on_completed) {
+           on_completed(result);
+         };
+}
+
+} // namespace
+
+class ModeExecutorStateMachineTest : public testing::Test
+{
+protected:
+  ModeExecutorStateMachineTest()
+  : _node("test_node"), _mode(_node), _executor(_node, _mode) {}
+
+  rclcpp::Node _node;
+  TestMode _mode;
+  TestExecutor _executor;
+};
+
+TEST_F(ModeExecutorStateMachineTest, transitions)
+{
+  ModeExecutorStateMachine::CompletedCallback pending;
+  bool battery_ok = true;
+  ModeExecutorStateMachine state_machine(
+    _executor,
+    {
+      {"takeoff", completeWith(Result::Success)},
+      {"mission", [&pending](const ModeExecutorStateMachine::CompletedCallback & cb) {pending = cb;}},
+      {"rtl", completeWith(Result::Success)},
+      {"land", completeWith(Result::Rejected)},
+    },
+    {
+      {"takeoff", Result::Success, "mission"},
+      {"mission", Result::Success, "rtl", [&battery_ok]() {return battery_ok;}, "land"},
+      {"rtl", Result::Success, ""},
+    });
+
+  EXPECT_EQ(state_machine.numStates(), 4u);
+  EXPECT_EQ(state_machine.stateName(state_machine.stateId("rtl")), "rtl");
+  EXPECT_EQ(
+    state_machine.transitionTarget(state_machine.stateId("takeoff"), Result::Success),
+    state_machine.stateId("mission"));
+  EXPECT_EQ(
+    state_machine.transitionTarget(state_machine.stateId("takeoff"), Result::Rejected),
+    ModeExecutorStateMachine::kStateStop);
+
+  std::vector<std::string> transitions;
+  state_machine.setTransitionCallback(
+    [&](ModeExecutorStateMachine::StateId from, ModeExecutorStateMachine::StateId to, Result) {
+      transitions.push_back(state_machine.stateName(from) + "->" + state_machine.stateName(to));
+    });
+
+  int num_finished = 0;
+  Result finished_result = Result::Success;
+  std::string finished_state;
+  const auto on_finished = [&](ModeExecutorStateMachine::StateId last_state, Result result) {
+      ++num_finished;
+      finished_result = result;
+      finished_state = state_machine.stateName(last_state);
+    };
+
+  // Success path
+  state_machine.start("takeoff", on_finished);
+  EXPECT_TRUE(state_machine.running());
+  EXPECT_EQ(state_machine.currentStateName(), "mission");
+  ASSERT_TRUE(pending);
+  pending(Result::Success);
+  EXPECT_FALSE(state_machine.running());
+  EXPECT_EQ(num_finished, 1);
+  EXPECT_EQ(finished_result, Result::Success);
+  EXPECT_EQ(finished_state, "rtl");
+  EXPECT_EQ(
+    transitions,
+    (std::vector<std::string>{"takeoff->mission", "mission->rtl", "rtl->stop"}));
+
+  // Completing again is ignored
+  pending(Result::Success);
+  EXPECT_EQ(num_finished, 1);
+
+  // Guard fails: land gets rejected, which has no transition
+  battery_ok = false;
+  pending = nullptr;
+  state_machine.start("takeoff", on_finished);
+  ASSERT_TRUE(pending);
+  pending(Result::Success);
+  EXPECT_EQ(num_finished, 2);
+  EXPECT_EQ(finished_result, Result::Rejected);
+  EXPECT_EQ(finished_state, "land");
+
+  // Stopping discards the pending action
+  pending = nullptr;
+  state_machine.start("mission", on_finished);
+  state_machine.stop();
+  ASSERT_TRUE(pending);
+  pending(Result::Success);
+  EXPECT_FALSE(state_machine.running());
+  EXPECT_EQ(num_finished, 2);
+}
+
+TEST_F(ModeExecutorStateMachineTest, longSynchronousChain)
+{
+  static constexpr int kNumStates = 10000;
+  std::vector<ModeExecutorStateMachine::StateDefinition> states;
+  std::vector<ModeExecutorStateMachine::TransitionDefinition> transitions;
+
+  for (int i = 0; i < kNumStates; ++i) {
+    states.push_back({"s" + std::to_string(i), completeWith(Result::Success)});
+
+    if (i > 0) {
+      transitions.push_back({"s" + std::to_string(i - 1), Result::Success, "s" + std::to_string(i)});
+    }
+  }
+
+  ModeExecutorStateMachine state_machine(_executor, states, transitions);
+  int num_transitions = 0;
+  state_machine.setTransitionCallback(
+    [&num_transitions](ModeExecutorStateMachine::StateId, ModeExecutorStateMachine::StateId, Result) {
+      ++num_transitions;
+    });
+  bool finished = false;
+  state_machine.start(
+    "s0", [&finished](ModeExecutorStateMachine::StateId, Result) {finished = true;});
+  EXPECT_TRUE(finished);
+  EXPECT_EQ(num_transitions, kNumStates);
+}
+
+TEST_F(ModeExecutorStateMachineTest, timeoutCancelsPendingAction)
+{
+  // Both states wait on the vehicle status, which only supports one wait at a time
+  std::vector<Result> wait_results;
+  int num_cancelled = 0;
+  const auto wait_ready_to_arm = [&](const ModeExecutorStateMachine::CompletedCallback & cb) {
+      _executor.waitReadyToArm(
+        [&wait_results, cb](Result result) {
+          wait_results.push_back(result);
+          cb(result);
+        });
+    };
+  const auto cancel = [&]() {
+      ++num_cancelled;
+      _executor.cancelVehicleStatusWait();
+    };
+  ModeExecutorStateMachine state_machine(
+    _executor,
+    {
+      {"wait", wait_ready_to_arm, 50ms, cancel},
+      {"wait_again", wait_ready_to_arm, 0ms, cancel},
+    },
+    {
+      {"wait", Result::Timeout, "wait_again"},
+      {"wait", Result::Deactivated, "wait_again"},
+    });
+
+  std::optional<Result> finished_result;
+  state_machine.start(
+    "wait", [&](ModeExecutorStateMachine::StateId, Result result) {finished_result = result;});
+  EXPECT_EQ(state_machine.currentStateName(), "wait");
+
+  ASSERT_TRUE(spinUntil(_node, [&]() {return state_machine.currentStateName() == "wait_again";}));
+  EXPECT_EQ(num_cancelled, 1);
+
+  // The cancelled action completed, but did not trigger another transition
+  EXPECT_EQ(wait_results, (std::vector<Result>{Result::Deactivated}));
+  EXPECT_TRUE(state_machine.running());
+  EXPECT_FALSE(finished_result);
+
+  // The state without timeout is not cancelled
+  spinFor(_node, 100ms);
+  EXPECT_EQ(state_machine.currentStateName(), "wait_again");
+  EXPECT_EQ(num_cancelled, 1);
+
+  _executor.cancelVehicleStatusWait(Result::Rejected);
+  ASSERT_TRUE(finished_result);
+  EXPECT_EQ(*finished_result, Result::Rejected);
+  EXPECT_FALSE(state_machine.running());
+}
+
+TEST_F(ModeExecutorStateMachineTest, transitionCallbackStopsOrRestarts)
+{
+  std::vector<std::string> entered;
+  ModeExecutorStateMachine::CompletedCallback pending;
+  const auto enter = [&](const std::string & name, bool complete) {
+      return [&entered, &pending, name, complete](
+        const ModeExecutorStateMachine::CompletedCallback & cb) {
+               entered.push_back(name);
+
+               if (complete) {
+                 cb(Result::Success);
+
+               } else {
+                 pending = cb;
+               }
+             };
+    };
+  ModeExecutorStateMachine state_machine(
+    _executor,
+    {
+      {"a", enter("a", true)},
+      {"b", enter("b", false)},
+      {"c", enter("c", false)},
+    },
+    {
+      {"a", Result::Success, "b"},
+      {"b", Result::Success, "c"},
+    });
+
+  int num_finished = 0;
+  const auto on_finished = [&num_finished](ModeExecutorStateMachine::StateId, Result) {
+      ++num_finished;
+    };
+  std::function<void(ModeExecutorStateMachine::StateId)> on_transition;
+  state_machine.setTransitionCallback(
+    [&on_transition](ModeExecutorStateMachine::StateId from, ModeExecutorStateMachine::StateId,
+    Result) {
+      on_transition(from);
+    });
+
+  // Stopped during a synchronous transition
+  on_transition = [&](ModeExecutorStateMachine::StateId) {state_machine.stop();};
+  state_machine.start("a", on_finished);
+  EXPECT_FALSE(state_machine.running());
+  EXPECT_EQ(entered, (std::vector<std::string>{"a"}));
+
+  // Restarted during a synchronous transition
+  entered.clear();
+  on_transition = [&](ModeExecutorStateMachine::StateId from) {
+      if (from == state_machine.stateId("a")) {
+        state_machine.start("c", on_finished);
+      }
+    };
+  state_machine.start("a", on_finished);
+  EXPECT_EQ(state_machine.currentStateName(), "c");
+  EXPECT_EQ(entered, (std::vector<std::string>{"a", "c"}));
+
+  // Stopped during a transition after an asynchronous completion
+  entered.clear();
+  pending = nullptr;
+  on_transition = [](ModeExecutorStateMachine::StateId) {};
+  state_machine.start("b", on_finished);
+  ASSERT_TRUE(pending);
+  on_transition = [&](ModeExecutorStateMachine::StateId) {state_machine.stop();};
+  pending(Result::Success);
+  EXPECT_FALSE(state_machine.running());
+  EXPECT_EQ(entered, (std::vector<std::string>{"b"}));
+  EXPECT_EQ(num_finished, 0);
+}
+
+TEST_F(ModeExecutorStateMachineTest, invalidDefinition)
+{
+  EXPECT_THROW(
+    ModeExecutorStateMachine(
+      _executor, {{"a", completeWith(Result::Success)}}, {{"a", Result::Success, "b"}}),
+    std::runtime_error);
+  EXPECT_THROW(
+    ModeExecutorStateMachine(
+      _executor, {{"a", completeWith(Result::Success)}, {"a", completeWith(Result::Success)}}, {}),
+    std::runtime_error);
+}
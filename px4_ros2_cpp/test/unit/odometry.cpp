@@ -0,0 +1,162 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <rclcpp/rclcpp.hpp>
+#include <px4_ros2/odometry/attitude.hpp>
+#include <px4_ros2/odometry/local_position.hpp>
+#include "spin_util.hpp"
+
+using px4_ros2::OdometryAttitude;
+using px4_ros2::OdometryLocalPosition;
+using namespace std::chrono_literals;
+
+class OdometryPredictionTest : public testing::Test
+{
+protected:
+  OdometryPredictionTest()
+  : _node("test_node"), _context(_node), _local_position(_context), _attitude(_context)
+  {
+    _local_position_pub = _node.create_publisher<px4_msgs::msg::VehicleLocalPosition>(
+      "fmu/out/vehicle_local_position", 1);
+    _attitude_pub = _node.create_publisher<px4_msgs::msg::VehicleAttitude>(
+      "fmu/out/vehicle_attitude", 1);
+  }
+
+  void publishLocalPosition(
+    const Eigen::Vector3f & position, const Eigen::Vector3f & velocity,
+    const Eigen::Vector3f & acceleration)
+  {
+    px4_msgs::msg::VehicleLocalPosition msg{};
+    msg.timestamp = 1'000'000;
+    msg.timestamp_sample = msg.timestamp - kFmuDelayUs;
+    msg.x = position.x();
+    msg.y = position.y();
+    msg.z = position.z();
+    msg.vx = velocity.x();
+    msg.vy = velocity.y();
+    msg.vz = velocity.z();
+    msg.ax = acceleration.x();
+    msg.ay = acceleration.y();
+    msg.az = acceleration.z();
+    _local_position_pub->publish(msg);
+    ASSERT_TRUE(spinUntil(_node, [this]() {return _local_position.lastValid();}));
+  }
+
+  void publishAttitude(const Eigen::Quaternionf & attitude)
+  {
+    px4_msgs::msg::VehicleAttitude msg{};
+    msg.timestamp = 1'000'000;
+    msg.timestamp_sample = msg.timestamp - kFmuDelayUs;
+    msg.q = {attitude.w(), attitude.x(), attitude.y(), attitude.z()};
+    _attitude_pub->publish(msg);
+    ASSERT_TRUE(spinUntil(_node, [this]() {return _attitude.lastValid();}));
+  }
+
+  static constexpr uint64_t kFmuDelayUs = 10'000;
+
+  rclcpp::Node _node;
+  px4_ros2::Context _context;
+  OdometryLocalPosition _local_position;
+  OdometryAttitude _attitude;
+  rclcpp::Publisher<px4_msgs::msg::VehicleLocalPosition>::SharedPtr _local_position_pub;
+  rclcpp::Publisher<px4_msgs::msg::VehicleAttitude>::SharedPtr _attitude_pub;
+};
+
+TEST_F(OdometryPredictionTest, localPositionConstantAcceleration)
+{
+  const Eigen::Vector3f position{1.f, -2.f, -10.f};
+  const Eigen::Vector3f velocity{2.f, 0.5f, -1.f};
+  const Eigen::Vector3f acceleration{0.f, 1.f, 2.f};
+  publishLocalPosition(position, velocity, acceleration);
+
+  // Without a time sync, only the delay on the FMU side is accounted for
+  const rclcpp::Time sample_time = _local_position.sampleTime();
+  EXPECT_EQ(
+    (_local_position.lastTime() - sample_time).nanoseconds(),
+    static_cast<int64_t>(kFmuDelayUs) * 1000);
+
+  const float dt = 0.2f;
+  const rclcpp::Time time = sample_time + rclcpp::Duration::from_seconds(dt);
+  const Eigen::Vector3f expected_position =
+    position + velocity * dt + 0.5f * acceleration * dt * dt;
+  EXPECT_TRUE(_local_position.predictedPositionNed(time).isApprox(expected_position, 1e-5f));
+  EXPECT_TRUE(
+    _local_position.predictedVelocityNed(time).isApprox(velocity + acceleration * dt, 1e-5f));
+
+  // No extrapolation into the past
+  const rclcpp::Time before_sample = sample_time - rclcpp::Duration::from_seconds(0.1);
+  EXPECT_TRUE(_local_position.predictedPositionNed(before_sample).isApprox(position));
+  EXPECT_TRUE(_local_position.predictedVelocityNed(before_sample).isApprox(velocity));
+}
+
+TEST_F(OdometryPredictionTest, localPositionHorizonClamp)
+{
+  const Eigen::Vector3f position{0.f, 0.f, -5.f};
+  const Eigen::Vector3f velocity{1.f, 0.f, 0.f};
+  const Eigen::Vector3f acceleration{1.f, -1.f, 0.f};
+  publishLocalPosition(position, velocity, acceleration);
+
+  const float max_horizon =
+    std::chrono::duration<float>(OdometryLocalPosition::kMaxPredictionHorizon).count();
+  const rclcpp::Time at_horizon = _local_position.sampleTime() +
+    rclcpp::Duration(OdometryLocalPosition::kMaxPredictionHorizon);
+  const rclcpp::Time beyond_horizon = _local_position.sampleTime() + rclcpp::Duration(3s);
+
+  const Eigen::Vector3f expected_position =
+    position + velocity * max_horizon + 0.5f * acceleration * max_horizon * max_horizon;
+  EXPECT_TRUE(
+    _local_position.predictedPositionNed(at_horizon).isApprox(expected_position, 1e-5f));
+  EXPECT_TRUE(
+    _local_position.predictedPositionNed(beyond_horizon).isApprox(expected_position, 1e-5f));
+  EXPECT_TRUE(
+    _local_position.predictedVelocityNed(beyond_horizon).isApprox(
+      velocity + acceleration * max_horizon, 1e-5f));
+}
+
+TEST_F(OdometryPredictionTest, attitudeConstantRate)
+{
+  // Rotated by 90 degrees in yaw, rolling in the body frame
+  const Eigen::Quaternionf attitude(
+    Eigen::AngleAxisf(static_cast<float>(M_PI_2), Eigen::Vector3f::UnitZ()));
+  publishAttitude(attitude);
+  const Eigen::Vector3f angular_velocity_frd{1.f, 0.f, 0.f};
+
+  const float dt = 0.3f;
+  const rclcpp::Time time = _attitude.sampleTime() + rclcpp::Duration::from_seconds(dt);
+  const Eigen::Quaternionf expected =
+    attitude * Eigen::Quaternionf(Eigen::AngleAxisf(dt, Eigen::Vector3f::UnitX()));
+  EXPECT_LT(
+    _attitude.predictedAttitude(angular_velocity_frd, time).angularDistance(expected), 1e-4f);
+
+  // The body x axis is the rotation axis, which points east after the yaw rotation
+  const Eigen::Vector3f body_x_ned =
+    _attitude.predictedAttitude(angular_velocity_frd, time) * Eigen::Vector3f::UnitX();
+  EXPECT_TRUE(body_x_ned.isApprox(Eigen::Vector3f::UnitY(), 1e-4f));
+
+  // No rotation: the attitude is returned unchanged
+  EXPECT_LT(
+    _attitude.predictedAttitude(Eigen::Vector3f::Zero(), time).angularDistance(attitude), 1e-6f);
+}
+
+TEST_F(OdometryPredictionTest, attitudeHorizonClamp)
+{
+  publishAttitude(Eigen::Quaternionf::Identity());
+  const Eigen::Vector3f angular_velocity_frd{0.f, 0.f, 2.f};
+  const float max_horizon =
+    std::chrono::duration<float>(OdometryAttitude::kMaxPredictionHorizon).count();
+
+  const Eigen::Quaternionf expected(
+    Eigen::AngleAxisf(2.f * max_horizon, Eigen::Vector3f::UnitZ()));
+  const rclcpp::Time beyond_horizon = _attitude.sampleTime() + rclcpp::Duration(2s);
+  EXPECT_LT(
+    _attitude.predictedAttitude(angular_velocity_frd, beyond_horizon).angularDistance(expected),
+    1e-4f);
+
+  const rclcpp::Time before_sample = _attitude.sampleTime() - rclcpp::Duration(100ms);
+  EXPECT_LT(
+    _attitude.predictedAttitude(angular_velocity_frd, before_sample).angularDistance(
+      Eigen::Quaternionf::Identity()), 1e-6f);
+}
@@ -0,0 +1,90 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <px4_ros2/control/trajectory/polynomial_trajectory.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+using px4_ros2::PolynomialTrajectory;
+
+TEST(PolynomialTrajectory, sampleDerivatives)
+{
+  PolynomialTrajectory trajectory;
+  EXPECT_TRUE(trajectory.empty());
+
+  // x = 1 + 2t + 3t^2 + t^3, y = -t^7, z = -5, yaw = 0.5t
+  PolynomialTrajectory::Coefficients coefficients = PolynomialTrajectory::Coefficients::Zero();
+  coefficients.row(0).head<4>() << 1., 2., 3., 1.;
+  coefficients(1, 7) = -1.;
+  coefficients(2, 0) = -5.;
+  coefficients(3, 1) = 0.5;
+  trajectory.addSegment(2., coefficients);
+  EXPECT_DOUBLE_EQ(trajectory.duration(), 2.);
+
+  const double t = 1.5;
+  const auto sample = trajectory.sample(t);
+  EXPECT_NEAR(sample.position_ned_m.x(), 1. + 2. * t + 3. * t * t + t * t * t, 1e-4);
+  EXPECT_NEAR(sample.velocity_ned_m_s.x(), 2. + 6. * t + 3. * t * t, 1e-4);
+  EXPECT_NEAR(sample.acceleration_ned_m_s2.x(), 6. + 6. * t, 1e-4);
+  EXPECT_NEAR(sample.position_ned_m.y(), -std::pow(t, 7), 1e-4);
+  EXPECT_NEAR(sample.velocity_ned_m_s.y(), -7. * std::pow(t, 6), 1e-4);
+  EXPECT_NEAR(sample.acceleration_ned_m_s2.y(), -42. * std::pow(t, 5), 1e-4);
+  EXPECT_FLOAT_EQ(sample.position_ned_m.z(), -5.f);
+  EXPECT_FLOAT_EQ(sample.velocity_ned_m_s.z(), 0.f);
+  EXPECT_FLOAT_EQ(sample.yaw_ned_rad, 0.75f);
+  EXPECT_FLOAT_EQ(sample.yaw_rate_ned_rad_s, 0.5f);
+
+  trajectory.setYawEnabled(false);
+  EXPECT_TRUE(std::isnan(trajectory.sample(t).yaw_ned_rad));
+  EXPECT_TRUE(std::isnan(trajectory.sample(t).yaw_rate_ned_rad_s));
+
+  EXPECT_THROW(trajectory.addSegment(0., coefficients), std::runtime_error);
+}
+
+TEST(PolynomialTrajectory, segments)
+{
+  // Segments with constant velocity 1, 2, ..., each starting where the previous one ended
+  PolynomialTrajectory trajectory;
+  static constexpr int kNumSegments = 10;
+  double position = 0.;
+
+  for (int i = 0; i < kNumSegments; ++i) {
+    PolynomialTrajectory::Coefficients coefficients = PolynomialTrajectory::Coefficients::Zero();
+    coefficients(0, 0) = position;
+    coefficients(0, 1) = i + 1;
+    trajectory.addSegment(0.5, coefficients);
+    position += 0.5 * (i + 1);
+  }
+
+  EXPECT_EQ(trajectory.numSegments(), static_cast<size_t>(kNumSegments));
+  EXPECT_DOUBLE_EQ(trajectory.duration(), kNumSegments * 0.5);
+
+  // Increasing, then random access
+  for (const double t : {0., 0.2, 0.6, 1.1, 4.9, 0.3, 2.7, 1.2}) {
+    const int segment = static_cast<int>(t / 0.5);
+    const double segment_start = 0.25 * segment * (segment + 1);
+    const auto sample = trajectory.sample(t);
+    EXPECT_NEAR(sample.position_ned_m.x(), segment_start + (segment + 1) * (t - 0.5 * segment), 1e-4)
+      << "t=" << t;
+    EXPECT_FLOAT_EQ(sample.velocity_ned_m_s.x(), segment + 1.f) << "t=" << t;
+  }
+
+  // Before the start, the start is used
+  EXPECT_FLOAT_EQ(trajectory.sample(-1.).position_ned_m.x(), 0.f);
+  EXPECT_FLOAT_EQ(trajectory.sample(-1.).velocity_ned_m_s.x(), 1.f);
+
+  // After the end, the final position is held
+  const auto end = trajectory.sample(100.);
+  EXPECT_NEAR(end.position_ned_m.x(), position, 1e-4);
+  EXPECT_FLOAT_EQ(end.velocity_ned_m_s.x(), 0.f);
+  EXPECT_FLOAT_EQ(end.acceleration_ned_m_s2.x(), 0.f);
+  EXPECT_FLOAT_EQ(end.yaw_rate_ned_rad_s, 0.f);
+
+  trajectory.clear();
+  EXPECT_TRUE(trajectory.empty());
+  EXPECT_DOUBLE_EQ(trajectory.duration(), 0.);
+}
@@ -0,0 +1,107 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <px4_ros2/control/rate_controller.hpp>
+
+#include <cmath>
+
+using px4_ros2::RateController;
+
+namespace
+{
+RateController::Gains gains()
+{
+  RateController::Gains gains;
+  gains.p = {1.f, 2.f, 3.f};
+  gains.i = {0.5f, 0.5f, 0.5f};
+  gains.d = {0.1f, 0.1f, 0.1f};
+  gains.integrator_limit = {0.2f, 0.2f, 0.2f};
+  gains.derivative_cutoff_hz = 20.f;
+  return gains;
+}
+} // namespace
+
+TEST(RateController, proportionalAndIntegral)
+{
+  RateController controller(gains());
+  const Eigen::Vector3f setpoint{0.1f, 0.1f, 0.1f};
+  static constexpr float kDt = 0.004f;
+
+  // First update: proportional only
+  Eigen::Vector3f torque = controller.update(setpoint, Eigen::Vector3f::Zero(), kDt);
+  EXPECT_NEAR((torque - Eigen::Vector3f(0.1f, 0.2f, 0.3f)).norm(), 0.f, 1e-6f);
+
+  // Integral grows with a constant error, up to the limit
+  for (int i = 0; i < 100; ++i) {
+    torque = controller.update(setpoint, Eigen::Vector3f::Zero(), kDt);
+  }
+
+  EXPECT_NEAR(controller.integral()(0), 0.5f * 0.1f * kDt * 101, 1e-4f);
+
+  for (int i = 0; i < 10000; ++i) {
+    controller.update(setpoint, Eigen::Vector3f::Zero(), kDt);
+  }
+
+  EXPECT_FLOAT_EQ(controller.integral()(0), 0.2f);
+
+  controller.reset();
+  EXPECT_EQ(controller.integral(), Eigen::Vector3f::Zero());
+
+  // Invalid time steps do not integrate
+  controller.update(setpoint, Eigen::Vector3f::Zero(), 0.f);
+  controller.update(setpoint, Eigen::Vector3f::Zero(), 1.f);
+  EXPECT_EQ(controller.integral(), Eigen::Vector3f::Zero());
+}
+
+TEST(RateController, antiWindup)
+{
+  RateController controller(gains());
+  const Eigen::Vector3f setpoint{0.1f, -0.1f, 0.1f};
+
+  // Roll saturated positive, pitch saturated negative: no integration into the saturation
+  Eigen::Matrix<bool, 3, 1> positive{true, false, false};
+  Eigen::Matrix<bool, 3, 1> negative{false, true, false};
+  controller.setSaturation(positive, negative);
+
+  for (int i = 0; i < 10; ++i) {
+    controller.update(setpoint, Eigen::Vector3f::Zero(), 0.004f);
+  }
+
+  EXPECT_FLOAT_EQ(controller.integral()(0), 0.f);
+  EXPECT_FLOAT_EQ(controller.integral()(1), 0.f);
+  EXPECT_GT(controller.integral()(2), 0.f);
+
+  // Integration out of the saturation is allowed
+  controller.update(-setpoint, Eigen::Vector3f::Zero(), 0.004f);
+  EXPECT_LT(controller.integral()(0), 0.f);
+  EXPECT_GT(controller.integral()(1), 0.f);
+
+  // Large errors are not integrated
+  controller.reset();
+  controller.update(Eigen::Vector3f::Constant(10.f), Eigen::Vector3f::Zero(), 0.004f);
+  EXPECT_EQ(controller.integral(), Eigen::Vector3f::Zero());
+}
+
+TEST(RateController, derivativeFilter)
+{
+  RateController::Gains controller_gains = gains();
+  controller_gains.p.setZero();
+  controller_gains.i.setZero();
+  RateController controller(controller_gains);
+  static constexpr float kDt = 0.001f;
+
+  // Constant angular acceleration of 2 rad/s^2 with alternating noise
+  Eigen::Vector3f torque;
+
+  for (int i = 0; i < 1000; ++i) {
+    const float noise = (i % 2 == 0) ? 0.001f : -0.001f;
+    const Eigen::Vector3f rate = Eigen::Vector3f::Constant(2.f * i * kDt + noise);
+    torque = controller.update(Eigen::Vector3f::Zero(), rate, kDt);
+  }
+
+  // The raw derivative of the noise alone would be +-2 rad/s^2
+  EXPECT_NEAR(torque(0), -0.1f * 2.f, 0.1f * 0.5f);
+}
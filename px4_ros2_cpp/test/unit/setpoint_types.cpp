@@ -0,0 +1,163 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <rclcpp/rclcpp.hpp>
+#include <px4_msgs/msg/trajectory_setpoint.hpp>
+#include <px4_msgs/msg/vehicle_attitude_setpoint.hpp>
+#include <px4_msgs/msg/vehicle_control_mode.hpp>
+#include <px4_msgs/msg/vehicle_thrust_setpoint.hpp>
+#include <px4_msgs/msg/vehicle_torque_setpoint.hpp>
+#include <px4_ros2/components/message_compatibility_check.hpp>
+#include <px4_ros2/components/mode.hpp>
+#include <px4_ros2/control/setpoint_types/experimental/attitude.hpp>
+#include <px4_ros2/control/setpoint_types/experimental/trajectory.hpp>
+#include <px4_ros2/control/setpoint_types/experimental/thrust_torque.hpp>
+#include "fake_registration.hpp"
+#include "spin_util.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+namespace
+{
+
+class ThrustTorqueMode : public px4_ros2::ModeBase
+{
+public:
+  explicit ThrustTorqueMode(rclcpp::Node & node)
+  : ModeBase(node, std::string("thrust torque"))
+  {
+    _thrust_torque_setpoint = std::make_shared<px4_ros2::ThrustTorqueSetpointType>(*this);
+    setSkipMessageCompatibilityCheck();
+    overrideRegistration(std::make_shared<FakeRegistration>(node));
+  }
+  void onActivate() override {}
+  void onDeactivate() override {}
+
+  px4_ros2::ThrustTorqueSetpointType & setpoint() {return *_thrust_torque_setpoint;}
+
+private:
+  std::shared_ptr<px4_ros2::ThrustTorqueSetpointType> _thrust_torque_setpoint;
+};
+
+class AttitudeTrajectoryMode : public px4_ros2::ModeBase
+{
+public:
+  explicit AttitudeTrajectoryMode(rclcpp::Node & node)
+  : ModeBase(node, std::string("attitude trajectory"))
+  {
+    _attitude_setpoint = std::make_shared<px4_ros2::AttitudeSetpointType>(*this);
+    _trajectory_setpoint = std::make_shared<px4_ros2::TrajectorySetpointType>(*this);
+    setSkipMessageCompatibilityCheck();
+    overrideRegistration(std::make_shared<FakeRegistration>(node));
+  }
+  void onActivate() override {}
+  void onDeactivate() override {}
+
+  px4_ros2::AttitudeSetpointType & attitudeSetpoint() {return *_attitude_setpoint;}
+  px4_ros2::TrajectorySetpointType & trajectorySetpoint() {return *_trajectory_setpoint;}
+
+private:
+  std::shared_ptr<px4_ros2::AttitudeSetpointType> _attitude_setpoint;
+  std::shared_ptr<px4_ros2::TrajectorySetpointType> _trajectory_setpoint;
+};
+
+bool isInAllMessages(const std::string & topic_name)
+{
+  const std::vector<px4_ros2::MessageCompatibilityTopic> topics{ALL_PX4_ROS2_MESSAGES};
+  return std::any_of(
+    topics.begin(), topics.end(), [&topic_name](const px4_ros2::MessageCompatibilityTopic & topic) {
+      return topic.topic_name == topic_name;
+    });
+}
+
+} // namespace
+
+TEST(setpointTypes, thrustTorqueConfiguration)
+{
+  rclcpp::Node node("test_node");
+  ThrustTorqueMode mode(node);
+  std::optional<px4_msgs::msg::VehicleControlMode> control_mode;
+  auto control_mode_sub = node.create_subscription<px4_msgs::msg::VehicleControlMode>(
+    "fmu/in/config_control_setpoints", rclcpp::QoS(1),
+    [&control_mode](px4_msgs::msg::VehicleControlMode::UniquePtr msg) {control_mode = *msg;});
+
+  // The configuration of the first setpoint type is sent on registration
+  ASSERT_TRUE(mode.doRegister());
+  ASSERT_TRUE(spinUntil(node, [&control_mode]() {return control_mode.has_value();}));
+  EXPECT_EQ(control_mode->source_id, static_cast<uint8_t>(mode.id()));
+  EXPECT_TRUE(control_mode->flag_control_allocation_enabled);
+  EXPECT_FALSE(control_mode->flag_control_rates_enabled);
+  EXPECT_FALSE(control_mode->flag_control_attitude_enabled);
+  EXPECT_FALSE(control_mode->flag_control_velocity_enabled);
+  EXPECT_FALSE(control_mode->flag_control_position_enabled);
+
+  // The FMU rate controller is not required, as it is replaced
+  EXPECT_FALSE(mode.modeRequirements().angular_velocity);
+  EXPECT_FALSE(mode.modeRequirements().attitude);
+  EXPECT_FALSE(mode.modeRequirements().local_position);
+}
+
+TEST(setpointTypes, thrustTorqueUpdate)
+{
+  rclcpp::Node node("test_node");
+  ThrustTorqueMode mode(node);
+  ASSERT_TRUE(mode.doRegister());
+
+  std::optional<px4_msgs::msg::VehicleThrustSetpoint> thrust;
+  std::optional<px4_msgs::msg::VehicleTorqueSetpoint> torque;
+  auto thrust_sub = node.create_subscription<px4_msgs::msg::VehicleThrustSetpoint>(
+    "fmu/in/vehicle_thrust_setpoint", rclcpp::QoS(1),
+    [&thrust](px4_msgs::msg::VehicleThrustSetpoint::UniquePtr msg) {thrust = *msg;});
+  auto torque_sub = node.create_subscription<px4_msgs::msg::VehicleTorqueSetpoint>(
+    "fmu/in/vehicle_torque_setpoint", rclcpp::QoS(1),
+    [&torque](px4_msgs::msg::VehicleTorqueSetpoint::UniquePtr msg) {torque = *msg;});
+
+  mode.setpoint().update({0.f, 0.f, -0.6f}, {0.1f, -0.2f, 0.3f});
+  ASSERT_TRUE(spinUntil(node, [&]() {return thrust.has_value() && torque.has_value();}));
+  EXPECT_FLOAT_EQ(thrust->xyz[2], -0.6f);
+  EXPECT_FLOAT_EQ(torque->xyz[0], 0.1f);
+  EXPECT_FLOAT_EQ(torque->xyz[1], -0.2f);
+  EXPECT_FLOAT_EQ(torque->xyz[2], 0.3f);
+
+  // The allocation matches both by timestamp
+  EXPECT_EQ(thrust->timestamp, torque->timestamp);
+  EXPECT_EQ(thrust->timestamp_sample, torque->timestamp_sample);
+}
+
+TEST(setpointTypes, thrustTorqueMessagesChecked)
+{
+  EXPECT_TRUE(isInAllMessages("fmu/in/vehicle_thrust_setpoint"));
+  EXPECT_TRUE(isInAllMessages("fmu/in/vehicle_torque_setpoint"));
+}
+
+TEST(setpointTypes, intraProcessUpdate)
+{
+  // Serialized messages cannot be published with intra-process communication
+  rclcpp::Node node("test_node", rclcpp::NodeOptions().use_intra_process_comms(true));
+  AttitudeTrajectoryMode mode(node);
+  ASSERT_TRUE(mode.doRegister());
+
+  std::optional<px4_msgs::msg::VehicleAttitudeSetpoint> attitude;
+  std::optional<px4_msgs::msg::TrajectorySetpoint> trajectory;
+  auto attitude_sub = node.create_subscription<px4_msgs::msg::VehicleAttitudeSetpoint>(
+    "fmu/in/vehicle_attitude_setpoint", rclcpp::QoS(1),
+    [&attitude](px4_msgs::msg::VehicleAttitudeSetpoint::UniquePtr msg) {attitude = *msg;});
+  auto trajectory_sub = node.create_subscription<px4_msgs::msg::TrajectorySetpoint>(
+    "fmu/in/trajectory_setpoint", rclcpp::QoS(1),
+    [&trajectory](px4_msgs::msg::TrajectorySetpoint::UniquePtr msg) {trajectory = *msg;});
+
+  ASSERT_NO_THROW(
+    mode.attitudeSetpoint().update(
+      Eigen::Quaternionf::Identity(), Eigen::Vector3f{0.f, 0.f, -0.5f}));
+  ASSERT_NO_THROW(mode.trajectorySetpoint().update(Eigen::Vector3f{1.f, 2.f, 3.f}));
+  ASSERT_TRUE(spinUntil(node, [&]() {return attitude.has_value() && trajectory.has_value();}));
+  EXPECT_FLOAT_EQ(attitude->q_d[0], 1.f);
+  EXPECT_FLOAT_EQ(attitude->thrust_body[2], -0.5f);
+  EXPECT_FLOAT_EQ(trajectory->velocity[0], 1.f);
+  EXPECT_FLOAT_EQ(trajectory->velocity[2], 3.f);
+}
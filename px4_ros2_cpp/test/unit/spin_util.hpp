@@ -0,0 +1,42 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#pragma once
+
+#include <rclcpp/rclcpp.hpp>
+
+#include <chrono>
+
+/**
+ * Spin a node until a condition is true, or the timeout expires
+ * @return the last value of the condition
+ */
+template<typename ConditionT>
+bool spinUntil(
+  rclcpp::Node & node, const ConditionT & condition,
+  std::chrono::milliseconds timeout = std::chrono::seconds(2))
+{
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node.get_node_base_interface());
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return false;
+    }
+
+    executor.spin_once(std::chrono::milliseconds(1));
+  }
+
+  return true;
+}
+
+/**
+ * Spin a node for a fixed duration
+ */
+inline void spinFor(rclcpp::Node & node, std::chrono::milliseconds duration)
+{
+  spinUntil(node, []() {return false;}, duration);
+}
@@ -0,0 +1,73 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <px4_ros2/components/time_sync.hpp>
+
+#include <random>
+
+using px4_ros2::ClockOffsetEstimator;
+using namespace std::chrono_literals;
+
+TEST(ClockOffsetEstimator, offsetAndDrift)
+{
+  ClockOffsetEstimator estimator(1s, 30);
+  EXPECT_FALSE(estimator.valid());
+
+  static constexpr double kDrift = 20e-6;
+  static constexpr int64_t kOffset = 1'700'000'000'000'000;
+  static constexpr int64_t kMinDelay = 500;
+  const int64_t remote_start = 123'000'000;
+
+  std::mt19937 rng(42);
+  std::exponential_distribution<double> delay_distribution(1. / 2000.); // Mean 2ms on top of the minimum
+  std::uniform_real_distribution<double> congestion_distribution(0., 1.);
+
+  auto local_time = [&](int64_t remote) {
+      return kOffset + remote +
+             static_cast<int64_t>(kDrift * static_cast<double>(remote - remote_start));
+    };
+
+  // 50Hz over 60s
+  int64_t remote = remote_start;
+
+  for (int i = 0; i < 50 * 60; ++i) {
+    remote += 20'000;
+    double delay = kMinDelay + delay_distribution(rng);
+
+    // Some periods of congestion, where all messages are heavily delayed
+    if ((i / 50) % 7 == 3) {
+      delay += 50'000. * congestion_distribution(rng) + 20'000.;
+    }
+
+    estimator.addSample(remote, local_time(remote) + static_cast<int64_t>(delay));
+    ASSERT_TRUE(estimator.valid());
+  }
+
+  EXPECT_EQ(estimator.numBuckets(), 30u);
+  EXPECT_NEAR(estimator.drift(), kDrift, 2e-6);
+
+  // The offset includes the minimum delay
+  const int64_t local = estimator.remoteToLocal(remote);
+  EXPECT_NEAR(static_cast<double>(local - local_time(remote)), kMinDelay, 100.);
+  EXPECT_NEAR(static_cast<double>(estimator.localToRemote(local)), static_cast<double>(remote), 1.);
+}
+
+TEST(ClockOffsetEstimator, rebootResets)
+{
+  ClockOffsetEstimator estimator(100ms, 10);
+
+  for (int64_t remote = 10'000; remote < 2'000'000; remote += 10'000) {
+    estimator.addSample(remote, remote + 1'000'000);
+  }
+
+  EXPECT_EQ(estimator.remoteToLocal(5'000'000), 6'000'000);
+  EXPECT_EQ(estimator.numBuckets(), 10u);
+
+  // Remote restarts from 0, with a different offset
+  estimator.addSample(10'000, 10'000 + 5'000'000);
+  EXPECT_EQ(estimator.numBuckets(), 0u);
+  EXPECT_EQ(estimator.remoteToLocal(20'000), 5'020'000);
+}
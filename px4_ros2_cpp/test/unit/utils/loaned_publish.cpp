@@ -0,0 +1,67 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <rclcpp/rclcpp.hpp>
+#include <px4_msgs/msg/trajectory_setpoint.hpp>
+#include <src/utils/loaned_publish.hpp>
+#include "spin_util.hpp"
+
+#include <cmath>
+#include <optional>
+
+using px4_msgs::msg::TrajectorySetpoint;
+
+class LoanedPublishTest : public testing::Test
+{
+protected:
+  LoanedPublishTest()
+  : _node("test_node")
+  {
+    _publisher = _node.create_publisher<TrajectorySetpoint>("fmu/in/trajectory_setpoint", 1);
+    _subscription = _node.create_subscription<TrajectorySetpoint>(
+      "fmu/in/trajectory_setpoint", rclcpp::QoS(1),
+      [this](TrajectorySetpoint::UniquePtr msg) {_received = *msg;});
+  }
+
+  rclcpp::Node _node;
+  rclcpp::Publisher<TrajectorySetpoint>::SharedPtr _publisher;
+  rclcpp::Subscription<TrajectorySetpoint>::SharedPtr _subscription;
+  std::optional<TrajectorySetpoint> _received;
+};
+
+TEST_F(LoanedPublishTest, publish)
+{
+  // Both branches hand a value-initialized message to the callback
+  int num_fills = 0;
+  px4_ros2::publishLoaned(
+    *_publisher, [&num_fills](TrajectorySetpoint & setpoint) {
+      EXPECT_EQ(setpoint.timestamp, 0u);
+      EXPECT_FLOAT_EQ(setpoint.yaw, 0.f);
+      setpoint.timestamp = 1234;
+      setpoint.velocity = {1.f, -2.f, 3.f};
+      setpoint.yaw = NAN;
+      ++num_fills;
+    });
+  EXPECT_EQ(num_fills, 1);
+
+  ASSERT_TRUE(spinUntil(_node, [this]() {return _received.has_value();}));
+  EXPECT_EQ(_received->timestamp, 1234u);
+  EXPECT_FLOAT_EQ(_received->velocity[0], 1.f);
+  EXPECT_FLOAT_EQ(_received->velocity[1], -2.f);
+  EXPECT_FLOAT_EQ(_received->velocity[2], 3.f);
+  EXPECT_TRUE(std::isnan(_received->yaw));
+  EXPECT_FLOAT_EQ(_received->yawspeed, 0.f);
+}
+
+TEST_F(LoanedPublishTest, publishWithoutTemplate)
+{
+  px4_ros2::publishLoaned(
+    *_publisher, static_cast<px4_ros2::SerializedMessageTemplate<TrajectorySetpoint> *>(nullptr),
+    [](TrajectorySetpoint & setpoint) {setpoint.timestamp = 42;});
+
+  ASSERT_TRUE(spinUntil(_node, [this]() {return _received.has_value();}));
+  EXPECT_EQ(_received->timestamp, 42u);
+}
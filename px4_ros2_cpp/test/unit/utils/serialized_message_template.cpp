@@ -0,0 +1,50 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <px4_msgs/msg/trajectory_setpoint.hpp>
+#include <px4_ros2/utils/serialized_message_template.hpp>
+
+#include <cmath>
+#include <cstring>
+
+using px4_ros2::SerializedMessageTemplate;
+using px4_msgs::msg::TrajectorySetpoint;
+
+TEST(SerializedMessageTemplate, patchMatchesSerialization)
+{
+  TrajectorySetpoint prototype{};
+  prototype.jerk = {NAN, NAN, NAN};
+  SerializedMessageTemplate<TrajectorySetpoint> serialized_template(prototype);
+  serialized_template.addField(&TrajectorySetpoint::timestamp);
+  serialized_template.addField(&TrajectorySetpoint::position);
+  serialized_template.addField(&TrajectorySetpoint::yaw);
+
+  TrajectorySetpoint setpoint = prototype;
+  setpoint.timestamp = 123456789;
+  setpoint.position = {1.f, -2.f, 3.5f};
+  setpoint.yaw = 0.25f;
+  // Not a template field: must keep the prototype value
+  setpoint.yawspeed = 4.f;
+  serialized_template.patch(setpoint);
+
+  TrajectorySetpoint deserialized{};
+  rclcpp::Serialization<TrajectorySetpoint> serialization;
+  serialization.deserialize_message(&serialized_template.message(), &deserialized);
+  EXPECT_EQ(deserialized.timestamp, setpoint.timestamp);
+  EXPECT_EQ(deserialized.position, setpoint.position);
+  EXPECT_EQ(deserialized.yaw, setpoint.yaw);
+  EXPECT_EQ(deserialized.yawspeed, prototype.yawspeed);
+  EXPECT_TRUE(std::isnan(deserialized.jerk[0]));
+
+  // Same bytes as a regular serialization
+  setpoint.yawspeed = prototype.yawspeed;
+  rclcpp::SerializedMessage serialized;
+  serialization.serialize_message(&setpoint, &serialized);
+  const auto & expected = serialized.get_rcl_serialized_message();
+  const auto & actual = serialized_template.message().get_rcl_serialized_message();
+  ASSERT_EQ(actual.buffer_length, expected.buffer_length);
+  EXPECT_EQ(std::memcmp(actual.buffer, expected.buffer, expected.buffer_length), 0);
+}
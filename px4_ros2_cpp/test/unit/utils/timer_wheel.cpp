@@ -0,0 +1,77 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <px4_ros2/utils/timer_wheel.hpp>
+
+#include <random>
+
+using px4_ros2::TimerWheel;
+using namespace std::chrono_literals;
+
+TEST(timerWheel, expiryOrder)
+{
+  const TimerWheel::Clock::time_point start{};
+  TimerWheel wheel(1ms, start);
+
+  static constexpr int kNumTimeouts = 5000;
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int64_t> deadline_distribution(0, 4'000'000); // Up to 4 levels, in ms
+  std::vector<TimerWheel::Clock::time_point> deadlines(kNumTimeouts);
+  std::vector<TimerWheel::Clock::time_point> fired(kNumTimeouts);
+  std::vector<TimerWheel::Handle> handles(kNumTimeouts);
+  TimerWheel::Clock::time_point now = start;
+
+  for (int i = 0; i < kNumTimeouts; ++i) {
+    deadlines[i] = start + std::chrono::milliseconds(deadline_distribution(rng));
+    handles[i] = wheel.schedule(deadlines[i], [&, i]() {fired[i] = now;});
+  }
+
+  EXPECT_EQ(wheel.size(), static_cast<size_t>(kNumTimeouts));
+
+  // Cancel every 10th
+  for (int i = 0; i < kNumTimeouts; i += 10) {
+    EXPECT_TRUE(wheel.cancel(handles[i]));
+    EXPECT_FALSE(wheel.cancel(handles[i]));
+  }
+
+  std::uniform_int_distribution<int64_t> step_distribution(1, 50'000);
+
+  while (!wheel.empty()) {
+    now += std::chrono::microseconds(step_distribution(rng));
+    wheel.advance(now);
+  }
+
+  for (int i = 0; i < kNumTimeouts; ++i) {
+    if (i % 10 == 0) {
+      EXPECT_EQ(fired[i], TimerWheel::Clock::time_point{});
+
+    } else {
+      // Fires at the first advance() after the deadline's tick
+      EXPECT_GE(fired[i], deadlines[i]);
+      EXPECT_LT(fired[i] - deadlines[i], 1ms + 50ms);
+    }
+  }
+}
+
+TEST(timerWheel, rescheduleFromCallback)
+{
+  const TimerWheel::Clock::time_point start{};
+  TimerWheel wheel(10ms, start);
+  int num_fired = 0;
+  std::function<void()> callback = [&]() {
+      if (++num_fired < 5) {
+        wheel.schedule(start + num_fired * 100ms, callback);
+      }
+    };
+  wheel.schedule(start, callback);
+
+  for (auto now = start; now < start + 1s; now += 10ms) {
+    wheel.advance(now);
+  }
+
+  EXPECT_EQ(num_fired, 5);
+  EXPECT_TRUE(wheel.empty());
+}
@@ -0,0 +1,164 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <px4_ros2/control/trajectory/velocity_profile_planner.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+using px4_ros2::PolynomialTrajectory;
+using px4_ros2::VelocityProfilePlanner;
+
+TEST(VelocityProfilePlanner, straightLine)
+{
+  VelocityProfilePlanner::Settings settings;
+  VelocityProfilePlanner planner(settings);
+  planner.plan({{0.f, 0.f, -5.f}, {100.f, 0.f, -5.f}});
+
+  EXPECT_NEAR(planner.length(), 100., 1e-4);
+  EXPECT_FLOAT_EQ(planner.speedAt(0.), 0.f);
+  EXPECT_FLOAT_EQ(planner.speedAt(100.), 0.f);
+  EXPECT_NEAR(planner.speedAt(50.), settings.max_horizontal_speed_m_s, 1e-4);
+
+  // Lower bound without jerk limit, the jerk limit adds less than a second
+  const double min_duration = 100. / settings.max_horizontal_speed_m_s +
+    settings.max_horizontal_speed_m_s / settings.max_acceleration_m_s2;
+  EXPECT_GT(planner.duration(), min_duration);
+  EXPECT_LT(planner.duration(), min_duration + 1.);
+
+  // Check the limits on the resulting trajectory
+  PolynomialTrajectory trajectory;
+  planner.toTrajectory(trajectory);
+  EXPECT_NEAR(trajectory.duration(), planner.duration(), 1e-6);
+  EXPECT_FALSE(trajectory.yawEnabled());
+
+  for (double t = 0.; t < trajectory.duration() + 1.; t += 0.05) {
+    const auto sample = trajectory.sample(t);
+    EXPECT_LE(sample.velocity_ned_m_s.norm(), settings.max_horizontal_speed_m_s + 1e-3f);
+    EXPECT_LE(sample.acceleration_ned_m_s2.norm(), settings.max_acceleration_m_s2 + 1e-3f);
+    EXPECT_NEAR(sample.velocity_ned_m_s.y(), 0.f, 1e-5f);
+    EXPECT_NEAR(sample.position_ned_m.z(), -5.f, 1e-4f);
+  }
+
+  // Ramping up the acceleration is jerk limited, with a constant acceleration per step
+  for (size_t i = 1; i < trajectory.numSegments(); ++i) {
+    const double acceleration_change = 2. * (trajectory.coefficients(i)(0, 2) -
+      trajectory.coefficients(i - 1)(0, 2));
+    EXPECT_LE(acceleration_change, settings.max_jerk_m_s3 * trajectory.segmentDuration(i) * 1.1);
+  }
+
+  EXPECT_NEAR(trajectory.sample(trajectory.duration()).position_ned_m.x(), 100.f, 1e-3f);
+}
+
+TEST(VelocityProfilePlanner, corners)
+{
+  VelocityProfilePlanner::Settings settings;
+  VelocityProfilePlanner planner(settings);
+  // 90 degree corner, then going back the same way, and a vertical segment
+  planner.plan(
+    {{0.f, 0.f, 0.f}, {30.f, 0.f, 0.f}, {30.f, 30.f, 0.f}, {30.f, 10.f, 0.f},
+      {30.f, 10.f, -30.f}});
+
+  // Turn radius equals the acceptance radius for 90 degrees
+  const float corner_speed = std::sqrt(
+    settings.max_acceleration_m_s2 * settings.corner_acceptance_radius_m);
+  EXPECT_LE(planner.speedAt(30.), corner_speed + 1e-4f);
+  EXPECT_GT(planner.speedAt(30.), corner_speed * 0.9f);
+  EXPECT_GT(planner.speedAt(15.), corner_speed);
+
+  // Reversal
+  EXPECT_NEAR(planner.speedAt(60.), 0.f, 1e-4f);
+
+  // Vertical
+  EXPECT_LE(planner.speedAt(95.), settings.max_vertical_speed_m_s + 1e-4f);
+  EXPECT_NEAR(planner.speedAt(95.), settings.max_vertical_speed_m_s, 1e-2f);
+
+  // Trajectory passes through the vertices
+  PolynomialTrajectory trajectory;
+  planner.toTrajectory(trajectory);
+  EXPECT_NEAR(
+    (trajectory.sample(trajectory.duration()).position_ned_m - Eigen::Vector3f(30.f, 10.f, -30.f))
+    .norm(), 0.f, 1e-3f);
+}
+
+TEST(VelocityProfilePlanner, gotoConstraints)
+{
+  VelocityProfilePlanner::Settings settings;
+  VelocityProfilePlanner planner(settings);
+  planner.plan({{0.f, 0.f, 0.f}, {30.f, 0.f, 0.f}, {30.f, 30.f, 0.f}}, 2.f);
+  EXPECT_NEAR(planner.speedAt(0.), 2.f, 1e-4f);
+
+  auto constraints = planner.gotoConstraints({0.f, 0.f, 0.f});
+  EXPECT_EQ(constraints.position_ned_m, Eigen::Vector3f(30.f, 0.f, 0.f));
+  EXPECT_NEAR(constraints.max_horizontal_speed_m_s, 2.f, 1e-4f);
+
+  constraints = planner.gotoConstraints({15.f, 1.f, 0.f});
+  EXPECT_EQ(constraints.position_ned_m, Eigen::Vector3f(30.f, 0.f, 0.f));
+  EXPECT_NEAR(constraints.max_horizontal_speed_m_s, settings.max_horizontal_speed_m_s, 1e-4f);
+
+  // Past the corner, the next segment is used
+  constraints = planner.gotoConstraints({30.5f, 1.f, 0.f});
+  EXPECT_EQ(constraints.position_ned_m, Eigen::Vector3f(30.f, 30.f, 0.f));
+  EXPECT_NEAR(constraints.max_horizontal_speed_m_s, planner.speedAt(31.), 1e-4f);
+
+  // Does not go back to the previous segment
+  constraints = planner.gotoConstraints({29.f, 0.f, 0.f});
+  EXPECT_EQ(constraints.position_ned_m, Eigen::Vector3f(30.f, 30.f, 0.f));
+
+  EXPECT_THROW(planner.plan({{0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}}), std::runtime_error);
+}
+
+TEST(VelocityProfilePlanner, cornerVelocityContinuity)
+{
+  VelocityProfilePlanner::Settings settings;
+  VelocityProfilePlanner planner(settings);
+  const Eigen::Vector3f corner{20.f, 0.f, -5.f};
+  planner.plan({{0.f, 0.f, -5.f}, corner, {20.f, 20.f, -5.f}});
+  const float corner_speed = std::sqrt(
+    settings.max_acceleration_m_s2 * settings.corner_acceptance_radius_m);
+
+  PolynomialTrajectory trajectory;
+  planner.toTrajectory(trajectory);
+  EXPECT_LT(trajectory.duration(), planner.duration());
+
+  const double dt = 0.001;
+  auto previous = trajectory.sample(0.);
+  float min_corner_distance = std::numeric_limits<float>::infinity();
+  float max_velocity_change = 0.f;
+
+  for (double t = dt; t <= trajectory.duration(); t += dt) {
+    const auto sample = trajectory.sample(t);
+    max_velocity_change = std::max(
+      max_velocity_change, (sample.velocity_ned_m_s - previous.velocity_ned_m_s).norm());
+    min_corner_distance =
+      std::min(min_corner_distance, (sample.position_ned_m - corner).norm());
+
+    // Through the turn, the lateral acceleration stays within the limit
+    if ((sample.position_ned_m - corner).norm() < settings.corner_acceptance_radius_m) {
+      EXPECT_LE(sample.velocity_ned_m_s.norm(), corner_speed + 1e-3f);
+      const Eigen::Vector3f tangent = sample.velocity_ned_m_s.normalized();
+      const Eigen::Vector3f acceleration = sample.acceleration_ned_m_s2;
+      const float lateral_acceleration =
+        (acceleration - acceleration.dot(tangent) * tangent).norm();
+      EXPECT_LE(lateral_acceleration, settings.max_acceleration_m_s2 * 1.05f);
+    }
+
+    previous = sample;
+  }
+
+  // No jump at the vertex: the change per sample is bounded by the acceleration
+  EXPECT_LT(max_velocity_change, settings.max_acceleration_m_s2 * 1.5f * dt);
+
+  // The arc stays inside the corner, the turn radius equals the acceptance radius at 90 degrees
+  const float arc_distance = settings.corner_acceptance_radius_m * (std::sqrt(2.f) - 1.f);
+  EXPECT_NEAR(min_corner_distance, arc_distance, 0.01f);
+  EXPECT_NEAR(
+    (trajectory.sample(trajectory.duration()).position_ned_m - Eigen::Vector3f(20.f, 20.f, -5.f))
+    .norm(), 0.f, 1e-3f);
+}
@@ -0,0 +1,184 @@
+/****************************************************************************
+ * Copyright (c) 2024 PX4 Development Team.
+ * SPDX-License-Identifier: BSD-3-Clause
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <rclcpp/rclcpp.hpp>
+#include <px4_msgs/msg/battery_status.hpp>
+#include <px4_msgs/msg/vehicle_local_position.hpp>
+#include <px4_ros2/components/wait_condition.hpp>
+#include "spin_util.hpp"
+
+#include <optional>
+
+using px4_ros2::ConditionWaiter;
+using px4_ros2::Result;
+using px4_ros2::WaitCondition;
+using namespace std::chrono_literals;
+
+class ConditionWaiterTest : public testing::Test
+{
+protected:
+  ConditionWaiterTest()
+  : _node("test_node"), _context(_node),
+    _local_position(_context, "fmu/out/vehicle_local_position"),
+    _battery(_context, "fmu/out/battery_status"),
+    _altitude_reached(
+      _local_position,
+      [](const px4_msgs::msg::VehicleLocalPosition & msg) {return -msg.z > 10.f;}),
+    _battery_low(
+      _battery, [](const px4_msgs::msg::BatteryStatus & msg) {return msg.remaining < 0.2f;})
+  {
+    _local_position_pub = _node.create_publisher<px4_msgs::msg::VehicleLocalPosition>(
+      "fmu/out/vehicle_local_position", 1);
+    _battery_pub = _node.create_publisher<px4_msgs::msg::BatteryStatus>(
+      "fmu/out/battery_status", 1);
+    _local_position.onUpdate(
+      [this](const px4_msgs::msg::VehicleLocalPosition &) {++_num_local_position;});
+    _battery.onUpdate([this](const px4_msgs::msg::BatteryStatus &) {++_num_battery;});
+  }
+
+  void publishAltitude(float altitude)
+  {
+    px4_msgs::msg::VehicleLocalPosition msg{};
+    msg.z = -altitude;
+    const int num_received = _num_local_position;
+    _local_position_pub->publish(msg);
+    ASSERT_TRUE(spinUntil(_node, [&]() {return _num_local_position > num_received;}));
+  }
+
+  void publishBattery(float remaining)
+  {
+    px4_msgs::msg::BatteryStatus msg{};
+    msg.remaining = remaining;
+    const int num_received = _num_battery;
+    _battery_pub->publish(msg);
+    ASSERT_TRUE(spinUntil(_node, [&]() {return _num_battery > num_received;}));
+  }
+
+  rclcpp::Node _node;
+  px4_ros2::Context _context;
+  px4_ros2::Subscription<px4_msgs::msg::VehicleLocalPosition> _local_position;
+  px4_ros2::Subscription<px4_msgs::msg::BatteryStatus> _battery;
+  rclcpp::Publisher<px4_msgs::msg::VehicleLocalPosition>::SharedPtr _local_position_pub;
+  rclcpp::Publisher<px4_msgs::msg::BatteryStatus>::SharedPtr _battery_pub;
+  int _num_local_position{0};
+  int _num_battery{0};
+  const WaitCondition _altitude_reached;
+  const WaitCondition _battery_low;
+};
+
+TEST_F(ConditionWaiterTest, combinedConditions)
+{
+  ConditionWaiter waiter(_node);
+  std::optional<Result> either_result;
+  std::optional<Result> both_result;
+  waiter.waitUntil(
+    _altitude_reached || _battery_low, [&](Result result) {either_result = result;});
+  waiter.waitUntil(
+    _altitude_reached && _battery_low, [&](Result result) {both_result = result;});
+  EXPECT_EQ(waiter.numActive(), 2u);
+
+  // No message yet: both are false
+  publishAltitude(5.f);
+  publishBattery(0.5f);
+  EXPECT_FALSE(either_result);
+  EXPECT_FALSE(both_result);
+
+  publishAltitude(12.f);
+  ASSERT_TRUE(either_result);
+  EXPECT_EQ(*either_result, Result::Success);
+  EXPECT_FALSE(both_result);
+  EXPECT_EQ(waiter.numActive(), 1u);
+
+  publishAltitude(15.f);
+  publishBattery(0.1f);
+  ASSERT_TRUE(both_result);
+  EXPECT_EQ(*both_result, Result::Success);
+  EXPECT_EQ(waiter.numActive(), 0u);
+
+  // Already true: completes immediately
+  std::optional<Result> immediate_result;
+  waiter.waitUntil(_battery_low, [&](Result result) {immediate_result = result;});
+  ASSERT_TRUE(immediate_result);
+  EXPECT_EQ(*immediate_result, Result::Success);
+  EXPECT_EQ(waiter.numActive(), 0u);
+}
+
+TEST_F(ConditionWaiterTest, timeoutAndCancel)
+{
+  ConditionWaiter waiter(_node);
+  std::optional<Result> timeout_result;
+  std::optional<Result> cancel_result;
+  std::optional<Result> cancel_all_result;
+  waiter.waitUntil(_altitude_reached, [&](Result result) {timeout_result = result;}, 50ms);
+  const ConditionWaiter::WaitId id =
+    waiter.waitUntil(_altitude_reached, [&](Result result) {cancel_result = result;});
+  waiter.waitUntil(_battery_low, [&](Result result) {cancel_all_result = result;});
+
+  EXPECT_TRUE(waiter.cancel(id, Result::Interrupted));
+  ASSERT_TRUE(cancel_result);
+  EXPECT_EQ(*cancel_result, Result::Interrupted);
+  EXPECT_FALSE(waiter.cancel(id));
+
+  ASSERT_TRUE(spinUntil(_node, [&]() {return timeout_result.has_value();}));
+  EXPECT_EQ(*timeout_result, Result::Timeout);
+  EXPECT_EQ(waiter.numActive(), 1u);
+
+  waiter.cancelAll();
+  ASSERT_TRUE(cancel_all_result);
+  EXPECT_EQ(*cancel_all_result, Result::Deactivated);
+
+  // Completed waits are not triggered by later messages
+  cancel_result.reset();
+  publishAltitude(20.f);
+  EXPECT_FALSE(cancel_result);
+  EXPECT_EQ(waiter.numActive(), 0u);
+}
+
+TEST_F(ConditionWaiterTest, waitFromSubscriptionCallback)
+{
+  // Starting the first wait on a subscription from within its own callback registers a new
+  // update callback while the subscription iterates over them
+  ConditionWaiter waiter(_node);
+  std::optional<Result> result;
+  bool started = false;
+  _local_position.onUpdate(
+    [&](const px4_msgs::msg::VehicleLocalPosition &) {
+      if (!started) {
+        started = true;
+        waiter.waitUntil(_altitude_reached, [&](Result wait_result) {result = wait_result;});
+      }
+    });
+
+  publishAltitude(1.f);
+  EXPECT_TRUE(started);
+  EXPECT_FALSE(result);
+  EXPECT_EQ(waiter.numActive(), 1u);
+
+  publishAltitude(11.f);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, Result::Success);
+}
+
+TEST_F(ConditionWaiterTest, completionStartsNewWait)
+{
+  ConditionWaiter waiter(_node);
+  int num_completed = 0;
+  std::function<void(Result)> restart = [&](Result result) {
+      EXPECT_EQ(result, Result::Success);
+
+      if (++num_completed < 3) {
+        waiter.waitUntil(_battery_low, restart);
+      }
+    };
+  publishAltitude(2.f);
+  waiter.waitUntil(_battery_low, restart);
+  EXPECT_EQ(num_completed, 0);
+
+  // Completes all three, as the condition is already true when restarting
+  publishBattery(0.1f);
+  EXPECT_EQ(num_completed, 3);
+  EXPECT_EQ(waiter.numActive(), 0u);
+}